@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/workstealing.h"
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Main function
+ * Times count products of one size called one by one with
+ * strassenMul_hybrid, then through the batch API, and checks that both
+ * give the same results
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --verify[=<bound>] also checks every product of the batch with Freivalds' algorithm */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 5 || argc > 6) {
+        printf("Usage: %s <count> <matrix_size> <cutoff> <threads> [naive|blocked] [--verify[=<bound>]]\n", argv[0]);
+        printf("  threads 0 runs the batch serially\n");
+        printf("  prints count,size,threads,loop_time,batch_time,strided_time\n");
+        return 1;
+    }
+
+    int count = atoi(argv[1]);
+    int side = atoi(argv[2]);
+    int cutoff = atoi(argv[3]);
+    int threads = atoi(argv[4]);
+    if (argc == 6 && strcmp(argv[5], "blocked") == 0) {
+        setHybridLeaf(LEAF_BLOCKED);
+    }
+
+    size_t elems = (size_t)side * side;
+    int* dataA = malloc(sizeof(int) * elems * count);
+    int* dataB = malloc(sizeof(int) * elems * count);
+    int* dataC = malloc(sizeof(int) * elems * count);
+    int* dataD = malloc(sizeof(int) * elems * count);
+    struct Matrix* mats = malloc(sizeof(struct Matrix) * 3 * count);
+    struct Matrix** ptrs = malloc(sizeof(struct Matrix*) * 3 * count);
+    if (dataA == NULL || dataB == NULL || dataC == NULL || dataD == NULL || mats == NULL || ptrs == NULL) {
+        return 1;
+    }
+
+    /* Headers over the strided buffers, used by the loop and the pointer API */
+    for (int i = 0; i < count; i++) {
+        struct Matrix* a = &mats[3 * i];
+        struct Matrix* b = &mats[3 * i + 1];
+        struct Matrix* c = &mats[3 * i + 2];
+        a->matrix = dataA + i * elems;
+        b->matrix = dataB + i * elems;
+        c->matrix = dataD + i * elems;
+        a->row = a->col = a->ld = side;
+        b->row = b->col = b->ld = side;
+        c->row = c->col = c->ld = side;
+        fillMatrixRand(a);
+        fillMatrixRand(b);
+        ptrs[i] = a;
+        ptrs[count + i] = b;
+        ptrs[2 * count + i] = c;
+    }
+
+    double t = nowSeconds();
+    for (int i = 0; i < count; i++) {
+        struct Matrix c = { dataC + i * elems, side, side, side };
+        if (strassenMul_hybrid(ptrs[i], ptrs[count + i], &c, cutoff) == NULL) {
+            return 1;
+        }
+    }
+    double loopTime = nowSeconds() - t;
+
+    struct TaskRuntime* rt = threads > 0 ? runtimeCreate(threads) : NULL;
+    if (threads > 0 && rt == NULL) {
+        return 1;
+    }
+
+    t = nowSeconds();
+    if (strassenMulBatch(rt, ptrs, ptrs + count, ptrs + 2 * count, count, cutoff) != 0) {
+        return 1;
+    }
+    double batchTime = nowSeconds() - t;
+    int same = memcmp(dataC, dataD, sizeof(int) * elems * count) == 0;
+
+    memset(dataD, 0, sizeof(int) * elems * count);
+    t = nowSeconds();
+    if (strassenMulBatchStrided(rt, dataA, dataB, dataD, side, side, side, count, cutoff) != 0) {
+        return 1;
+    }
+    double stridedTime = nowSeconds() - t;
+    same = same && memcmp(dataC, dataD, sizeof(int) * elems * count) == 0;
+
+    if (!same) {
+        fprintf(stderr, "Batched and one-by-one products differ\n");
+        return 1;
+    }
+    printf("%d,%d,%d,%f,%f,%f\n", count, side, threads, loopTime, batchTime, stridedTime);
+
+    /* Each product gets its own bound, so a wrong one passes with probability at most verify */
+    int status = 0;
+    if (verify > 0) {
+        int failed = 0;
+        unsigned long long seed = (unsigned long long)time(NULL);
+        for (int i = 0; i < count; i++) {
+            struct Matrix c = { dataD + i * elems, side, side, side };
+            if (verifyProduct(ptrs[i], ptrs[count + i], &c, verify, seed + i) != 1) {
+                failed++;
+            }
+        }
+        fprintf(stderr, "verify: %d of %d products %s, %d rounds each, false-positive bound %g\n",
+                count - failed, count, "passed", freivaldsRounds(verify), verify);
+        status = failed > 0;
+    }
+
+    if (rt != NULL) {
+        runtimeDestroy(rt);
+    }
+    free(dataA);
+    free(dataB);
+    free(dataC);
+    free(dataD);
+    free(mats);
+    free(ptrs);
+    return status;
+}
@@ -0,0 +1,501 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/workstealing.h"
+
+/******************************************
+ * Unified benchmark harness
+ *
+ * Runs every selected engine on every size and cutoff in one process:
+ * warm-up runs, then timed trials on a monotonic (wall) clock, reporting
+ * the median, minimum and standard deviation and the rate 2mkn / median.
+ * Each result is compared with a reference product before timing.
+ *******************************************/
+
+/* Largest number of entries in a comma-separated option */
+#define MAX_LIST 64
+
+/* Runtime used by the parallel engine, created on demand */
+static struct TaskRuntime* runtime = NULL;
+static int runtimeDepth = 1;
+
+/**
+ * Runs the naive kernel
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Unused
+ * @return       Pointer to C
+ */
+static struct Matrix* runMul(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    (void)cutoff;
+    return mul(A, B, C);
+}
+
+/**
+ * Runs the blocked kernel
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Unused
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runBlocked(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    (void)cutoff;
+    return mulBlocked(A, B, C);
+}
+
+/**
+ * Runs pure Strassen
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Unused
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runStrassen(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    (void)cutoff;
+    return strassenMul(A, B, C);
+}
+
+/**
+ * Runs the parallel hybrid engine on the shared runtime
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Size threshold of the hybrid engine
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runParallel(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    setHybridRuntime(runtime, runtimeDepth);
+    struct Matrix* result = strassenMul_hybrid(A, B, C, cutoff);
+    setHybridRuntime(NULL, 0);
+    return result;
+}
+
+/**
+ * Pads the operands to a power-of-two square and runs the hybrid engine on them
+ * This is what the drivers did before odd sides were peeled; the copies
+ * and allocations are part of the timed run
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Size threshold of the hybrid engine
+ * @param mode   Zero-block detection used on the padded operands
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runPaddedWith(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                                    enum ZeroSkip mode) {
+    int largest = A->row > A->col ? A->row : A->col;
+    if (B->col > largest) largest = B->col;
+    int side = nextPowerOfTwo(largest);
+
+    struct Matrix PA = allocMatrix(side);
+    struct Matrix PB = allocMatrix(side);
+    struct Matrix PC = allocMatrix(side);
+    struct Matrix* result = NULL;
+    if (PA.matrix != NULL && PB.matrix != NULL && PC.matrix != NULL) {
+        initMatrixZeros(&PA);
+        initMatrixZeros(&PB);
+        copySubmatrixRect(A, 0, 0, &PA, 0, 0, A->row, A->col);
+        copySubmatrixRect(B, 0, 0, &PB, 0, 0, B->row, B->col);
+
+        enum ZeroSkip previous = getZeroBlockSkip();
+        setZeroBlockSkip(mode);
+        result = strassenMul_hybrid(&PA, &PB, &PC, cutoff);
+        setZeroBlockSkip(previous);
+        if (result != NULL) {
+            copySubmatrixRect(&PC, 0, 0, C, 0, 0, C->row, C->col);
+            result = C;
+        }
+    }
+    freeMatrix(&PA);
+    freeMatrix(&PB);
+    freeMatrix(&PC);
+    return result;
+}
+
+/**
+ * Runs the hybrid engine on padded operands, multiplying every block
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Size threshold of the hybrid engine
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runPadded(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    return runPaddedWith(A, B, C, cutoff, ZERO_SKIP_OFF);
+}
+
+/**
+ * Runs the hybrid engine on padded operands, skipping zero quadrants
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Size threshold of the hybrid engine
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runPaddedBlocks(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    return runPaddedWith(A, B, C, cutoff, ZERO_SKIP_BLOCKS);
+}
+
+/**
+ * Runs the hybrid engine on padded operands, cropping the padding first
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @param cutoff Size threshold of the hybrid engine
+ * @return       Pointer to C, NULL on allocation failure
+ */
+static struct Matrix* runPaddedZeroSkip(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    return runPaddedWith(A, B, C, cutoff, ZERO_SKIP_TRAILING);
+}
+
+/**
+ * Engine that can be benchmarked
+ */
+struct Engine {
+    const char* name;
+    struct Matrix* (*run)(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff);
+    int usesCutoff;     /* Timed once per cutoff */
+    int squareOnly;     /* Skipped for MxKxN shapes */
+};
+
+static const struct Engine engines[] = {
+    { "mul",             runMul,                0, 0 },
+    { "blocked",         runBlocked,            0, 0 },
+    { "strassen",        runStrassen,           0, 0 },
+    { "hybrid",          strassenMul_hybrid,    1, 0 },
+    { "winograd",        winogradMul_hybrid,    1, 0 },
+    { "morton",          strassenMul_viaMorton, 1, 1 },
+    { "parallel",        runParallel,           1, 0 },
+    { "padded",          runPadded,             1, 0 },
+    { "padded-blocks",   runPaddedBlocks,       1, 0 },
+    { "padded-zeroskip", runPaddedZeroSkip,     1, 0 },
+};
+
+#define ENGINE_COUNT ((int)(sizeof(engines) / sizeof(engines[0])))
+
+/**
+ * Statistics of the timed trials of one configuration
+ */
+struct TrialStats {
+    double median;
+    double min;
+    double stddev;
+};
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Orders two doubles for qsort
+ * @param a      First value
+ * @param b      Second value
+ * @return       Negative, zero or positive as with strcmp
+ */
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Computes median, minimum and sample standard deviation of trial times
+ * @param times  Trial times (sorted in place)
+ * @param count  Number of trials
+ * @return       Statistics of the trials
+ */
+static struct TrialStats trialStats(double* times, int count) {
+    struct TrialStats stats;
+    double mean = 0.0, squares = 0.0;
+
+    qsort(times, count, sizeof(double), compareDoubles);
+    stats.min = times[0];
+    stats.median = count % 2 ? times[count / 2] : (times[count / 2 - 1] + times[count / 2]) / 2;
+
+    for (int i = 0; i < count; i++) mean += times[i];
+    mean /= count;
+    for (int i = 0; i < count; i++) squares += (times[i] - mean) * (times[i] - mean);
+    stats.stddev = count > 1 ? sqrt(squares / (count - 1)) : 0.0;
+    return stats;
+}
+
+/**
+ * Returns the index of an engine from its name
+ * @param name   Engine name
+ * @return       Index in engines, -1 if unknown
+ */
+static int findEngine(const char* name) {
+    for (int i = 0; i < ENGINE_COUNT; i++) {
+        if (strcmp(engines[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Splits a comma-separated option into its tokens
+ * @param list   Option value, modified in place
+ * @param tokens Receives up to MAX_LIST tokens
+ * @return       Number of tokens
+ */
+static int splitList(char* list, char** tokens) {
+    int count = 0;
+    for (char* token = strtok(list, ","); token != NULL && count < MAX_LIST; token = strtok(NULL, ",")) {
+        tokens[count++] = token;
+    }
+    return count;
+}
+
+/**
+ * Prints the usage message
+ * @param program    Name of the executable
+ */
+static void printUsage(const char* program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --engines e1,e2,...   mul, blocked, strassen, hybrid, winograd, morton, parallel,\n");
+    printf("                        padded, padded-blocks, padded-zeroskip (default hybrid)\n");
+    printf("  --sizes s1,s2,...     sides or MxKxN shapes (default 64,128,...,2048)\n");
+    printf("  --cutoffs c1,c2,...   cutoffs of the hybrid engines, auto for the tuned profile (default 64)\n");
+    printf("  --leaf naive|blocked  leaf kernel of the hybrid engines (default naive)\n");
+    printf("  --threads T           threads of the parallel engine (default 2)\n");
+    printf("  --depth D             parallel recursion levels (default 1)\n");
+    printf("  --warmup N            untimed runs per configuration (default 1)\n");
+    printf("  --trials N            timed runs per configuration (default 5)\n");
+    printf("  --csv FILE            all results in one CSV file\n");
+    printf("  --json FILE           all results as a JSON array\n");
+    printf("  --split DIR           one CSV per engine and cutoff, read by the plot.py scripts\n");
+    printf("  --no-check            skip the comparison with the reference product\n");
+    printf("  --verify[=BOUND]      check with Freivalds' algorithm instead of the reference product\n");
+}
+
+/**
+ * Main function
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure or wrong result
+ */
+int main(int argc, char* argv[]) {
+    char defaultEngines[] = "hybrid";
+    char defaultSizes[] = "64,128,256,512,1024,2048";
+    char defaultCutoffs[] = "64";
+    char* engineList = defaultEngines;
+    char* sizeList = defaultSizes;
+    char* cutoffList = defaultCutoffs;
+    const char* csvPath = NULL;
+    const char* jsonPath = NULL;
+    const char* splitDir = NULL;
+    int threads = 2, warmup = 1, trials = 5, check = 1;
+    double verify;
+
+    /* --verify replaces the O(n^3) reference product by a Freivalds check of each engine */
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (verify > 0) check = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--engines") == 0 && hasValue) {
+            engineList = argv[++i];
+        } else if (strcmp(argv[i], "--sizes") == 0 && hasValue) {
+            sizeList = argv[++i];
+        } else if (strcmp(argv[i], "--cutoffs") == 0 && hasValue) {
+            cutoffList = argv[++i];
+        } else if (strcmp(argv[i], "--leaf") == 0 && hasValue) {
+            setHybridLeaf(strcmp(argv[++i], "blocked") == 0 ? LEAF_BLOCKED : LEAF_NAIVE);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--depth") == 0 && hasValue) {
+            runtimeDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && hasValue) {
+            warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trials") == 0 && hasValue) {
+            trials = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            csvPath = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--split") == 0 && hasValue) {
+            splitDir = argv[++i];
+        } else if (strcmp(argv[i], "--no-check") == 0) {
+            check = 0;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (trials < 1) trials = 1;
+
+    char* engineNames[MAX_LIST];
+    char* sizeNames[MAX_LIST];
+    char* cutoffNames[MAX_LIST];
+    int engineIds[MAX_LIST];
+    int cutoffs[MAX_LIST];
+    int engineCount = splitList(engineList, engineNames);
+    int sizeCount = splitList(sizeList, sizeNames);
+    int cutoffCount = splitList(cutoffList, cutoffNames);
+
+    for (int e = 0; e < engineCount; e++) {
+        engineIds[e] = findEngine(engineNames[e]);
+        if (engineIds[e] < 0) {
+            fprintf(stderr, "Unknown engine %s\n", engineNames[e]);
+            return 1;
+        }
+        if (strcmp(engineNames[e], "parallel") == 0 && runtime == NULL) {
+            runtime = runtimeCreate(threads);
+            if (runtime == NULL) return 1;
+        }
+    }
+    for (int c = 0; c < cutoffCount; c++) {
+        cutoffs[c] = strcmp(cutoffNames[c], "auto") == 0 ? CUTOFF_AUTO : atoi(cutoffNames[c]);
+    }
+
+    FILE* csv = csvPath != NULL ? fopen(csvPath, "w") : NULL;
+    FILE* json = jsonPath != NULL ? fopen(jsonPath, "w") : NULL;
+    if ((csvPath != NULL && csv == NULL) || (jsonPath != NULL && json == NULL)) {
+        fprintf(stderr, "Cannot open output file\n");
+        return 1;
+    }
+    const char* header = "Engine,Matrix Size,Cutoff,Time (seconds),Min time (seconds),Stddev (seconds),GOP/s,Correct";
+    printf("%s\n", header);
+    if (csv != NULL) fprintf(csv, "%s\n", header);
+    if (json != NULL) fprintf(json, "[");
+
+    /* Per-engine files are truncated by the first row written to them */
+    static int splitStarted[MAX_LIST][MAX_LIST];
+    int firstRow = 1;
+    int failures = 0;
+    double* times = malloc(sizeof(double) * trials);
+    if (times == NULL) return 1;
+
+    for (int s = 0; s < sizeCount; s++) {
+        int m, k, n;
+        int square = sscanf(sizeNames[s], "%dx%dx%d", &m, &k, &n) != 3;
+        if (square) {
+            m = k = n = atoi(sizeNames[s]);
+        }
+
+        struct Matrix A = allocMatrixRect(m, k);
+        struct Matrix B = allocMatrixRect(k, n);
+        struct Matrix C = allocMatrixRect(m, n);
+        struct Matrix R = allocMatrixRect(m, n);
+        if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL || R.matrix == NULL) {
+            fprintf(stderr, "Memory allocation failed for size %s\n", sizeNames[s]);
+            return 1;
+        }
+        srand(1);
+        fillMatrixRand(&A);
+        fillMatrixRand(&B);
+        if (check && mulBlocked(&A, &B, &R) == NULL) return 1;
+
+        for (int e = 0; e < engineCount; e++) {
+            const struct Engine* engine = &engines[engineIds[e]];
+            if (engine->squareOnly && !square) {
+                fprintf(stderr, "Skipping %s for non-square shape %s\n", engine->name, sizeNames[s]);
+                continue;
+            }
+
+            for (int c = 0; c < (engine->usesCutoff ? cutoffCount : 1); c++) {
+                int cutoff = engine->usesCutoff ? cutoffs[c] : 0;
+                /* Not every engine reads CUTOFF_AUTO: resolve it here and report the value used */
+                if (engine->usesCutoff && cutoff == CUTOFF_AUTO) {
+                    int largest = m > k ? m : k;
+                    cutoff = profileCutoff(largest > n ? largest : n);
+                }
+
+                initMatrixZeros(&C);
+                if (engine->run(&A, &B, &C, cutoff) == NULL) {
+                    fprintf(stderr, "%s failed for size %s\n", engine->name, sizeNames[s]);
+                    return 1;
+                }
+                int correct = 1;
+                if (check) {
+                    correct = memcmp(C.matrix, R.matrix, sizeof(int) * (size_t)m * n) == 0;
+                } else if (verify > 0) {
+                    correct = verifyProduct(&A, &B, &C, verify, (unsigned long long)(s * MAX_LIST + e)) == 1;
+                }
+                failures += !correct;
+
+                /* The checked run above is the first warm-up run */
+                for (int i = 1; i < warmup; i++) {
+                    engine->run(&A, &B, &C, cutoff);
+                }
+                for (int i = 0; i < trials; i++) {
+                    double start = nowSeconds();
+                    engine->run(&A, &B, &C, cutoff);
+                    times[i] = nowSeconds() - start;
+                }
+                struct TrialStats stats = trialStats(times, trials);
+                double gops = 2.0 * m * k * n / stats.median / 1e9;
+                const char* result = check || verify > 0 ? (correct ? "yes" : "no") : "unchecked";
+
+                char row[256];
+                snprintf(row, sizeof(row), "%s,%s,%d,%f,%f,%f,%.3f,%s", engine->name, sizeNames[s],
+                         cutoff, stats.median, stats.min, stats.stddev, gops, result);
+                printf("%s\n", row);
+                fflush(stdout);
+                if (csv != NULL) fprintf(csv, "%s\n", row);
+                if (json != NULL) {
+                    fprintf(json, "%s\n  {\"engine\": \"%s\", \"size\": \"%s\", \"m\": %d, \"k\": %d, \"n\": %d, "
+                            "\"cutoff\": %d, \"median\": %f, \"min\": %f, \"stddev\": %f, \"gops\": %.3f, "
+                            "\"trials\": %d, \"correct\": \"%s\"}",
+                            firstRow ? "" : ",", engine->name, sizeNames[s], m, k, n, cutoff,
+                            stats.median, stats.min, stats.stddev, gops, trials, result);
+                }
+                firstRow = 0;
+
+                if (splitDir != NULL) {
+                    char path[512];
+                    if (engine->usesCutoff && cutoffs[c] == CUTOFF_AUTO) {
+                        snprintf(path, sizeof(path), "%s/%s_cutoff_auto.csv", splitDir, engine->name);
+                    } else if (engine->usesCutoff) {
+                        snprintf(path, sizeof(path), "%s/%s_cutoff_%d.csv", splitDir, engine->name, cutoff);
+                    } else {
+                        snprintf(path, sizeof(path), "%s/%s.csv", splitDir, engine->name);
+                    }
+                    int started = splitStarted[e][c];
+                    FILE* split = fopen(path, started ? "a" : "w");
+                    if (split != NULL) {
+                        splitStarted[e][c] = 1;
+                        if (!started) {
+                            fprintf(split, "Matrix Size,Time (seconds),Min time (seconds),Stddev (seconds),GOP/s\n");
+                        }
+                        fprintf(split, "%s,%f,%f,%f,%.3f\n", sizeNames[s], stats.median, stats.min, stats.stddev, gops);
+                        fclose(split);
+                    }
+                }
+            }
+        }
+
+        freeMatrix(&A);
+        freeMatrix(&B);
+        freeMatrix(&C);
+        freeMatrix(&R);
+    }
+
+    if (json != NULL) {
+        fprintf(json, "\n]\n");
+        fclose(json);
+    }
+    if (csv != NULL) fclose(csv);
+    if (runtime != NULL) runtimeDestroy(runtime);
+    free(times);
+
+    if (failures > 0) {
+        fprintf(stderr, "%d configuration(s) gave a wrong product\n", failures);
+        return 1;
+    }
+    return 0;
+}
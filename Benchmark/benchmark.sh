@@ -0,0 +1,41 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Times every engine in one process (wall clock, median of several trials)
+# and writes performance/results_<suffix>.csv and .json, plus one
+# <engine>[_cutoff_<c>].csv per engine in the format of the plot.py scripts
+if [ $# -lt 1 ] || [ $# -gt 3 ]; then
+    echo "Usage: $0 <cutoff_value> [naive|blocked] [engines]"
+    echo "  cutoff_value: Size threshold below which standard multiplication is used"
+    echo "  leaf:         Kernel used below the cutoff (default: naive)"
+    echo "  engines:      Comma-separated list (default: mul,blocked,strassen,hybrid,winograd,morton)"
+    exit 1
+fi
+
+CUTOFF=$1
+LEAF=${2:-naive}
+ENGINES=${3:-mul,blocked,strassen,hybrid,winograd,morton}
+echo "Using cutoff value: $CUTOFF ($LEAF leaf)"
+
+SUFFIX="cutoff_${CUTOFF}"
+if [ "$LEAF" != "naive" ]; then
+    SUFFIX="cutoff_${CUTOFF}_${LEAF}"
+fi
+
+echo "Compiling with -O3..."
+gcc -O3 -pthread bench.c ../matrix_operation/*.c -lm -o bench || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+
+./bench --engines "$ENGINES" --sizes 64,128,256,512,1024,2048,4096 --cutoffs "$CUTOFF" --leaf "$LEAF" \
+        --warmup 1 --trials 5 --csv "performance/results_${SUFFIX}.csv" \
+        --json "performance/results_${SUFFIX}.json" --split performance
+
+echo "✅ All benchmarks completed with cutoff value $CUTOFF."
+read -p "Display a graph of the benchmark data? (Y/n): " response
+if [[ "$response" =~ ^[Yy]$ || "$response" == "" ]]; then
+    echo "Executing the Python script..."
+    python3 plot.py "performance/results_${SUFFIX}.csv" "$CUTOFF"
+else
+    echo "The graph display will not be executed."
+fi
@@ -0,0 +1,41 @@
+import csv
+import sys
+import matplotlib.pyplot as plt
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'performance/results_cutoff_64.csv'
+cutoff = sys.argv[2] if len(sys.argv) > 2 else '64'
+
+# One curve per engine and cutoff: median time with min-max error bars
+series = {}
+
+with open(path, newline='') as csvfile:
+    reader = csv.DictReader(csvfile)
+    for row in reader:
+        if 'x' in row['Matrix Size']:
+            continue
+        label = row['Engine'] if row['Cutoff'] == '0' else f"{row['Engine']} (cutoff {row['Cutoff']})"
+        points = series.setdefault(label, ([], [], [], []))
+        points[0].append(int(row['Matrix Size']))
+        points[1].append(float(row['Time (seconds)']))
+        points[2].append(float(row['Stddev (seconds)']))
+        points[3].append(float(row['GOP/s']))
+
+fig, (timeAxis, rateAxis) = plt.subplots(1, 2, figsize=(14, 6))
+for label, (sizes, times, stddevs, rates) in series.items():
+    timeAxis.errorbar(sizes, times, yerr=stddevs, marker='o', linestyle='-', capsize=3, label=label)
+    rateAxis.plot(sizes, rates, marker='o', linestyle='-', label=label)
+
+timeAxis.set_title(f'Median time (cutoff {cutoff})')
+timeAxis.set_ylabel('Time (seconds)')
+timeAxis.set_yscale('log')
+rateAxis.set_title(f'Rate, 2n^3 / time (cutoff {cutoff})')
+rateAxis.set_ylabel('GOP/s')
+for axis in (timeAxis, rateAxis):
+    axis.set_xlabel('Matrix Size (N x N)')
+    axis.set_xscale('log', base=2)
+    axis.grid(True)
+    axis.legend()
+plt.tight_layout()
+
+plt.savefig("benchmark_performance.png")
+plt.show()
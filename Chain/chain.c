@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+
+#define MAX_CHAIN 64
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Prints the parenthesisation of matrices i..j
+ * @param split  Split points returned by chainPlan
+ * @param count  Number of matrices
+ * @param i      First matrix
+ * @param j      Last matrix
+ */
+static void printPlan(const int* split, int count, int i, int j) {
+    if (i == j) {
+        printf("M%d", i + 1);
+        return;
+    }
+    int s = split[i * count + j];
+    printf("(");
+    printPlan(split, count, i, s);
+    printf(" ");
+    printPlan(split, count, s + 1, j);
+    printf(")");
+}
+
+/**
+ * Main function
+ * Multiplies a chain in the planned order and left to right, compares
+ * the results and prints the model costs and the times
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --verify[=<bound>] also checks the planned product against the chain with Freivalds' algorithm */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 3 || argc > 4) {
+        printf("Usage: %s <d0,d1,...,dn> <cutoff> [naive|blocked] [--verify[=<bound>]]\n", argv[0]);
+        printf("  matrix i is d(i-1) x d(i)\n");
+        return 1;
+    }
+
+    int dims[MAX_CHAIN + 1];
+    int count = -1;
+    for (char* token = strtok(argv[1], ","); token != NULL && count < MAX_CHAIN; token = strtok(NULL, ",")) {
+        dims[++count] = atoi(token);
+    }
+    int cutoff = atoi(argv[2]);
+    if (argc == 4 && strcmp(argv[3], "blocked") == 0) {
+        setHybridLeaf(LEAF_BLOCKED);
+    }
+    if (count < 1) return 1;
+
+    struct Matrix mats[MAX_CHAIN];
+    struct Matrix* ptrs[MAX_CHAIN];
+    srand(42);
+    for (int i = 0; i < count; i++) {
+        mats[i] = allocMatrixRect(dims[i], dims[i + 1]);
+        if (mats[i].matrix == NULL) return 1;
+        fillMatrixRand(&mats[i]);
+        ptrs[i] = &mats[i];
+    }
+    struct Matrix C = allocMatrixRect(dims[0], dims[count]);
+    struct Matrix L = allocMatrixRect(dims[0], dims[count]);
+    if (C.matrix == NULL || L.matrix == NULL) return 1;
+
+    int split[MAX_CHAIN * MAX_CHAIN];
+    chainPlan(dims, count, cutoff, split);
+    printf("plan: ");
+    printPlan(split, count, 0, count - 1);
+    printf("\n");
+
+    struct ChainReport report;
+    double start = nowSeconds();
+    if (chainMul(ptrs, count, &C, cutoff, &report) == NULL) return 1;
+    double plannedTime = nowSeconds() - start;
+
+    /* Left to right with the hybrid engine, one temporary per product */
+    start = nowSeconds();
+    struct Matrix acc = allocMatrixRect(dims[0], dims[1]);
+    copySubmatrixRect(&mats[0], 0, 0, &acc, 0, 0, dims[0], dims[1]);
+    for (int i = 1; i < count; i++) {
+        struct Matrix* out = i == count - 1 ? &L : NULL;
+        struct Matrix next;
+        if (out == NULL) {
+            next = allocMatrixRect(dims[0], dims[i + 1]);
+            out = &next;
+        }
+        strassenMul_hybrid(&acc, &mats[i], out, cutoff);
+        freeMatrix(&acc);
+        if (i < count - 1) acc = next;
+    }
+    if (count == 1) {
+        copySubmatrixRect(&acc, 0, 0, &L, 0, 0, dims[0], dims[1]);
+        freeMatrix(&acc);
+    }
+    double leftTime = nowSeconds() - start;
+
+    for (int i = 0; i < C.row; i++) {
+        if (memcmp(&matrixElem(C.matrix, i, 0, C.ld), &matrixElem(L.matrix, i, 0, L.ld),
+                   sizeof(int) * C.col) != 0) {
+            fprintf(stderr, "Planned and left-to-right results differ\n");
+            return 1;
+        }
+    }
+
+    printf("planned_cost,left_to_right_cost,buffer_bytes,planned_time,left_to_right_time\n");
+    printf("%.4g,%.4g,%zu,%f,%f\n", report.plannedCost, report.leftToRightCost, report.bufferBytes,
+           plannedTime, leftTime);
+
+    int status = 0;
+    if (verify > 0) {
+        int result = verifyChainProduct(ptrs, count, &C, verify, (unsigned long long)time(NULL));
+        fprintf(stderr, "verify: %s, %d rounds, false-positive bound %g\n",
+                result == 1 ? "passed" : (result == 0 ? "FAILED" : "not checked"),
+                freivaldsRounds(verify), verify);
+        status = result != 1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        freeMatrix(&mats[i]);
+    }
+    freeMatrix(&C);
+    freeMatrix(&L);
+    return status;
+}
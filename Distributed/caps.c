@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
+#include "../matrix_operation/distributed.h"
+
+/**
+ * Main function
+ * Multiplies two matrices with the CAPS schedule on all MPI ranks and
+ * prints the schedule, the communication volume and the times (rank 0)
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    struct MatrixFileArgs files;
+    double verify = 0;
+    if (parseMatrixFileArgs(&argc, argv, &files) != 0 || parseVerifyArg(&argc, argv, &verify) != 0 ||
+        argc < 3 || argc > 7) {
+        if (rank == 0) {
+            printf("Usage: mpirun -np <1|7|49|...> %s <matrix_size|MxKxN> <cutoff|auto> [memory_MB] [naive|blocked] [check]\n",
+                   argv[0]);
+            printf("  memory_MB limits the memory per rank (0 = no limit); DFS steps are added until it fits\n");
+            printf("  --in A.bin B.bin and --out C.bin are read and written by rank 0\n");
+            printf("  check compares the result with strassenMul_hybrid on rank 0\n");
+            printf("  --verify[=<bound>] checks the result with Freivalds' algorithm on rank 0\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    int m, k, n;
+    if (sscanf(argv[1], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = atoi(argv[1]);
+    }
+    int cutoff = strcmp(argv[2], "auto") == 0 ? CUTOFF_AUTO : atoi(argv[2]);
+    size_t memoryLimit = 0;
+    int check = 0;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            setHybridLeaf(LEAF_BLOCKED);
+        } else if (strcmp(argv[i], "check") == 0) {
+            check = 1;
+        } else if (strcmp(argv[i], "naive") != 0) {
+            memoryLimit = (size_t)(atof(argv[i]) * 1024 * 1024);
+        }
+    }
+
+    /* Operands live on rank 0 only; the engine distributes them */
+    struct MappedMatrix mA, mB, mC;
+    int ok = 1;
+    if (rank == 0) {
+        ok = openMatrixOperands(&files, m, k, n, &mA, &mB, &mC) == 0;
+        if (ok && files.inA == NULL) {
+            srand(42);
+            fillMatrixRand(&mA.mat);
+            fillMatrixRand(&mB.mat);
+        }
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (!ok) {
+        MPI_Finalize();
+        return 1;
+    }
+
+    struct CapsReport report;
+    int status = strassenMul_caps(rank == 0 ? &mA.mat : NULL, rank == 0 ? &mB.mat : NULL,
+                                  rank == 0 ? &mC.mat : NULL, cutoff, memoryLimit, MPI_COMM_WORLD, &report);
+    if (status != 0) {
+        if (rank == 0) fprintf(stderr, "A rank cannot allocate its buffers\n");
+    } else if (rank == 0) {
+        if (check) {
+            struct Matrix R = allocMatrixRect(m, n);
+            status = R.matrix == NULL || strassenMul_hybrid(&mA.mat, &mB.mat, &R, cutoff) == NULL;
+            for (int i = 0; i < m && status == 0; i++) {
+                status = memcmp(&matrixElem(R.matrix, i, 0, R.ld), &matrixElem(mC.mat.matrix, i, 0, mC.mat.ld),
+                                sizeof(int) * n) != 0;
+            }
+            if (status != 0) fprintf(stderr, "Distributed and local results differ\n");
+            freeMatrix(&R);
+        }
+        if (verify > 0 && verifyProductReport(stderr, &mA.mat, &mB.mat, &mC.mat, verify) != 0) {
+            status = 1;
+        }
+        printCapsReport(stdout, &report);
+    }
+
+    if (rank == 0) {
+        unmapMatrixFile(&mA);
+        unmapMatrixFile(&mB);
+        unmapMatrixFile(&mC);
+    }
+    MPI_Finalize();
+    return status != 0;
+}
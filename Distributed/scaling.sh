@@ -0,0 +1,44 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Runs the CAPS engine on 1, 7 and 49 ranks for one product and records
+# the schedule, the communication volume and the times
+if [ $# -lt 2 ] || [ $# -gt 4 ]; then
+    echo "Usage: $0 <matrix_size|MxKxN> <cutoff_value> [memory_MB] [naive|blocked]"
+    echo "  memory_MB: Memory limit per rank, 0 = no limit (default)"
+    echo "  leaf:      Kernel used below the cutoff (default: naive)"
+    exit 1
+fi
+
+SIZE=$1
+CUTOFF=$2
+MEMORY=${3:-0}
+LEAF=${4:-naive}
+echo "Product $SIZE, cutoff $CUTOFF ($LEAF leaf), memory limit $MEMORY MB per rank"
+
+echo "Compiling with mpicc -O3 -DMATRIX_MPI..."
+mpicc -O3 -DMATRIX_MPI -pthread caps.c ../matrix_operation/*.c -lm -o caps || { echo "Compilation failed."; exit 1; }
+
+# Root needs --allow-run-as-root; more ranks than cores needs --oversubscribe
+MPIRUN_FLAGS="--oversubscribe"
+if [ "$(id -u)" -eq 0 ]; then
+    MPIRUN_FLAGS="$MPIRUN_FLAGS --allow-run-as-root"
+fi
+
+mkdir -p performance
+PERFORMANCE_FILE="performance/scaling_${SIZE}_cutoff_${CUTOFF}.csv"
+echo "size,ranks,schedule,padded,memory_bytes,comm_bytes,max_rank_comm_bytes,distribute_bytes,seconds,comm_seconds,speedup" > "$PERFORMANCE_FILE"
+
+BASE=""
+for ranks in 1 7 49; do
+    echo "Running on $ranks ranks"
+    line=$(mpirun $MPIRUN_FLAGS -np "$ranks" ./caps "$SIZE" "$CUTOFF" "$MEMORY" "$LEAF" check | tail -n 1)
+    seconds=$(echo "$line" | cut -d, -f8)
+    if [ -z "$BASE" ]; then
+        BASE=$seconds
+    fi
+    speedup=$(awk -v b="$BASE" -v s="$seconds" 'BEGIN { if (s > 0) printf "%.3f", b / s; else print "" }')
+    echo "$SIZE,$line,$speedup" >> "$PERFORMANCE_FILE"
+done
+
+echo "✅ Results saved to $PERFORMANCE_FILE"
@@ -1,4 +1,5 @@
 #!/usr/bin/env python3
+import glob
 import subprocess
 import os
 import sys
@@ -19,22 +20,49 @@ TRIALS = 3  # Number of trials for each configuration
 
 MAX_WORKERS = max(1, multiprocessing.cpu_count() - 1)
 
+# Socket of a running multiplication daemon (Server/server.c); when set, the
+# trials run in the daemon instead of one process each
+STRASSEN_SERVER = os.environ.get("STRASSEN_SERVER")
+_server_client = None
+_server_operands = {}
+
 def compile_program():
     """Compile the C program"""
     print("Compiling C program...")
     try:
         # Removed the -fsanitize=address flag to reduce memory usage
         subprocess.run([
-            "gcc", "-pg", "-O3", C_SOURCE, "-o", C_PROGRAM, 
-            "-lm", "../matrix_operation/matrix.c", "-g"
+            "gcc", "-pg", "-O3", "-pthread", C_SOURCE, "-o", C_PROGRAM, 
+            *glob.glob("../matrix_operation/*.c"), "-lm", "-g"
         ], check=True)
         print("Compilation successful.")
     except subprocess.CalledProcessError:
         print("Compilation failed.")
         sys.exit(1)
 
+def run_server_test(matrix_size, cutoff):
+    """Run the trials of one configuration in the daemon, reusing the connection and operands of the worker"""
+    global _server_client
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Server"))
+    import strassen_client
+    try:
+        if _server_client is None:
+            _server_client = strassen_client.StrassenClient(STRASSEN_SERVER)
+        if matrix_size not in _server_operands:
+            ops = strassen_client.SharedOperands(matrix_size, matrix_size, matrix_size)
+            ops.fill(1, 1)
+            _server_operands[matrix_size] = ops
+        ops = _server_operands[matrix_size]
+        times = [_server_client.multiply(ops, cutoff)[0] for _ in range(TRIALS)]
+    except (OSError, RuntimeError) as e:
+        print(f"Error running test with size={matrix_size}, cutoff={cutoff}: {e}")
+        return matrix_size, cutoff, None
+    return matrix_size, cutoff, sum(times) / len(times)
+
 def run_single_test(matrix_size, cutoff):
     """Run a single test with given matrix size and cutoff"""
+    if STRASSEN_SERVER:
+        return run_server_test(matrix_size, cutoff)
     times = []
     for _ in range(TRIALS):
         try:
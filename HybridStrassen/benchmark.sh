@@ -2,34 +2,45 @@
 set -e  # Exit immediately if any command fails
 
 # Check if cutoff parameter was provided
-if [ $# -ne 1 ]; then
-    echo "Usage: $0 <cutoff_value>"
+if [ $# -ne 1 ] && [ $# -ne 2 ]; then
+    echo "Usage: $0 <cutoff_value> [naive|blocked]"
     echo "  cutoff_value: Size threshold below which standard multiplication is used"
+    echo "  leaf:         Kernel used below the cutoff (default: naive)"
     exit 1
 fi
 
 CUTOFF=$1
-echo "Using Strassen cutoff value: $CUTOFF"
+LEAF=${2:-naive}
+echo "Using Strassen cutoff value: $CUTOFF ($LEAF leaf)"
+
+# The naive leaf keeps the historical file names
+SUFFIX="cutoff_${CUTOFF}"
+if [ "$LEAF" != "naive" ]; then
+    SUFFIX="cutoff_${CUTOFF}_${LEAF}"
+fi
 
 echo "Compiling with -pg and -O3..."
-gcc -pg -O3 hybrid_strassen.c -lm  ../matrix_operation/matrix.c -o hybrid || { echo "Compilation failed."; exit 1; }
+gcc -pg -O3 -pthread hybrid_strassen.c ../matrix_operation/*.c -lm -o hybrid || { echo "Compilation failed."; exit 1; }
 
 mkdir -p performance
 mkdir -p analysis
 
 # Include cutoff value in the filename
-PERFORMANCE_FILE="performance/performance_cutoff_${CUTOFF}.csv"
-echo "Matrix Size,Time (seconds)" > "$PERFORMANCE_FILE"
+PERFORMANCE_FILE="performance/performance_${SUFFIX}.csv"
+# The last column times the same run with the scalar helper kernels (MATRIX_SIMD=scalar)
+echo "Matrix Size,Time (seconds),Scalar time (seconds)" > "$PERFORMANCE_FILE"
 
 for power in {2..12}; do
     size=$((2 ** power))
     echo "Running test for size ${size}x${size} with cutoff $CUTOFF"
+    # Scalar run first, so that gmon.out profiles the dispatched kernels
+    scalar=$(MATRIX_SIMD=scalar ./hybrid "$size" "$CUTOFF" "$LEAF")
     rm -f gmon.out
-    output=$(./hybrid "$size" "$CUTOFF")
-    echo "$output" >> "$PERFORMANCE_FILE"
+    output=$(./hybrid "$size" "$CUTOFF" "$LEAF")
+    echo "$output,${scalar#*,}" >> "$PERFORMANCE_FILE"
     if [[ -f gmon.out ]]; then
-        gprof hybrid gmon.out > "analysis/analysis_${size}_cutoff_${CUTOFF}.txt"
-        echo "Profiling saved to analysis/analysis_${size}_cutoff_${CUTOFF}.txt"
+        gprof hybrid gmon.out > "analysis/analysis_${size}_${SUFFIX}.txt"
+        echo "Profiling saved to analysis/analysis_${size}_${SUFFIX}.txt"
     else
         echo "⚠️  gmon.out not generated for size $size"
     fi
@@ -1,8 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 #include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
+#include "../matrix_operation/counters.h"
+#include "../matrix_operation/trace.h"
 
 /**
  * Main function
@@ -11,39 +15,87 @@
  * @return      0 on success, 1 on failure
  */
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        printf("Usage: %s <matrix_size>\n", argv[0]);
+    /* --in A.bin B.bin / --out C.bin replace the all-ones inputs and the heap result */
+    struct MatrixFileArgs files;
+    if (parseMatrixFileArgs(&argc, argv, &files) != 0) {
+        return 1;
+    }
+    /* --verify[=<bound>] checks C with Freivalds' algorithm after the timed product */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 3 || argc > 8) {
+        printf("Usage: %s <matrix_size|MxKxN>\n", argv[0]);
         printf("Usage: %s cutoff \n", argv[0]);
+        printf("Usage: %s [naive|blocked] [--pad] [zeroblocks|zeroskip] [counters] [trace=<file.json>]\n", argv[0]);
+        printf("  zeroblocks skips the products of zero quadrants, zeroskip also crops trailing zeros\n");
+        printf("  --in A.bin B.bin and --out C.bin read the operands from and write C to matrix files\n");
+        printf("  --verify[=<bound>] checks C with Freivalds' algorithm, false-positive bound 1e-9 by default\n");
+        printf("  cutoff auto uses the profile named by $%s\n", CUTOFF_PROFILE_ENV);
         return 1;
     }
 
     int originalSide = atoi(argv[1]);
-    int cutoff = atoi(argv[2]);
-    int paddedSide = nextPowerOfTwo(originalSide);
+    /* "auto" (or 0) is CUTOFF_AUTO: cutoff from the tuned profile */
+    int cutoff = strcmp(argv[2], "auto") == 0 ? CUTOFF_AUTO : atoi(argv[2]);
+    /* <matrix_size> is a side, or MxKxN for an M x K by K x N product */
+    int m, k, n;
+    if (sscanf(argv[1], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = originalSide;
+    }
+    int pad = 0;
+    int counters = 0;
+    const char* tracePath = NULL;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            setHybridLeaf(LEAF_BLOCKED);
+        } else if (strcmp(argv[i], "--pad") == 0) {
+            pad = 1;
+        } else if (strcmp(argv[i], "zeroblocks") == 0) {
+            setZeroBlockSkip(ZERO_SKIP_BLOCKS);
+        } else if (strcmp(argv[i], "zeroskip") == 0) {
+            setZeroBlockSkip(ZERO_SKIP_TRAILING);
+        } else if (strcmp(argv[i], "counters") == 0) {
+            counters = 1;
+        } else if (strncmp(argv[i], "trace=", 6) == 0) {
+            tracePath = argv[i] + 6;
+        }
+    }
+    /* Odd sides are peeled by the library; --pad restores the padding to a power-of-two square */
+    int paddedSide = nextPowerOfTwo(m > k ? (m > n ? m : n) : (k > n ? k : n));
+    int paddedM = pad ? paddedSide : m;
+    int paddedK = pad ? paddedSide : k;
+    int paddedN = pad ? paddedSide : n;
+    if (pad && files.inA != NULL) {
+        fprintf(stderr, "--pad cannot be used with --in\n");
+        return 1;
+    }
 
     // Commenta stampe informative
     
 //    printf("Testing with matrix size %d x %d...\n", originalSide, originalSide);
 //    printf("Original matrix size: %d x %d\n", originalSide, originalSide);
-//    printf("Padded matrix size: %d x %d\n", paddedSide, paddedSide);
+//    printf("Padded matrix size: %d x %d\n", paddedM, paddedN);
     
-    struct Matrix A = allocMatrix(paddedSide);
-    struct Matrix B = allocMatrix(paddedSide);
-    struct Matrix C = allocMatrix(paddedSide);
-
-    if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL) {
+    struct MappedMatrix mA, mB, mC;
+    if (openMatrixOperands(&files, paddedM, paddedK, paddedN, &mA, &mB, &mC) != 0) {
         // fprintf(stderr, "Memory allocation failed for size %d\n", originalSide);
         return 1;
     }
+    struct Matrix A = mA.mat;
+    struct Matrix B = mB.mat;
+    struct Matrix C = mC.mat;
 
-    for (int i = 0; i < paddedSide; i++) {
-        for (int j = 0; j < paddedSide; j++) {
-            if (i < originalSide && j < originalSide) {
-                matrixElem(A.matrix, i, j, paddedSide) = 1;
-                matrixElem(B.matrix, i, j, paddedSide) = 1;
-            } else {
-                matrixElem(A.matrix, i, j, paddedSide) = 0;
-                matrixElem(B.matrix, i, j, paddedSide) = 0;
+    if (files.inA == NULL) {
+        for (int i = 0; i < A.row; i++) {
+            for (int j = 0; j < A.col; j++) {
+                matrixElem(A.matrix, i, j, A.ld) = (i < m && j < k) ? 1 : 0;
+            }
+        }
+        for (int i = 0; i < B.row; i++) {
+            for (int j = 0; j < B.col; j++) {
+                matrixElem(B.matrix, i, j, B.ld) = (i < k && j < n) ? 1 : 0;
             }
         }
     }
@@ -55,9 +107,29 @@ int main(int argc, char* argv[]) {
     printMatrix(&B);
 */
 
+    /* Per-level counters need a build with -DMATRIX_COUNTERS */
+    if (counters && countersStart() < 0) {
+        fprintf(stderr, "Built without -DMATRIX_COUNTERS, counters disabled\n");
+        counters = 0;
+    }
+
     clock_t t = clock();
-    strassenMul_hybrid(&A, &B, &C, cutoff);
+    if (pad && getZeroBlockSkip() == ZERO_SKIP_TRAILING) {
+        /* The padding is known here, no need to scan for it */
+        strassenMul_padded(&A, &B, &C, cutoff, m, k, n);
+    } else {
+        strassenMul_hybrid(&A, &B, &C, cutoff);
+    }
     t = clock() - t;
+
+    if (counters) {
+        countersStop();
+        countersPrint(stderr);
+    }
+    /* Chrome trace of the run, needs a build with -DMATRIX_TRACE */
+    if (tracePath != NULL && traceWrite(tracePath) < 0) {
+        fprintf(stderr, "No trace written: built without -DMATRIX_TRACE or cannot open %s\n", tracePath);
+    }
     double timeTaken = ((double)t) / CLOCKS_PER_SEC;
 /*
     printf("\n\nStrassen multiplication took %f seconds to execute\n", timeTaken);
@@ -65,15 +137,20 @@ int main(int argc, char* argv[]) {
     printf("\nResult Matrix C = A * B (Strassen):\n");
     for (int i = 0; i < originalSide; i++) {
         for (int j = 0; j < originalSide; j++) {
-            printf("(%d,%d): %4d  ", i, j, matrixElem(C.matrix, i, j, paddedSide));
+            printf("(%d,%d): %4d  ", i, j, matrixElem(C.matrix, i, j, C.ld));
         }
         printf("\n");
     }
 */
-   	printf("%d,%f\n", originalSide, timeTaken);
+   	printf("%s,%f\n", argv[1], timeTaken);
 	
-    freeMatrix(&A);
-    freeMatrix(&B);
-    freeMatrix(&C);
-    return 0;
+    int status = 0;
+    if (verify > 0 && verifyProductReport(stderr, &A, &B, &C, verify) != 0) {
+        status = 1;
+    }
+
+    unmapMatrixFile(&mA);
+    unmapMatrixFile(&mB);
+    unmapMatrixFile(&mC);
+    return status;
 }
@@ -0,0 +1,40 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Times the hybrid engine on sizes that are not powers of two, with
+# dynamic peeling (default) and with padding to the next power of two
+if [ $# -lt 1 ] || [ $# -gt 5 ]; then
+    echo "Usage: $0 <cutoff_value> [first_size] [last_size] [step] [naive|blocked]"
+    echo "  Sizes default to 1000..2200 in steps of 75"
+    exit 1
+fi
+
+CUTOFF=$1
+FIRST=${2:-1000}
+LAST=${3:-2200}
+STEP=${4:-75}
+LEAF=${5:-naive}
+echo "Sweeping sizes $FIRST..$LAST (step $STEP) with cutoff $CUTOFF ($LEAF leaf)"
+
+SUFFIX="cutoff_${CUTOFF}"
+if [ "$LEAF" != "naive" ]; then
+    SUFFIX="cutoff_${CUTOFF}_${LEAF}"
+fi
+
+echo "Compiling with -O3..."
+gcc -O3 -pthread hybrid_strassen.c ../matrix_operation/*.c -lm -o hybrid || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+
+SWEEP_FILE="performance/sweep_${SUFFIX}.csv"
+echo "Matrix Size,Time (seconds),Padded time (seconds)" > "$SWEEP_FILE"
+
+for size in $(seq "$FIRST" "$STEP" "$LAST"); do
+    echo "Running test for size ${size}x${size}"
+    peeled=$(./hybrid "$size" "$CUTOFF" "$LEAF")
+    padded=$(./hybrid "$size" "$CUTOFF" "$LEAF" --pad)
+    echo "$peeled,${padded#*,}" >> "$SWEEP_FILE"
+done
+rm -f gmon.out
+
+echo "✅ Sweep saved to $SWEEP_FILE"
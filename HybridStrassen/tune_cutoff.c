@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../matrix_operation/matrix.h"
+
+/**
+ * Main function
+ * Tunes the hybrid cutoff in-process for each size and writes the
+ * per-machine profile read by strassenMul_hybrid(..., CUTOFF_AUTO)
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 6) {
+        printf("Usage: %s <profile> <min_cutoff> <max_cutoff> <step> <size>... [naive|blocked]\n", argv[0]);
+        printf("  each size is the upper bound of a band, in increasing order\n");
+        printf("  use the profile with: %s=<profile> ./hybrid <size> auto\n", CUTOFF_PROFILE_ENV);
+        return 1;
+    }
+
+    const char* path = argv[1];
+    int minCutoff = atoi(argv[2]);
+    int maxCutoff = atoi(argv[3]);
+    int step = atoi(argv[4]);
+    int sides[32];
+    int count = 0;
+
+    for (int i = 5; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            setHybridLeaf(LEAF_BLOCKED);
+        } else if (strcmp(argv[i], "naive") != 0 && count < 32) {
+            sides[count++] = atoi(argv[i]);
+        }
+    }
+
+    int status = tuneCutoffProfile(path, sides, count, minCutoff, maxCutoff, step);
+    if (status == -2 && (minCutoff > maxCutoff || maxCutoff < 1)) {
+        fprintf(stderr, "Tuning failed: no cutoff >= 1 between %d and %d\n", minCutoff, maxCutoff);
+        return 1;
+    }
+    if (status == -2) {
+        fprintf(stderr, "Tuning failed: give 1 to 32 sizes in increasing order\n");
+        return 1;
+    }
+    if (status != 0) {
+        fprintf(stderr, "Tuning failed: out of memory or cannot write %s\n", path);
+        return 1;
+    }
+    if (loadCutoffProfile(path) != 0) {
+        fprintf(stderr, "Cannot read back the profile %s\n", path);
+        return 1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        printf("%d,%d\n", sides[i], profileCutoff(sides[i]));
+    }
+    return 0;
+}
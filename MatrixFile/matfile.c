@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
+
+/**
+ * Writes a rows x cols matrix file filled with ones or random values
+ * @param shape  "RxC" or a side
+ * @param path   Output file
+ * @param fill   "ones" or "rand"
+ * @return       0 on success, 1 on failure
+ */
+static int generate(const char* shape, const char* path, const char* fill) {
+    int rows, cols;
+    if (sscanf(shape, "%dx%d", &rows, &cols) != 2) {
+        rows = cols = atoi(shape);
+    }
+
+    struct MappedMatrix out;
+    if (createMatrixFile(path, rows, cols, &out) != 0) {
+        fprintf(stderr, "Cannot create %s\n", path);
+        return 1;
+    }
+    if (strcmp(fill, "rand") == 0) {
+        fillMatrixRand(&out.mat);
+    } else {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                matrixElem(out.mat.matrix, i, j, out.mat.ld) = 1;
+            }
+        }
+    }
+    return unmapMatrixFile(&out) != 0;
+}
+
+/**
+ * Prints the shape of a matrix file and its elements
+ * @param path   Input file
+ * @return       0 on success, 1 on failure
+ */
+static int dump(const char* path) {
+    struct MappedMatrix in;
+    if (mapMatrixFile(path, 0, &in) != 0) {
+        fprintf(stderr, "Cannot map %s as an int32 matrix file\n", path);
+        return 1;
+    }
+    printf("%d x %d\n", in.mat.row, in.mat.col);
+    printMatrix(&in.mat);
+    return unmapMatrixFile(&in) != 0;
+}
+
+/**
+ * Compares two matrix files element by element
+ * @param pathA  First file
+ * @param pathB  Second file
+ * @return       0 if the matrices are equal, 1 otherwise
+ */
+static int compare(const char* pathA, const char* pathB) {
+    struct MappedMatrix a, b;
+    if (mapMatrixFile(pathA, 0, &a) != 0 || mapMatrixFile(pathB, 0, &b) != 0) {
+        fprintf(stderr, "Cannot map %s or %s\n", pathA, pathB);
+        return 1;
+    }
+
+    int equal = a.mat.row == b.mat.row && a.mat.col == b.mat.col;
+    for (int i = 0; i < a.mat.row && equal; i++) {
+        equal = memcmp(&matrixElem(a.mat.matrix, i, 0, a.mat.ld), &matrixElem(b.mat.matrix, i, 0, b.mat.ld),
+                       sizeof(int) * a.mat.col) == 0;
+    }
+    printf("%s\n", equal ? "equal" : "different");
+
+    unmapMatrixFile(&a);
+    unmapMatrixFile(&b);
+    return !equal;
+}
+
+/**
+ * Checks that a product file is the product of two operand files with
+ * Freivalds' algorithm, reading each file once per batch of rounds
+ * @param pathA  First operand
+ * @param pathB  Second operand
+ * @param pathC  Product to check
+ * @param bound  False-positive bound, NULL for VERIFY_DEFAULT_BOUND
+ * @return       0 if the product passed, 1 otherwise
+ */
+static int verifyFiles(const char* pathA, const char* pathB, const char* pathC, const char* bound) {
+    struct MappedMatrix a, b, c;
+    if (mapMatrixFile(pathA, 0, &a) != 0 || mapMatrixFile(pathB, 0, &b) != 0 || mapMatrixFile(pathC, 0, &c) != 0) {
+        fprintf(stderr, "Cannot map %s, %s or %s\n", pathA, pathB, pathC);
+        return 1;
+    }
+
+    int status = verifyProductReport(stdout, &a.mat, &b.mat, &c.mat,
+                                     bound != NULL ? atof(bound) : VERIFY_DEFAULT_BOUND) != 0;
+
+    unmapMatrixFile(&a);
+    unmapMatrixFile(&b);
+    unmapMatrixFile(&c);
+    return status;
+}
+
+/**
+ * Main function
+ * Creates, prints and compares binary matrix files for the --in / --out
+ * options of the drivers
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    if (argc >= 4 && argc <= 5 && strcmp(argv[1], "gen") == 0) {
+        return generate(argv[2], argv[3], argc == 5 ? argv[4] : "ones");
+    }
+    if (argc == 3 && strcmp(argv[1], "print") == 0) {
+        return dump(argv[2]);
+    }
+    if (argc == 4 && strcmp(argv[1], "cmp") == 0) {
+        return compare(argv[2], argv[3]);
+    }
+    if (argc >= 5 && argc <= 6 && strcmp(argv[1], "verify") == 0) {
+        return verifyFiles(argv[2], argv[3], argv[4], argc == 6 ? argv[5] : NULL);
+    }
+
+    printf("Usage: %s gen <side|RxC> <file.bin> [ones|rand]\n", argv[0]);
+    printf("       %s print <file.bin>\n", argv[0]);
+    printf("       %s cmp <a.bin> <b.bin>\n", argv[0]);
+    printf("       %s verify <A.bin> <B.bin> <C.bin> [bound]   Freivalds check of C = A * B\n", argv[0]);
+    return 1;
+}
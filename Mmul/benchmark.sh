@@ -2,22 +2,23 @@
 set -e  # Exit immediately if any command fails
 
 echo "Compiling with -pg and -O3..."
-gcc -pg -O3 mul.c -lm ../matrix_operation/matrix.c -o mul || { echo "Compilation failed."; exit 1; }
+gcc -pg -O3 -pthread mul.c ../matrix_operation/*.c -lm -o mul || { echo "Compilation failed."; exit 1; }
 
 mkdir -p performance
 mkdir -p analysis
 
 echo "Matrix Size,Time (seconds)" > performance/performance.csv
+echo "Matrix Size,Time (seconds)" > performance/performance_blocked.csv
+echo "Matrix Size,mul (seconds),blocked (seconds)" > performance/comparison.csv
 
 for power in {2..12}; do
     size=$((2 ** power))
-    echo "Running test for size ${size}x${size}..."
 
+    # Naive i-j-k kernel
+    echo "Running test for size ${size}x${size} (mul)..."
     rm -f gmon.out
-
     output=$(./mul "$size")
     echo "$output" >> performance/performance.csv
-
     if [[ -f gmon.out ]]; then
         gprof mul gmon.out > "analysis/analysis_${size}.txt"
         echo "Profiling saved to analysis/analysis_${size}.txt"
@@ -25,10 +26,25 @@ for power in {2..12}; do
         echo "⚠️  gmon.out not generated for size $size"
     fi
 
+    # Cache-blocked, packed kernel
+    echo "Running test for size ${size}x${size} (blocked)..."
+    rm -f gmon.out
+    output_blocked=$(./mul "$size" blocked)
+    echo "$output_blocked" >> performance/performance_blocked.csv
+    if [[ -f gmon.out ]]; then
+        gprof mul gmon.out > "analysis/analysis_${size}_blocked.txt"
+        echo "Profiling saved to analysis/analysis_${size}_blocked.txt"
+    else
+        echo "⚠️  gmon.out not generated for size $size"
+    fi
+
+    echo "${size},${output#*,},${output_blocked#*,}" >> performance/comparison.csv
+    echo "mul: ${output#*,}s  blocked: ${output_blocked#*,}s"
     echo
 done
 
 echo "✅ All tests and profiling completed."
+echo "Side-by-side timings saved to performance/comparison.csv"
 read -p "Display a graph of the benchmark data? (Y/n): " response
 
 if [[ "$response" =~ ^[Yy]$ || "$response" == "" ]]; then
@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 #include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
 
 /**
  * Main function
@@ -11,37 +13,69 @@
  * @return      0 on success, 1 on failure
  */
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        // printf("Usage: %s <matrix_size>\n", argv[0]);
+    /* --in A.bin B.bin / --out C.bin replace the all-ones inputs and the heap result */
+    struct MatrixFileArgs files;
+    if (parseMatrixFileArgs(&argc, argv, &files) != 0) {
+        return 1;
+    }
+    /* --verify[=<bound>] checks C with Freivalds' algorithm after the timed product */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 2 || argc > 4) {
+        // printf("Usage: %s <matrix_size|MxKxN> [naive|blocked] [--pad] [--in A.bin B.bin] [--out C.bin]\n", argv[0]);
         return 1;
     }
 
     int originalSide = atoi(argv[1]);
-    int paddedSide = nextPowerOfTwo(originalSide);
+    /* <matrix_size> is a side, or MxKxN for an M x K by K x N product */
+    int m, k, n;
+    if (sscanf(argv[1], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = originalSide;
+    }
+    int blocked = 0;
+    int pad = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            blocked = 1;
+        } else if (strcmp(argv[i], "--pad") == 0) {
+            pad = 1;   /* Same padded problem as the Strassen drivers with --pad */
+        }
+    }
+    int paddedSide = nextPowerOfTwo(m > k ? (m > n ? m : n) : (k > n ? k : n));
+    int paddedM = pad ? paddedSide : m;
+    int paddedK = pad ? paddedSide : k;
+    int paddedN = pad ? paddedSide : n;
+    if (pad && files.inA != NULL) {
+        fprintf(stderr, "--pad cannot be used with --in\n");
+        return 1;
+    }
 
     /*
     printf("Testing with matrix size %d x %d...\n", originalSide, originalSide);
     printf("Original matrix size: %d x %d\n", originalSide, originalSide);
-    printf("Padded matrix size: %d x %d\n", paddedSide, paddedSide);
+    printf("Padded matrix size: %d x %d\n", paddedM, paddedN);
     */
 
-    struct Matrix A = allocMatrix(paddedSide);
-    struct Matrix B = allocMatrix(paddedSide);
-    struct Matrix C = allocMatrix(paddedSide);
-
-    if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL) {
+    struct MappedMatrix mA, mB, mC;
+    if (openMatrixOperands(&files, paddedM, paddedK, paddedN, &mA, &mB, &mC) != 0) {
         // fprintf(stderr, "Memory allocation failed for size %d\n", originalSide);
         return 1;
     }
+    struct Matrix A = mA.mat;
+    struct Matrix B = mB.mat;
+    struct Matrix C = mC.mat;
 
-    for (int i = 0; i < paddedSide; i++) {
-        for (int j = 0; j < paddedSide; j++) {
-            if (i < originalSide && j < originalSide) {
-                matrixElem(A.matrix, i, j, paddedSide) = 1;
-                matrixElem(B.matrix, i, j, paddedSide) = 1;
-            } else {
-                matrixElem(A.matrix, i, j, paddedSide) = 0;
-                matrixElem(B.matrix, i, j, paddedSide) = 0;
+    if (files.inA == NULL) {
+        for (int i = 0; i < A.row; i++) {
+            for (int j = 0; j < A.col; j++) {
+                matrixElem(A.matrix, i, j, A.ld) = (i < m && j < k) ? 1 : 0;
+            }
+        }
+        for (int i = 0; i < B.row; i++) {
+            for (int j = 0; j < B.col; j++) {
+                matrixElem(B.matrix, i, j, B.ld) = (i < k && j < n) ? 1 : 0;
             }
         }
     }
@@ -54,7 +88,11 @@ int main(int argc, char* argv[]) {
     */
 
     clock_t t = clock();
-   	mul(&A, &B, &C); 
+    if (blocked) {
+        mulBlocked(&A, &B, &C);
+    } else {
+        mul(&A, &B, &C);
+    }
     t = clock() - t;
     double timeTaken = ((double)t) / CLOCKS_PER_SEC;
 
@@ -64,17 +102,22 @@ int main(int argc, char* argv[]) {
     printf("\nResult Matrix C = A * B (Strassen):\n");
     for (int i = 0; i < originalSide; i++) {
         for (int j = 0; j < originalSide; j++) {
-            printf("(%d,%d): %4d  ", i, j, matrixElem(C.matrix, i, j, paddedSide));
+            printf("(%d,%d): %4d  ", i, j, matrixElem(C.matrix, i, j, C.ld));
         }
         printf("\n");
     }
     */
 
-    printf("%d,%f\n", originalSide, timeTaken);
+    printf("%s,%f\n", argv[1], timeTaken);
+
+    int status = 0;
+    if (verify > 0 && verifyProductReport(stderr, &A, &B, &C, verify) != 0) {
+        status = 1;
+    }
 
-    freeMatrix(&A);
-    freeMatrix(&B);
-    freeMatrix(&C);
+    unmapMatrixFile(&mA);
+    unmapMatrixFile(&mB);
+    unmapMatrixFile(&mC);
 
-    return 0;
+    return status;
 }
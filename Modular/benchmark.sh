@@ -0,0 +1,34 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Times the mod-p engines for one prime: hybrid Strassen, the conventional
+# mulMod kernel and the int64 loop with a % per element (up to 2048, it
+# grows as n^3 with a division per multiply-add)
+if [ $# -ne 2 ]; then
+    echo "Usage: $0 <cutoff_value> <prime>"
+    exit 1
+fi
+
+CUTOFF=$1
+PRIME=$2
+
+echo "Compiling with -O3..."
+gcc -O3 -pthread modular_strassen.c ../matrix_operation/*.c -lm -o modular || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+
+PERFORMANCE_FILE="performance/modular_p_${PRIME}_cutoff_${CUTOFF}.csv"
+echo "Matrix Size,Engine,Prime,Time (seconds),GOP/s" > "$PERFORMANCE_FILE"
+
+for power in {6..12}; do
+    size=$((2 ** power))
+    for engine in strassen mul int64; do
+        if [ "$engine" == "int64" ] && [ "$power" -gt 11 ]; then
+            continue
+        fi
+        echo "Running test for size ${size}x${size} ($engine) modulo $PRIME"
+        ./modular "$size" "$CUTOFF" "$PRIME" "$engine" >> "$PERFORMANCE_FILE"
+    done
+done
+
+echo "✅ Results saved to $PERFORMANCE_FILE"
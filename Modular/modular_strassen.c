@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+
+/**
+ * Baseline: C = A * B mod p in int64 with a % after every multiply-add
+ * Same i-k-j order and data as the other engines, without lazy reduction
+ * or vectorization (the division by a run-time p is done per element)
+ *
+ * @param A      First input matrix (m x k), residues
+ * @param B      Second input matrix (k x n), residues
+ * @param C      Output matrix (m x n)
+ * @param p      Prime
+ * @return       0 on success, -1 if the int64 rows cannot be allocated
+ */
+static int mulInt64Mod(struct Matrix* A, struct Matrix* B, struct Matrix* C, int64_t p) {
+    int64_t* row = malloc(sizeof(int64_t) * (B->col > 0 ? B->col : 1));
+    if (row == NULL) return -1;
+
+    for (int i = 0; i < A->row; i++) {
+        memset(row, 0, sizeof(int64_t) * B->col);
+        for (int k = 0; k < A->col; k++) {
+            int64_t a = matrixElem(A->matrix, i, k, A->ld);
+            const int* b = &matrixElem(B->matrix, k, 0, B->ld);
+            for (int j = 0; j < B->col; j++) {
+                row[j] = (row[j] + a * b[j]) % p;
+            }
+        }
+        for (int j = 0; j < B->col; j++) {
+            matrixElem(C->matrix, i, j, C->ld) = (int)row[j];
+        }
+    }
+    free(row);
+    return 0;
+}
+
+/**
+ * Main function
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --verify[=<bound>] checks C with Freivalds' algorithm over the field */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc != 5) {
+        printf("Usage: %s <matrix_size|MxKxN> <cutoff> <prime> <strassen|mul|int64> [--verify[=<bound>]]\n", argv[0]);
+        printf("  strassen: strassenMulMod_hybrid, mul: mulMod, int64: int64 loop with %% per element\n");
+        return 1;
+    }
+
+    int m, k, n;
+    if (sscanf(argv[1], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = atoi(argv[1]);
+    }
+    int cutoff = atoi(argv[2]);
+    struct ModField field;
+    if (modFieldInit(&field, (uint32_t)strtoul(argv[3], NULL, 10)) != 0) {
+        printf("%s is not an odd prime below 2^31\n", argv[3]);
+        return 1;
+    }
+    const char* engine = argv[4];
+    if (strcmp(engine, "strassen") != 0 && strcmp(engine, "mul") != 0 && strcmp(engine, "int64") != 0) {
+        printf("Unknown engine %s\n", engine);
+        return 1;
+    }
+
+    struct Matrix A = allocMatrixRect(m, k);
+    struct Matrix B = allocMatrixRect(k, n);
+    struct Matrix C = allocMatrixRect(m, n);
+    if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL) {
+        return 1;
+    }
+    fillMatrixRandMod(&A, &field, 1);
+    fillMatrixRandMod(&B, &field, 2);
+
+    clock_t t = clock();
+    int status = 0;
+    if (strcmp(engine, "strassen") == 0) {
+        status = strassenMulMod_hybrid(&A, &B, &C, cutoff, &field) == NULL ? -1 : 0;
+    } else if (strcmp(engine, "mul") == 0) {
+        mulMod(&A, &B, &C, &field);
+    } else {
+        status = mulInt64Mod(&A, &B, &C, field.p);
+    }
+    t = clock() - t;
+    if (status != 0) {
+        return 1;
+    }
+
+    double timeTaken = ((double)t) / CLOCKS_PER_SEC;
+    /* Rate of the conventional algorithm (2mkn operations), comparable across engines */
+    double gops = timeTaken > 0 ? 2.0 * m * k * n / timeTaken / 1e9 : 0;
+    printf("%s,%s,%u,%f,%f\n", argv[1], engine, field.p, timeTaken, gops);
+
+    int exitCode = 0;
+    if (verify > 0) {
+        int verified = verifyProductMod(&A, &B, &C, &field, verify, (unsigned long long)time(NULL));
+        fprintf(stderr, "verify: %s, false-positive bound %g\n",
+                verified == 1 ? "passed" : (verified == 0 ? "FAILED" : "not checked"), verify);
+        exitCode = verified == 1 ? 0 : 1;
+    }
+    freeMatrix(&A);
+    freeMatrix(&B);
+    freeMatrix(&C);
+    return exitCode;
+}
@@ -0,0 +1,44 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Measures what the Morton layout costs (conversion of A, B and C) and
+# what it saves (multiplication on contiguous blocks) against the
+# row-major hybrid engine, size by size, same cutoff and leaf
+if [ $# -ne 1 ] && [ $# -ne 2 ]; then
+    echo "Usage: $0 <cutoff_value> [naive|blocked]"
+    echo "  cutoff_value: Largest tile side, below which standard multiplication is used"
+    echo "  leaf:         Kernel used on the tiles (default: naive)"
+    exit 1
+fi
+
+CUTOFF=$1
+LEAF=${2:-naive}
+echo "Using cutoff value: $CUTOFF ($LEAF leaf)"
+
+SUFFIX="cutoff_${CUTOFF}"
+if [ "$LEAF" != "naive" ]; then
+    SUFFIX="cutoff_${CUTOFF}_${LEAF}"
+fi
+
+echo "Compiling with -O3..."
+gcc -O3 -pthread morton.c ../matrix_operation/*.c -lm -o morton || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+
+PERFORMANCE_FILE="performance/morton_${SUFFIX}.csv"
+echo "Matrix Size,To Morton (seconds),Multiply (seconds),From Morton (seconds),Morton total (seconds),Row-major time (seconds)" > "$PERFORMANCE_FILE"
+
+for power in {6..12}; do
+    size=$((2 ** power))
+    echo "Running test for size ${size}x${size} with cutoff $CUTOFF"
+    ./morton "$size" "$CUTOFF" "$LEAF" >> "$PERFORMANCE_FILE"
+done
+
+echo "✅ All tests completed with cutoff value $CUTOFF."
+read -p "Display a graph of the benchmark data? (Y/n): " response
+if [[ "$response" =~ ^[Yy]$ || "$response" == "" ]]; then
+    echo "Executing the Python script..."
+    python3 plot.py "$PERFORMANCE_FILE" "$CUTOFF"
+else
+    echo "The graph display will not be executed."
+fi
@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+
+/**
+ * Returns the time elapsed since a clock() reading, in seconds
+ * @param start  Value returned by clock() at the start of the phase
+ * @return       Elapsed processor time in seconds
+ */
+static double secondsSince(clock_t start) {
+    return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
+
+/**
+ * Main function
+ * Times each phase of a multiplication through the Morton layout
+ * (conversion of A and B, multiplication, conversion of C) next to the
+ * row-major hybrid engine, and checks that both give the same product
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --verify[=<bound>] also checks the Morton product with Freivalds' algorithm */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 3 || argc > 4) {
+        printf("Usage: %s <matrix_size> <cutoff> [naive|blocked] [--verify[=<bound>]]\n", argv[0]);
+        printf("  cutoff is also the largest tile side of the Morton layout\n");
+        printf("  prints size,to_morton,multiply,from_morton,total,row_major\n");
+        return 1;
+    }
+
+    int side = atoi(argv[1]);
+    int cutoff = atoi(argv[2]);
+    if (argc == 4 && strcmp(argv[3], "blocked") == 0) {
+        setHybridLeaf(LEAF_BLOCKED);
+    }
+
+    struct Matrix A = allocMatrix(side);
+    struct Matrix B = allocMatrix(side);
+    struct Matrix C = allocMatrix(side);
+    struct Matrix D = allocMatrix(side);
+    struct MortonMatrix mA = allocMorton(side, cutoff);
+    struct MortonMatrix mB = allocMorton(side, cutoff);
+    struct MortonMatrix mC = allocMorton(side, cutoff);
+
+    if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL || D.matrix == NULL ||
+        mA.data == NULL || mB.data == NULL || mC.data == NULL) {
+        return 1;
+    }
+
+    fillMatrixRand(&A);
+    fillMatrixRand(&B);
+
+    clock_t t = clock();
+    toMorton(&A, &mA);
+    toMorton(&B, &mB);
+    double toTime = secondsSince(t);
+
+    t = clock();
+    if (strassenMul_morton(&mA, &mB, &mC) == NULL) {
+        return 1;
+    }
+    double mulTime = secondsSince(t);
+
+    t = clock();
+    fromMorton(&mC, &C);
+    double fromTime = secondsSince(t);
+
+    t = clock();
+    if (strassenMul_hybrid(&A, &B, &D, cutoff) == NULL) {
+        return 1;
+    }
+    double rowMajorTime = secondsSince(t);
+
+    if (memcmp(C.matrix, D.matrix, sizeof(int) * (size_t)side * side) != 0) {
+        fprintf(stderr, "Morton and row-major products differ\n");
+        return 1;
+    }
+
+    printf("%d,%f,%f,%f,%f,%f\n", side, toTime, mulTime, fromTime,
+           toTime + mulTime + fromTime, rowMajorTime);
+
+    int status = 0;
+    if (verify > 0 && verifyProductReport(stderr, &A, &B, &C, verify) != 0) {
+        status = 1;
+    }
+
+    freeMorton(&mA);
+    freeMorton(&mB);
+    freeMorton(&mC);
+    freeMatrix(&A);
+    freeMatrix(&B);
+    freeMatrix(&C);
+    freeMatrix(&D);
+    return status;
+}
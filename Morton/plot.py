@@ -0,0 +1,40 @@
+import csv
+import sys
+import matplotlib.pyplot as plt
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'performance/morton_cutoff_64.csv'
+cutoff = sys.argv[2] if len(sys.argv) > 2 else '64'
+
+sizes = []
+conversion = []
+multiply = []
+total = []
+rowMajor = []
+
+with open(path, newline='') as csvfile:
+    reader = csv.DictReader(csvfile)
+    for row in reader:
+        sizes.append(int(row['Matrix Size']))
+        conversion.append(float(row['To Morton (seconds)']) + float(row['From Morton (seconds)']))
+        multiply.append(float(row['Multiply (seconds)']))
+        total.append(float(row['Morton total (seconds)']))
+        rowMajor.append(float(row['Row-major time (seconds)']))
+
+plt.figure(figsize=(10, 6))
+plt.plot(sizes, rowMajor, marker='o', linestyle='-', color='royalblue', label='Row-major Strassen')
+plt.plot(sizes, total, marker='s', linestyle='-', color='darkorange', label='Morton, conversions included')
+plt.plot(sizes, multiply, marker='^', linestyle='--', color='seagreen', label='Morton multiply only')
+plt.plot(sizes, conversion, marker='x', linestyle=':', color='firebrick', label='Conversions only')
+
+plt.title(f'Morton layout: conversion cost vs multiplication savings (cutoff {cutoff})')
+plt.xlabel('Matrix Size (N x N)')
+plt.ylabel('Time (seconds)')
+plt.grid(True)
+plt.xscale('log', base=2)
+plt.yscale('log')
+plt.xticks(sizes, labels=[str(size) for size in sizes], rotation=45)
+plt.legend()
+plt.tight_layout()
+
+plt.savefig("morton_performance.png")
+plt.show()
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Main function
+ * Multiplies matrix files out of core within a memory budget and prints
+ * the time, the peak resident set and the I/O volume of the run
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    struct MatrixFileArgs files;
+    if (parseMatrixFileArgs(&argc, argv, &files) != 0) {
+        return 1;
+    }
+    /* --verify[=<bound>] checks C with Freivalds' algorithm, streaming the files once per batch of rounds */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 4 || argc > 8) {
+        printf("Usage: %s <matrix_size|MxKxN> <cutoff|auto> <budget_MB> [naive|blocked] [check] [scratch=<dir>]\n",
+               argv[0]);
+        printf("  --in A.bin B.bin and --out C.bin read the operands from and write C to matrix files\n");
+        printf("  without --in the operands are all ones; check compares with strassenMul_hybrid in RAM\n");
+        printf("  --verify[=<bound>] checks C with Freivalds' algorithm within the budget, bound 1e-9 by default\n");
+        return 1;
+    }
+
+    int m, k, n;
+    if (sscanf(argv[1], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = atoi(argv[1]);
+    }
+    int cutoff = strcmp(argv[2], "auto") == 0 ? CUTOFF_AUTO : atoi(argv[2]);
+    size_t budget = (size_t)(atof(argv[3]) * 1024 * 1024);
+    int check = 0;
+    const char* scratchDir = NULL;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            setHybridLeaf(LEAF_BLOCKED);
+        } else if (strcmp(argv[i], "check") == 0) {
+            check = 1;
+        } else if (strncmp(argv[i], "scratch=", 8) == 0) {
+            scratchDir = argv[i] + 8;
+        }
+    }
+
+    struct MappedMatrix mA, mB, mC;
+    if (openMatrixOperands(&files, m, k, n, &mA, &mB, &mC) != 0) {
+        return 1;
+    }
+    if (files.inA == NULL) {
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < k; j++) {
+                matrixElem(mA.mat.matrix, i, j, mA.mat.ld) = 1;
+            }
+        }
+        for (int i = 0; i < k; i++) {
+            for (int j = 0; j < n; j++) {
+                matrixElem(mB.mat.matrix, i, j, mB.mat.ld) = 1;
+            }
+        }
+    }
+
+    struct OutOfCoreReport report;
+    double start = nowSeconds();
+    if (strassenMul_outOfCore(&mA, &mB, &mC, cutoff, budget, scratchDir, &report) == NULL) {
+        fprintf(stderr, "Cannot allocate the scratch file or the in-memory buffer\n");
+        return 1;
+    }
+    double timeTaken = nowSeconds() - start;
+
+    int status = 0;
+    if (check) {
+        struct Matrix R = allocMatrixRect(m, n);
+        if (R.matrix == NULL) return 1;
+        strassenMul_hybrid(&mA.mat, &mB.mat, &R, cutoff);
+        for (int i = 0; i < m && status == 0; i++) {
+            status = memcmp(&matrixElem(R.matrix, i, 0, R.ld), &matrixElem(mC.mat.matrix, i, 0, mC.mat.ld),
+                            sizeof(int) * n) != 0;
+        }
+        if (status != 0) fprintf(stderr, "Out-of-core and in-memory results differ\n");
+        freeMatrix(&R);
+    }
+    if (verify > 0 && verifyProductReport(stderr, &mA.mat, &mB.mat, &mC.mat, verify) != 0) {
+        status = 1;
+    }
+
+    printf("size,time\n%s,%f\n", argv[1], timeTaken);
+    printOutOfCoreReport(stdout, &report);
+
+    unmapMatrixFile(&mA);
+    unmapMatrixFile(&mB);
+    unmapMatrixFile(&mC);
+    return status;
+}
@@ -0,0 +1,50 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Check if cutoff and depth parameters were provided
+if [ $# -ne 2 ] && [ $# -ne 3 ]; then
+    echo "Usage: $0 <cutoff_value> <depth> [naive|blocked]"
+    echo "  cutoff_value: Size threshold below which standard multiplication is used"
+    echo "  depth:        Number of recursion levels whose products run in parallel"
+    echo "  leaf:         Kernel used below the cutoff (default: blocked)"
+    exit 1
+fi
+
+CUTOFF=$1
+DEPTH=$2
+LEAF=${3:-blocked}
+echo "Using Strassen cutoff value: $CUTOFF, parallel depth: $DEPTH ($LEAF leaf)"
+
+echo "Compiling with -O3..."
+gcc -O3 -pthread parallel_strassen.c ../matrix_operation/*.c -lm -o parallel || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+
+PERFORMANCE_FILE="performance/speedup_cutoff_${CUTOFF}_depth_${DEPTH}.csv"
+echo "Matrix Size,Threads,Time (seconds),Speedup" > "$PERFORMANCE_FILE"
+
+for power in {10..13}; do
+    size=$((2 ** power))
+    base=""
+    for threads in 1 2 4 8 16; do
+        echo "Running test for size ${size}x${size} with $threads threads"
+        output=$(./parallel "$size" "$CUTOFF" "$threads" "$DEPTH" "$LEAF")
+        time=${output##*,}
+        if [ -z "$base" ]; then
+            base=$time
+        fi
+        speedup=$(awk -v b="$base" -v t="$time" 'BEGIN { printf "%.2f", (t > 0) ? b / t : 0 }')
+        echo "$output,$speedup" >> "$PERFORMANCE_FILE"
+        echo "  ${time}s (speedup ${speedup}x)"
+    done
+    echo
+done
+
+echo "✅ All tests completed, results saved to $PERFORMANCE_FILE."
+read -p "Display a graph of the benchmark data? (Y/n): " response
+if [[ "$response" =~ ^[Yy]$ || "$response" == "" ]]; then
+    echo "Executing the Python script..."
+    python3 plot.py "$PERFORMANCE_FILE"
+else
+    echo "The graph display will not be executed."
+fi
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
+#include "../matrix_operation/workstealing.h"
+
+/**
+ * Main function
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --in A.bin B.bin / --out C.bin replace the all-ones inputs and the heap result */
+    struct MatrixFileArgs files;
+    if (parseMatrixFileArgs(&argc, argv, &files) != 0) {
+        return 1;
+    }
+    /* --verify[=<bound>] checks C with Freivalds' algorithm after the timed product */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 5 || argc > 8) {
+        printf("Usage: %s <matrix_size> <cutoff> <threads> <depth> [naive|blocked] [stats] [--pad]\n", argv[0]);
+        printf("  --in A.bin B.bin and --out C.bin read the operands from and write C to matrix files\n");
+        printf("  --verify[=<bound>] checks C with Freivalds' algorithm, false-positive bound 1e-9 by default\n");
+        return 1;
+    }
+
+    int originalSide = atoi(argv[1]);
+    int cutoff = atoi(argv[2]);
+    int threads = atoi(argv[3]);
+    int depth = atoi(argv[4]);
+    int printStats = 0;
+    int pad = 0;
+    for (int i = 5; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            setHybridLeaf(LEAF_BLOCKED);
+        } else if (strcmp(argv[i], "stats") == 0) {
+            printStats = 1;
+        } else if (strcmp(argv[i], "--pad") == 0) {
+            pad = 1;
+        }
+    }
+    /* Odd sides are peeled by the library; --pad restores power-of-two padding */
+    int paddedSide = pad ? nextPowerOfTwo(originalSide) : originalSide;
+    if (pad && files.inA != NULL) {
+        fprintf(stderr, "--pad cannot be used with --in\n");
+        return 1;
+    }
+
+    struct MappedMatrix mA, mB, mC;
+    if (openMatrixOperands(&files, paddedSide, paddedSide, paddedSide, &mA, &mB, &mC) != 0) {
+        // fprintf(stderr, "Memory allocation failed for size %d\n", originalSide);
+        return 1;
+    }
+    struct Matrix A = mA.mat;
+    struct Matrix B = mB.mat;
+    struct Matrix C = mC.mat;
+
+    if (files.inA == NULL) {
+        for (int i = 0; i < paddedSide; i++) {
+            for (int j = 0; j < paddedSide; j++) {
+                if (i < originalSide && j < originalSide) {
+                    matrixElem(A.matrix, i, j, paddedSide) = 1;
+                    matrixElem(B.matrix, i, j, paddedSide) = 1;
+                } else {
+                    matrixElem(A.matrix, i, j, paddedSide) = 0;
+                    matrixElem(B.matrix, i, j, paddedSide) = 0;
+                }
+            }
+        }
+    }
+
+    /* Start the workers before timing, the hybrid engine spawns on them */
+    struct TaskRuntime* rt = runtimeCreate(threads);
+    if (rt == NULL) {
+        return 1;
+    }
+    setHybridRuntime(rt, depth);
+
+    /* Wall-clock time: clock() would add up the CPU time of every thread */
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    strassenMul_hybrid(&A, &B, &C, cutoff);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double timeTaken = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%d,%d,%f\n", originalSide, threads, timeTaken);
+    if (printStats) {
+        runtimePrintStats(rt, stderr);
+    }
+
+    setHybridRuntime(NULL, 0);
+    runtimeDestroy(rt);
+
+    int status = 0;
+    if (verify > 0 && verifyProductReport(stderr, &A, &B, &C, verify) != 0) {
+        status = 1;
+    }
+
+    unmapMatrixFile(&mA);
+    unmapMatrixFile(&mB);
+    unmapMatrixFile(&mC);
+    return status;
+}
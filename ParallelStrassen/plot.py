@@ -0,0 +1,34 @@
+import csv
+import sys
+import matplotlib.pyplot as plt
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'performance/speedup_cutoff_64_depth_2.csv'
+
+speedups = {}
+
+with open(path, newline='') as csvfile:
+    reader = csv.DictReader(csvfile)
+    for row in reader:
+        size = int(row['Matrix Size'])
+        speedups.setdefault(size, ([], []))
+        speedups[size][0].append(int(row['Threads']))
+        speedups[size][1].append(float(row['Speedup']))
+
+plt.figure(figsize=(10, 6))
+for size, (threads, values) in sorted(speedups.items()):
+    plt.plot(threads, values, marker='o', linestyle='-', label=f'{size} x {size}')
+
+all_threads = sorted({t for threads, _ in speedups.values() for t in threads})
+plt.plot(all_threads, all_threads, linestyle='--', color='gray', label='Linear')
+
+plt.title('Parallel Strassen Speedup')
+plt.xlabel('Threads')
+plt.ylabel('Speedup (wall clock)')
+plt.grid(True)
+plt.xscale('log', base=2)
+plt.xticks(all_threads, labels=[str(t) for t in all_threads])
+plt.legend()
+plt.tight_layout()
+
+plt.savefig("parallel_speedup.png")
+plt.show()
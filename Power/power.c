@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Checks that P is the adjacency matrix of f^k, f given by next[]
+ * @param P      Matrix to check
+ * @param next   Successor of every vertex
+ * @param k      Exponent
+ * @return       1 if P is correct, 0 otherwise
+ */
+static int checkPower(struct Matrix* P, const int* next, int k) {
+    for (int i = 0; i < P->row; i++) {
+        int j = i;
+        for (int step = 0; step < k; step++) {
+            j = next[j];
+        }
+        for (int c = 0; c < P->col; c++) {
+            if (matrixElem(P->matrix, i, c, P->ld) != (c == j)) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Main function
+ * A is the adjacency matrix of a random mapping (one edge out of every
+ * vertex), so every power of A is again a 0/1 matrix and the result is
+ * checked exactly. Times A^k computed with k-1 products, with
+ * matrixPower, and one square with strassenMul_hybrid and strassenSquare
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --verify[=<bound>] also checks the dense square with Freivalds' algorithm */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 4 || argc > 5) {
+        printf("Usage: %s <matrix_size> <exponent> <cutoff> [naive|blocked] [--verify[=<bound>]]\n", argv[0]);
+        printf("  prints size,exponent,repeated_time,power_time,mul_square_time,square_time\n");
+        return 1;
+    }
+
+    int side = atoi(argv[1]);
+    int k = atoi(argv[2]);
+    int cutoff = atoi(argv[3]);
+    if (argc == 5 && strcmp(argv[4], "blocked") == 0) {
+        setHybridLeaf(LEAF_BLOCKED);
+    }
+    if (side < 1 || k < 1) return 1;
+
+    struct Matrix A = allocMatrix(side);
+    struct Matrix R = allocMatrix(side);
+    struct Matrix T = allocMatrix(side);
+    struct Matrix P = allocMatrix(side);
+    int* next = malloc(sizeof(int) * side);
+    if (A.matrix == NULL || R.matrix == NULL || T.matrix == NULL || P.matrix == NULL || next == NULL) {
+        return 1;
+    }
+
+    srand(42);
+    initMatrixZeros(&A);
+    for (int i = 0; i < side; i++) {
+        next[i] = rand() % side;
+        matrixElem(A.matrix, i, next[i], A.ld) = 1;
+    }
+
+    /* A^k with k - 1 products */
+    double start = nowSeconds();
+    copySubmatrixRect(&A, 0, 0, &R, 0, 0, side, side);
+    for (int step = 1; step < k; step++) {
+        strassenMul_hybrid(&R, &A, &T, cutoff);
+        struct Matrix swap = R; R = T; T = swap;
+    }
+    double repeatedTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    if (matrixPower(&A, k, &P, cutoff) == NULL) return 1;
+    double powerTime = nowSeconds() - start;
+
+    if (!checkPower(&R, next, k) || !checkPower(&P, next, k)) {
+        fprintf(stderr, "Wrong result for A^%d\n", k);
+        return 1;
+    }
+
+    /* One square of a dense matrix, general product against the squaring path */
+    fillMatrixRand(&A);
+    start = nowSeconds();
+    strassenMul_hybrid(&A, &A, &R, cutoff);
+    double mulSquareTime = nowSeconds() - start;
+
+    start = nowSeconds();
+    strassenSquare(&A, &P, cutoff);
+    double squareTime = nowSeconds() - start;
+
+    for (int i = 0; i < side; i++) {
+        if (memcmp(&matrixElem(R.matrix, i, 0, R.ld), &matrixElem(P.matrix, i, 0, P.ld),
+                   sizeof(int) * side) != 0) {
+            fprintf(stderr, "Squaring path differs from strassenMul_hybrid\n");
+            return 1;
+        }
+    }
+
+    printf("%d,%d,%f,%f,%f,%f\n", side, k, repeatedTime, powerTime, mulSquareTime, squareTime);
+
+    int status = 0;
+    if (verify > 0 && verifyProductReport(stderr, &A, &A, &P, verify) != 0) {
+        status = 1;
+    }
+
+    freeMatrix(&A);
+    freeMatrix(&R);
+    freeMatrix(&T);
+    freeMatrix(&P);
+    free(next);
+    return status;
+}
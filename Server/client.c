@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/server.h"
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Compares two doubles for qsort
+ * @param a      First value
+ * @param b      Second value
+ * @return       -1, 0 or 1
+ */
+static int compareSeconds(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Main function
+ * Sends the same product to the server several times on one memfd,
+ * checks the first result, and prints the round-trip percentiles seen
+ * by the client and the service-time percentiles of the server. With
+ * --verify every result is also checked with Freivalds' algorithm, outside
+ * the timed round trip
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc < 4 || argc > 7) {
+        printf("Usage: %s <socket_path> <matrix_size|MxKxN> <cutoff|auto> [jobs] [naive|blocked] [shutdown]\n",
+               argv[0]);
+        printf("  --verify[=<bound>] checks every result with Freivalds' algorithm, bound 1e-9 by default\n");
+        return 1;
+    }
+
+    int m, k, n;
+    if (sscanf(argv[2], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = atoi(argv[2]);
+    }
+    int cutoff = strcmp(argv[3], "auto") == 0 ? CUTOFF_AUTO : atoi(argv[3]);
+    int jobs = 100;
+    enum LeafKernel leaf = LEAF_NAIVE;
+    int shutdown = 0;
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "blocked") == 0) {
+            leaf = LEAF_BLOCKED;
+        } else if (strcmp(argv[i], "shutdown") == 0) {
+            shutdown = 1;
+        } else if (strcmp(argv[i], "naive") != 0) {
+            jobs = atoi(argv[i]);
+        }
+    }
+    if (jobs < 1) jobs = 1;
+
+    int sock = serverConnect(argv[1]);
+    if (sock < 0) {
+        fprintf(stderr, "Cannot connect to %s\n", argv[1]);
+        return 1;
+    }
+    struct SharedOperands ops;
+    double* roundTrip = malloc(jobs * sizeof(double));
+    if (roundTrip == NULL || sharedOperandsCreate(&ops, m, k, n) != 0) {
+        fprintf(stderr, "Cannot create the shared operands\n");
+        return 1;
+    }
+    srand(42);
+    fillMatrixRand(&ops.A);
+    fillMatrixRand(&ops.B);
+    serverCommand(sock, SERVER_OP_RESET_STATS);
+
+    struct ServerReply reply;
+    int status = 0;
+    int verified = 0;
+    unsigned long long seed = (unsigned long long)time(NULL);
+    for (int j = 0; j < jobs && status == 0; j++) {
+        double start = nowSeconds();
+        status = serverMultiply(sock, &ops, cutoff, leaf, &reply);
+        roundTrip[j] = nowSeconds() - start;
+
+        /* The result is read in place from the shared mapping */
+        if (j == 0 && status == 0) {
+            struct Matrix R = allocMatrixRect(m, n);
+            setHybridLeaf(leaf);
+            if (R.matrix == NULL || strassenMul_hybrid(&ops.A, &ops.B, &R, cutoff) == NULL) return 1;
+            for (int i = 0; i < m && status == 0; i++) {
+                status = memcmp(&matrixElem(R.matrix, i, 0, R.ld), &matrixElem(ops.C.matrix, i, 0, ops.C.ld),
+                                sizeof(int) * n) != 0;
+            }
+            if (status != 0) fprintf(stderr, "Server and local results differ\n");
+            freeMatrix(&R);
+        }
+        if (verify > 0 && status == 0) {
+            status = verifyProduct(&ops.A, &ops.B, &ops.C, verify, seed + j) != 1;
+            if (status != 0) fprintf(stderr, "verify: result of job %d FAILED\n", j);
+            verified++;
+        }
+    }
+    if (status != 0) {
+        fprintf(stderr, "Job failed\n");
+        return 1;
+    }
+
+    struct ServerStats stats;
+    if (serverQueryStats(sock, &stats) != 0) return 1;
+    qsort(roundTrip, jobs, sizeof(double), compareSeconds);
+
+    printf("size,jobs,client_p50,client_p90,client_p99,server_mean,server_p50,server_p90,server_p99,server_max,"
+           "mapping_hits,mapping_misses,workspace_bytes\n");
+    printf("%s,%d,%f,%f,%f,%f,%f,%f,%f,%f,%llu,%llu,%llu\n", argv[2], jobs,
+           roundTrip[(jobs * 50 + 99) / 100 - 1], roundTrip[(jobs * 90 + 99) / 100 - 1],
+           roundTrip[(jobs * 99 + 99) / 100 - 1], stats.meanSeconds, stats.p50Seconds, stats.p90Seconds,
+           stats.p99Seconds, stats.maxSeconds, (unsigned long long)stats.mappingHits,
+           (unsigned long long)stats.mappingMisses, (unsigned long long)stats.workspaceBytes);
+
+    if (verify > 0) {
+        fprintf(stderr, "verify: %d results passed, %d rounds each, false-positive bound %g\n",
+                verified, freivaldsRounds(verify), verify);
+    }
+
+    if (shutdown) serverCommand(sock, SERVER_OP_SHUTDOWN);
+    sharedOperandsFree(&ops);
+    free(roundTrip);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../matrix_operation/matrix.h"
+#include "../matrix_operation/server.h"
+
+/**
+ * Main function
+ * Serves multiplications on a Unix domain socket until a client sends
+ * SERVER_OP_SHUTDOWN
+ *
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        printf("Usage: %s <socket_path> [threads] [depth]\n", argv[0]);
+        printf("  threads > 1 keeps a work-stealing runtime whose tasks are the products of the top depth levels\n");
+        return 1;
+    }
+
+    int threads = argc > 2 ? atoi(argv[2]) : 1;
+    int depth = argc > 3 ? atoi(argv[3]) : 1;
+    if (serverRun(argv[1], threads, depth) != 0) {
+        fprintf(stderr, "Cannot serve on %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Client of the multiplication daemon (Server/server.c), standard library only.
+
+The messages mirror struct ServerRequest, ServerReply and ServerStats in
+matrix_operation/server.h. Operands live in a sealed memfd that is passed
+with every request, and the server writes C in place.
+"""
+import fcntl
+import mmap
+import os
+import socket
+import struct
+import sys
+
+OP_MUL = 1
+OP_STATS = 2
+OP_RESET_STATS = 3
+OP_SHUTDOWN = 4
+
+LEAF_NAIVE = 0
+LEAF_BLOCKED = 1
+
+REQUEST = struct.Struct("<I5i3Q")   # op, m, k, n, cutoff, leaf, offsetA, offsetB, offsetC
+REPLY = struct.Struct("<2i2d")      # status, mappingReused, computeSeconds, serviceSeconds
+STATS = struct.Struct("<4Q5d")      # jobs, hits, misses, workspace, mean, p50, p90, p99, max
+
+
+class SharedOperands:
+    """A, B and C (int32, row-major) in one memfd, each at a page-aligned offset"""
+
+    def __init__(self, m, k, n):
+        page = mmap.PAGESIZE
+        self.m, self.k, self.n = m, k, n
+        sizes = [(rows * cols * 4 + page - 1) // page * page for rows, cols in ((m, k), (k, n), (m, n))]
+        self.offsets = (0, sizes[0], sizes[0] + sizes[1])
+        self.length = max(sum(sizes), page)
+        self.fd = os.memfd_create("strassen-operands", os.MFD_CLOEXEC | os.MFD_ALLOW_SEALING)
+        os.ftruncate(self.fd, self.length)
+        fcntl.fcntl(self.fd, fcntl.F_ADD_SEALS, fcntl.F_SEAL_SHRINK | fcntl.F_SEAL_GROW)
+        self.map = mmap.mmap(self.fd, self.length)
+
+    def fill(self, a_value, b_value):
+        """Sets every element of A to a_value and of B to b_value"""
+        self.map[0:self.m * self.k * 4] = struct.pack("<i", a_value) * (self.m * self.k)
+        start = self.offsets[1]
+        self.map[start:start + self.k * self.n * 4] = struct.pack("<i", b_value) * (self.k * self.n)
+
+    def result(self):
+        """Returns C as a memoryview of int32 elements, row after row"""
+        start = self.offsets[2]
+        return memoryview(self.map)[start:start + self.m * self.n * 4].cast("i")
+
+    def close(self):
+        self.map.close()
+        os.close(self.fd)
+
+
+class StrassenClient:
+    """One connection to the daemon"""
+
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+        self.sock.connect(path)
+
+    def multiply(self, ops, cutoff, leaf=LEAF_NAIVE):
+        """Computes C = A * B in ops; returns (compute_seconds, service_seconds, mapping_reused)"""
+        request = REQUEST.pack(OP_MUL, ops.m, ops.k, ops.n, cutoff, leaf, *ops.offsets)
+        socket.send_fds(self.sock, [request], [ops.fd])
+        status, reused, compute, service = REPLY.unpack(self.sock.recv(REPLY.size))
+        if status != 0:
+            raise RuntimeError("the server rejected the job")
+        return compute, service, bool(reused)
+
+    def stats(self):
+        """Returns the counters and service-time percentiles of the server"""
+        self.sock.send(REQUEST.pack(OP_STATS, 0, 0, 0, 0, 0, 0, 0, 0))
+        values = STATS.unpack(self.sock.recv(STATS.size))
+        names = ("jobs", "mapping_hits", "mapping_misses", "workspace_bytes",
+                 "mean", "p50", "p90", "p99", "max")
+        return dict(zip(names, values))
+
+    def command(self, op):
+        """Sends OP_RESET_STATS or OP_SHUTDOWN"""
+        self.sock.send(REQUEST.pack(op, 0, 0, 0, 0, 0, 0, 0, 0))
+        return REPLY.unpack(self.sock.recv(REPLY.size))[0] == 0
+
+    def close(self):
+        self.sock.close()
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        print(f"Usage: {sys.argv[0]} <socket_path> <matrix_size> <cutoff>")
+        sys.exit(1)
+    size, cutoff = int(sys.argv[2]), int(sys.argv[3])
+    client = StrassenClient(sys.argv[1])
+    ops = SharedOperands(size, size, size)
+    ops.fill(1, 1)
+    compute, service, reused = client.multiply(ops, cutoff)
+    correct = all(value == size for value in ops.result())
+    print(f"{size},{compute:f},{service:f},{int(reused)},{'ok' if correct else 'wrong'}")
+    ops.close()
+    client.close()
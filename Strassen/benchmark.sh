@@ -2,21 +2,24 @@
 set -e  # Exit immediately if any command fails
 
 echo "Compiling with -pg and -O3..."
-gcc -pg -O3 strassen.c -lm ../matrix_operation/matrix.c -o strassen || { echo "Compilation failed."; exit 1; }
+gcc -pg -O3 -pthread strassen.c ../matrix_operation/*.c -lm -o strassen || { echo "Compilation failed."; exit 1; }
 
 mkdir -p performance
 mkdir -p analysis
 
-echo "Matrix Size,Time (seconds)" > performance/performance.csv
+# The last column times the same run with the scalar helper kernels (MATRIX_SIMD=scalar)
+echo "Matrix Size,Time (seconds),Scalar time (seconds)" > performance/performance.csv
 
 for power in {2..12}; do
     size=$((2 ** power))
     echo "Running test for size ${size}x${size}..."
 
+    # Scalar run first, so that gmon.out profiles the dispatched kernels
+    scalar=$(MATRIX_SIMD=scalar ./strassen "$size")
     rm -f gmon.out
 
     output=$(./strassen "$size")
-    echo "$output" >> performance/performance.csv
+    echo "$output,${scalar#*,}" >> performance/performance.csv
 
     if [[ -f gmon.out ]]; then
         gprof strassen gmon.out > "analysis/analysis_${size}.txt"
@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 #include "../matrix_operation/matrix.h"
+#include "../matrix_operation/matrixfile.h"
 
 /**
  * Main function
@@ -11,13 +13,29 @@
  * @return      0 on success, 1 on failure
  */
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        // printf("Usage: %s <matrix_size>\n", argv[0]);
+    /* --in A.bin B.bin / --out C.bin replace the all-ones inputs and the heap result */
+    struct MatrixFileArgs files;
+    if (parseMatrixFileArgs(&argc, argv, &files) != 0) {
+        return 1;
+    }
+    /* --verify[=<bound>] checks C with Freivalds' algorithm after the timed product */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc != 2 && argc != 3) {
+        // printf("Usage: %s <matrix_size> [--pad] [--in A.bin B.bin] [--out C.bin]\n", argv[0]);
         return 1;
     }
 
     int originalSide = atoi(argv[1]);
-    int paddedSide = nextPowerOfTwo(originalSide);
+    /* Odd sides are peeled by the library; --pad restores power-of-two padding */
+    int pad = (argc == 3 && strcmp(argv[2], "--pad") == 0);
+    int paddedSide = pad ? nextPowerOfTwo(originalSide) : originalSide;
+    if (pad && files.inA != NULL) {
+        fprintf(stderr, "--pad cannot be used with --in\n");
+        return 1;
+    }
 
     /*
     printf("Testing with matrix size %d x %d...\n", originalSide, originalSide);
@@ -25,23 +43,25 @@ int main(int argc, char* argv[]) {
     printf("Padded matrix size: %d x %d\n", paddedSide, paddedSide);
     */
 
-    struct Matrix A = allocMatrix(paddedSide);
-    struct Matrix B = allocMatrix(paddedSide);
-    struct Matrix C = allocMatrix(paddedSide);
-
-    if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL) {
+    struct MappedMatrix mA, mB, mC;
+    if (openMatrixOperands(&files, paddedSide, paddedSide, paddedSide, &mA, &mB, &mC) != 0) {
         // fprintf(stderr, "Memory allocation failed for size %d\n", originalSide);
         return 1;
     }
+    struct Matrix A = mA.mat;
+    struct Matrix B = mB.mat;
+    struct Matrix C = mC.mat;
 
-    for (int i = 0; i < paddedSide; i++) {
-        for (int j = 0; j < paddedSide; j++) {
-            if (i < originalSide && j < originalSide) {
-                matrixElem(A.matrix, i, j, paddedSide) = 1;
-                matrixElem(B.matrix, i, j, paddedSide) = 1;
-            } else {
-                matrixElem(A.matrix, i, j, paddedSide) = 0;
-                matrixElem(B.matrix, i, j, paddedSide) = 0;
+    if (files.inA == NULL) {
+        for (int i = 0; i < paddedSide; i++) {
+            for (int j = 0; j < paddedSide; j++) {
+                if (i < originalSide && j < originalSide) {
+                    matrixElem(A.matrix, i, j, paddedSide) = 1;
+                    matrixElem(B.matrix, i, j, paddedSide) = 1;
+                } else {
+                    matrixElem(A.matrix, i, j, paddedSide) = 0;
+                    matrixElem(B.matrix, i, j, paddedSide) = 0;
+                }
             }
         }
     }
@@ -72,9 +92,14 @@ int main(int argc, char* argv[]) {
 
     printf("%d,%f\n", originalSide, timeTaken);
 
-    freeMatrix(&A);
-    freeMatrix(&B);
-    freeMatrix(&C);
+    int status = 0;
+    if (verify > 0 && verifyProductReport(stderr, &A, &B, &C, verify) != 0) {
+        status = 1;
+    }
+
+    unmapMatrixFile(&mA);
+    unmapMatrixFile(&mB);
+    unmapMatrixFile(&mC);
 
-    return 0;
+    return status;
 }
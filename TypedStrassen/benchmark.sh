@@ -0,0 +1,38 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Times the hybrid engine for every element type and reports the
+# effective rate (2n^3 operations per product, GFLOP/s for float and
+# double, GOP/s for the integer types)
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 <cutoff_value>"
+    exit 1
+fi
+
+CUTOFF=$1
+TYPES="int32 int64 float double"
+
+echo "Compiling with -O3 -march=native..."
+gcc -O3 -march=native -pthread typed_strassen.c ../matrix_operation/*.c -lm -o typed || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+
+PERFORMANCE_FILE="performance/types_cutoff_${CUTOFF}.csv"
+echo "Matrix Size,Type,Time (seconds),GOP/s" > "$PERFORMANCE_FILE"
+
+for power in {6..12}; do
+    size=$((2 ** power))
+    for type in $TYPES; do
+        echo "Running test for size ${size}x${size} ($type) with cutoff $CUTOFF"
+        ./typed "$size" "$CUTOFF" "$type" >> "$PERFORMANCE_FILE"
+    done
+done
+
+echo "✅ Results saved to $PERFORMANCE_FILE"
+read -p "Display a graph of the benchmark data? (Y/n): " response
+if [[ "$response" =~ ^[Yy]$ || "$response" == "" ]]; then
+    echo "Executing the Python script..."
+    python3 plot.py "$PERFORMANCE_FILE" "$CUTOFF"
+else
+    echo "The graph display will not be executed."
+fi
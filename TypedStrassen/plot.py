@@ -0,0 +1,32 @@
+import csv
+import sys
+import matplotlib.pyplot as plt
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'performance/types_cutoff_64.csv'
+cutoff = sys.argv[2] if len(sys.argv) > 2 else '64'
+
+rates = {}
+
+with open(path, newline='') as csvfile:
+    reader = csv.DictReader(csvfile)
+    for row in reader:
+        rates.setdefault(row['Type'], ([], []))
+        rates[row['Type']][0].append(int(row['Matrix Size']))
+        rates[row['Type']][1].append(float(row['GOP/s']))
+
+plt.figure(figsize=(10, 6))
+for element_type, (sizes, values) in rates.items():
+    plt.plot(sizes, values, marker='o', linestyle='-', label=element_type)
+
+all_sizes = sorted({s for sizes, _ in rates.values() for s in sizes})
+plt.title(f'Hybrid Strassen Rate per Element Type (cutoff {cutoff})')
+plt.xlabel('Matrix Size (N x N)')
+plt.ylabel('GOP/s (2N^3 / time)')
+plt.grid(True)
+plt.xscale('log', base=2)
+plt.xticks(all_sizes, labels=[str(s) for s in all_sizes], rotation=45)
+plt.legend()
+plt.tight_layout()
+
+plt.savefig("types_performance.png")
+plt.show()
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../matrix_operation/matrix_generic.h"
+
+/**
+ * Times one hybrid product for any matrix family
+ * Allocates A (m x k), B (k x n) and C (m x n), fills A and B with random
+ * values, runs matStrassenMulHybrid and stores the CPU time in `seconds`
+ * (a negative time when an allocation fails). With a false-positive bound
+ * `verify` > 0, C is then checked with matVerifyProduct and `verified`
+ * receives its result (1 when verify is 0)
+ */
+#define TIME_PRODUCT(Type, alloc, m, k, n, cutoff, verify, seconds, verified) \
+    do {                                                                      \
+        struct Type A = alloc(m, k);                                          \
+        struct Type B = alloc(k, n);                                          \
+        struct Type C = alloc(m, n);                                          \
+        seconds = -1;                                                         \
+        if (A.matrix != NULL && B.matrix != NULL && C.matrix != NULL) {       \
+            matFillRand(&A);                                                  \
+            matFillRand(&B);                                                  \
+            clock_t t = clock();                                              \
+            if (matStrassenMulHybrid(&A, &B, &C, cutoff) != NULL) {           \
+                seconds = ((double)(clock() - t)) / CLOCKS_PER_SEC;           \
+            }                                                                 \
+            verified = 1;                                                     \
+            if (verify > 0) {                                                 \
+                verified = matVerifyProduct(&A, &B, &C, verify, time(NULL));  \
+            }                                                                 \
+        }                                                                     \
+        matFree(&A);                                                          \
+        matFree(&B);                                                          \
+        matFree(&C);                                                          \
+    } while (0)
+
+/**
+ * Main function
+ * @param argc  Number of command line arguments
+ * @param argv  Array of command line arguments
+ * @return      0 on success, 1 on failure
+ */
+int main(int argc, char* argv[]) {
+    /* --verify[=<bound>] checks C with Freivalds' algorithm after the timed product */
+    double verify;
+    if (parseVerifyArg(&argc, argv, &verify) != 0) {
+        return 1;
+    }
+    if (argc != 4) {
+        printf("Usage: %s <matrix_size|MxKxN> <cutoff> <int32|int64|float|double> [--verify[=<bound>]]\n", argv[0]);
+        return 1;
+    }
+
+    int m, k, n;
+    if (sscanf(argv[1], "%dx%dx%d", &m, &k, &n) != 3) {
+        m = k = n = atoi(argv[1]);
+    }
+    int cutoff = atoi(argv[2]);
+    const char* type = argv[3];
+    double timeTaken;
+    int verified = 1;
+
+    if (strcmp(type, "int32") == 0) {
+        setHybridLeaf(LEAF_BLOCKED);   /* Packed kernel: the vectorized leaf of the int32 family */
+        TIME_PRODUCT(Matrix, allocMatrixRect, m, k, n, cutoff, verify, timeTaken, verified);
+    } else if (strcmp(type, "int64") == 0) {
+        TIME_PRODUCT(MatrixI64, allocMatrixRect_i64, m, k, n, cutoff, verify, timeTaken, verified);
+    } else if (strcmp(type, "float") == 0) {
+        TIME_PRODUCT(MatrixF32, allocMatrixRect_f32, m, k, n, cutoff, verify, timeTaken, verified);
+    } else if (strcmp(type, "double") == 0) {
+        TIME_PRODUCT(MatrixF64, allocMatrixRect_f64, m, k, n, cutoff, verify, timeTaken, verified);
+    } else {
+        printf("Unknown element type %s\n", type);
+        return 1;
+    }
+
+    if (timeTaken < 0) {
+        return 1;
+    }
+
+    /* Rate of the conventional algorithm (2mkn operations), comparable across engines */
+    double gops = timeTaken > 0 ? 2.0 * m * k * n / timeTaken / 1e9 : 0;
+    printf("%s,%s,%f,%f\n", argv[1], type, timeTaken, gops);
+    if (verify > 0) {
+        fprintf(stderr, "verify: %s, %d rounds, false-positive bound %g\n",
+                verified == 1 ? "passed" : (verified == 0 ? "FAILED" : "not checked"),
+                freivaldsRounds(verify), verify);
+    }
+    return verified == 1 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#!/bin/bash
+set -e  # Exit immediately if any command fails
+
+# Compares Strassen-Winograd (15 additions per level) with the hybrid
+# Strassen engine (18 additions per level) size by size, same cutoff and leaf
+if [ $# -ne 1 ] && [ $# -ne 2 ]; then
+    echo "Usage: $0 <cutoff_value> [naive|blocked]"
+    echo "  cutoff_value: Size threshold below which standard multiplication is used"
+    echo "  leaf:         Kernel used below the cutoff (default: naive)"
+    exit 1
+fi
+
+CUTOFF=$1
+LEAF=${2:-naive}
+echo "Using cutoff value: $CUTOFF ($LEAF leaf)"
+
+SUFFIX="cutoff_${CUTOFF}"
+if [ "$LEAF" != "naive" ]; then
+    SUFFIX="cutoff_${CUTOFF}_${LEAF}"
+fi
+
+echo "Compiling with -pg and -O3..."
+gcc -pg -O3 -pthread winograd.c ../matrix_operation/*.c -lm -o winograd || { echo "Compilation failed."; exit 1; }
+gcc -O3 -pthread ../HybridStrassen/hybrid_strassen.c ../matrix_operation/*.c -lm -o hybrid || { echo "Compilation failed."; exit 1; }
+
+mkdir -p performance
+mkdir -p analysis
+
+PERFORMANCE_FILE="performance/comparison_${SUFFIX}.csv"
+echo "Matrix Size,Winograd time (seconds),Strassen time (seconds),Speedup" > "$PERFORMANCE_FILE"
+
+for power in {2..12}; do
+    size=$((2 ** power))
+    echo "Running test for size ${size}x${size} with cutoff $CUTOFF"
+    strassen=$(./hybrid "$size" "$CUTOFF" "$LEAF")
+    rm -f gmon.out
+    winograd=$(./winograd "$size" "$CUTOFF" "$LEAF")
+    tw=${winograd#*,}
+    ts=${strassen#*,}
+    speedup=$(awk -v w="$tw" -v s="$ts" 'BEGIN { if (w > 0) printf "%.3f", s / w; else print "" }')
+    echo "$size,$tw,$ts,$speedup" >> "$PERFORMANCE_FILE"
+    if [[ -f gmon.out ]]; then
+        gprof winograd gmon.out > "analysis/analysis_${size}_${SUFFIX}.txt"
+        echo "Profiling saved to analysis/analysis_${size}_${SUFFIX}.txt"
+    else
+        echo "⚠️  gmon.out not generated for size $size"
+    fi
+    echo
+done
+
+echo "✅ All tests and profiling completed with cutoff value $CUTOFF."
+read -p "Display a graph of the benchmark data? (Y/n): " response
+if [[ "$response" =~ ^[Yy]$ || "$response" == "" ]]; then
+    echo "Executing the Python script..."
+    python3 plot.py "$PERFORMANCE_FILE" "$CUTOFF"
+else
+    echo "The graph display will not be executed."
+fi
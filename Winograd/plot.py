@@ -0,0 +1,34 @@
+import csv
+import sys
+import matplotlib.pyplot as plt
+
+path = sys.argv[1] if len(sys.argv) > 1 else 'performance/comparison_cutoff_64.csv'
+cutoff = sys.argv[2] if len(sys.argv) > 2 else '64'
+
+sizes = []
+winograd = []
+strassen = []
+
+with open(path, newline='') as csvfile:
+    reader = csv.DictReader(csvfile)
+    for row in reader:
+        sizes.append(int(row['Matrix Size']))
+        winograd.append(float(row['Winograd time (seconds)']))
+        strassen.append(float(row['Strassen time (seconds)']))
+
+plt.figure(figsize=(10, 6))
+plt.plot(sizes, strassen, marker='o', linestyle='-', color='royalblue', label='Strassen (18 additions)')
+plt.plot(sizes, winograd, marker='s', linestyle='-', color='darkorange', label='Winograd (15 additions)')
+
+plt.title(f'Strassen vs Strassen-Winograd (cutoff {cutoff})')
+plt.xlabel('Matrix Size (N x N)')
+plt.ylabel('Time (seconds)')
+plt.grid(True)
+plt.xscale('log', base=2)
+plt.yscale('linear')
+plt.xticks(sizes, labels=[str(size) for size in sizes], rotation=45)
+plt.legend()
+plt.tight_layout()
+
+plt.savefig("winograd_performance.png")
+plt.show()
@@ -0,0 +1,260 @@
+#include <stdlib.h>
+#include "matrix.h"
+#include "workstealing.h"
+
+/******************************************
+ * Batched multiplication
+ *
+ * A batch of independent products C[i] = A[i] * B[i] is cut into
+ * contiguous chunks of items, each chunk spawned as one task on the
+ * work-stealing runtime (BATCH_TASKS_PER_WORKER chunks per worker, so a
+ * worker that finishes early steals the rest). Every chunk owns one slot
+ * of a single workspace arena, sized for the largest item of the batch,
+ * and reuses it for all its items: the batch performs one allocation.
+ *
+ * Each item runs strassenMul_hybrid_ws, which picks the engine by size:
+ * an item with a dimension <= cutoff goes straight to the leaf kernel
+ * (mul, or mulBlocked with setHybridLeaf(LEAF_BLOCKED)), larger items
+ * run hybrid Strassen. With CUTOFF_AUTO each item takes the profile
+ * cutoff of its own largest dimension, both when its workspace is sized
+ * and when it runs.
+ *******************************************/
+
+#ifndef BATCH_TASKS_PER_WORKER
+#define BATCH_TASKS_PER_WORKER 4
+#endif
+
+/* Alignment of the workspace slot of a chunk, in bytes */
+#define BATCH_SLOT_ALIGN 64
+
+/**
+ * Items of a batch: arrays of matrices, or one strided buffer per operand
+ */
+struct BatchRun {
+    struct Matrix** A;          /* Arrays of matrices, NULL for a strided batch */
+    struct Matrix** B;
+    struct Matrix** C;
+    int* stridedA;              /* count consecutive m x k, k x n and m x n matrices */
+    int* stridedB;
+    int* stridedC;
+    int m, k, n;
+    int count;
+    int cutoff;
+    int chunks;
+    size_t slotBytes;           /* Workspace of one chunk */
+    char* workspace;
+};
+
+/**
+ * One chunk of consecutive items
+ */
+struct BatchTask {
+    struct Task task;
+    struct BatchRun* run;
+    int first;
+    int last;                   /* One past the last item */
+    void* ws;
+};
+
+/**
+ * Builds a matrix header over a buffer
+ * @param data   First element
+ * @param rows   Number of rows
+ * @param cols   Number of columns
+ * @return       Matrix struct (ld = cols)
+ */
+static struct Matrix bufferMatrix(int* data, int rows, int cols) {
+    struct Matrix mat;
+    mat.matrix = data;
+    mat.row = rows;
+    mat.col = cols;
+    mat.ld = cols;
+    return mat;
+}
+
+/**
+ * Task body: multiplies the items of one chunk with the chunk's workspace
+ * @param arg    BatchTask
+ */
+static void runChunk(void* arg) {
+    struct BatchTask* chunk = arg;
+    struct BatchRun* run = chunk->run;
+
+    for (int i = chunk->first; i < chunk->last; i++) {
+        if (run->A != NULL) {
+            strassenMul_hybrid_ws(run->A[i], run->B[i], run->C[i], run->cutoff, chunk->ws);
+        } else {
+            struct Matrix a = bufferMatrix(run->stridedA + (size_t)i * run->m * run->k, run->m, run->k);
+            struct Matrix b = bufferMatrix(run->stridedB + (size_t)i * run->k * run->n, run->k, run->n);
+            struct Matrix c = bufferMatrix(run->stridedC + (size_t)i * run->m * run->n, run->m, run->n);
+            strassenMul_hybrid_ws(&a, &b, &c, run->cutoff, chunk->ws);
+        }
+    }
+}
+
+/**
+ * Root task: spawns every chunk and waits for them
+ * @param arg    BatchRun
+ */
+static void runBatch(void* arg) {
+    struct BatchRun* run = arg;
+    struct BatchTask* tasks = (struct BatchTask*)(run->workspace + run->slotBytes * run->chunks);
+    struct TaskGroup group = { 0 };
+
+    for (int c = 0; c < run->chunks; c++) {
+        tasks[c].task.run = runChunk;
+        tasks[c].task.arg = &tasks[c];
+        tasks[c].run = run;
+        tasks[c].first = (int)((long)run->count * c / run->chunks);
+        tasks[c].last = (int)((long)run->count * (c + 1) / run->chunks);
+        tasks[c].ws = run->workspace + run->slotBytes * c;
+        taskSpawn(&group, &tasks[c].task);
+    }
+    taskSync(&group);
+}
+
+/**
+ * Returns the number of chunks a batch is cut into
+ * @param rt     Runtime, NULL for serial execution
+ * @param count  Number of items
+ * @return       Number of chunks (1 without a runtime)
+ */
+static int batchChunks(struct TaskRuntime* rt, int count) {
+    int chunks = rt != NULL ? runtimeWorkers(rt) * BATCH_TASKS_PER_WORKER : 1;
+    return chunks < count ? chunks : count;
+}
+
+/**
+ * Returns the workspace slot of one chunk, aligned to BATCH_SLOT_ALIGN
+ * @param bytes  Workspace of the largest item
+ * @return       Size of a slot in bytes
+ */
+static size_t batchSlot(size_t bytes) {
+    return (bytes + BATCH_SLOT_ALIGN - 1) / BATCH_SLOT_ALIGN * BATCH_SLOT_ALIGN;
+}
+
+/**
+ * Returns the bytes of the arena of a batch: one slot per chunk plus
+ * the task descriptors
+ * @param rt         Runtime, NULL for serial execution
+ * @param count      Number of items
+ * @param itemBytes  Workspace of the largest item
+ * @return           Size of the arena in bytes
+ */
+static size_t batchArena(struct TaskRuntime* rt, int count, size_t itemBytes) {
+    int chunks = batchChunks(rt, count);
+    return batchSlot(itemBytes) * chunks + sizeof(struct BatchTask) * chunks;
+}
+
+/**
+ * Returns the bytes of workspace needed by strassenMulBatch_ws
+ * @param rt     Runtime, NULL for serial execution
+ * @param A      Array of count left operands
+ * @param B      Array of count right operands
+ * @param count  Number of items
+ * @param cutoff Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return       Size of the arena in bytes
+ */
+size_t strassenBatchWorkspaceSize(struct TaskRuntime* rt, struct Matrix** A, struct Matrix** B,
+                                  int count, int cutoff) {
+    size_t largest = 0;
+
+    for (int i = 0; i < count; i++) {
+        size_t bytes = strassenWorkspaceSizeRect(A[i]->row, A[i]->col, B[i]->col, cutoff);
+        if (bytes > largest) largest = bytes;
+    }
+    return batchArena(rt, count, largest);
+}
+
+/**
+ * Multiplies a batch of independent products on a caller-supplied arena
+ * @param rt         Runtime, NULL for serial execution
+ * @param A          Array of count left operands
+ * @param B          Array of count right operands
+ * @param C          Array of count results (pre-allocated)
+ * @param count      Number of items
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO to take it
+ *                   from the tuned profile for each item
+ * @param workspace  Arena of at least strassenBatchWorkspaceSize(rt, A, B, count, cutoff) bytes
+ * @return           0 on success
+ */
+int strassenMulBatch_ws(struct TaskRuntime* rt, struct Matrix** A, struct Matrix** B, struct Matrix** C,
+                        int count, int cutoff, void* workspace) {
+    if (count <= 0) return 0;
+
+    size_t largest = 0;
+    for (int i = 0; i < count; i++) {
+        size_t bytes = strassenWorkspaceSizeRect(A[i]->row, A[i]->col, B[i]->col, cutoff);
+        if (bytes > largest) largest = bytes;
+    }
+
+    struct BatchRun run = { A, B, C, NULL, NULL, NULL, 0, 0, 0, count, cutoff,
+                            batchChunks(rt, count), batchSlot(largest), workspace };
+    if (rt != NULL) {
+        runtimeRun(rt, runBatch, &run);
+    } else {
+        runBatch(&run);
+    }
+    return 0;
+}
+
+/**
+ * Multiplies a batch of independent products
+ * @param rt         Runtime, NULL for serial execution
+ * @param A          Array of count left operands
+ * @param B          Array of count right operands
+ * @param C          Array of count results (pre-allocated)
+ * @param count      Number of items
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO to take it
+ *                   from the tuned profile for each item
+ * @return           0 on success, -1 if the arena cannot be allocated
+ */
+int strassenMulBatch(struct TaskRuntime* rt, struct Matrix** A, struct Matrix** B, struct Matrix** C,
+                     int count, int cutoff) {
+    if (count <= 0) return 0;
+
+    void* workspace = malloc(strassenBatchWorkspaceSize(rt, A, B, count, cutoff));
+    if (workspace == NULL) return -1;
+
+    strassenMulBatch_ws(rt, A, B, C, count, cutoff, workspace);
+
+    free(workspace);
+    return 0;
+}
+
+/**
+ * Multiplies a batch of same-shape products stored back to back
+ * Item i is A + i*m*k (m x k), B + i*k*n (k x n) and C + i*m*n (m x n),
+ * all row-major with no padding between rows
+ *
+ * @param rt         Runtime, NULL for serial execution
+ * @param A          count left operands
+ * @param B          count right operands
+ * @param C          count results
+ * @param m          Rows of every A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of every B and C
+ * @param count      Number of items
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO to take it
+ *                   from the tuned profile for each item
+ * @return           0 on success, -1 if the arena cannot be allocated
+ */
+int strassenMulBatchStrided(struct TaskRuntime* rt, int* A, int* B, int* C,
+                            int m, int k, int n, int count, int cutoff) {
+    if (count <= 0) return 0;
+
+    size_t itemBytes = strassenWorkspaceSizeRect(m, k, n, cutoff);
+    void* workspace = malloc(batchArena(rt, count, itemBytes));
+    if (workspace == NULL) return -1;
+
+    struct BatchRun run = { NULL, NULL, NULL, A, B, C, m, k, n, count, cutoff,
+                            batchChunks(rt, count), batchSlot(itemBytes), workspace };
+    if (rt != NULL) {
+        runtimeRun(rt, runBatch, &run);
+    } else {
+        runBatch(&run);
+    }
+
+    free(workspace);
+    return 0;
+}
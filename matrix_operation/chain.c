@@ -0,0 +1,335 @@
+#include <stdlib.h>
+#include "matrix.h"
+
+/******************************************
+ * Matrix-chain multiplication
+ *
+ * The order of a chain M1 * M2 * ... * Mn is chosen by the classic
+ * O(n^3) dynamic programme over split points, but the cost of one
+ * product is not m*k*n: strassenCost follows the recursion of the
+ * hybrid engine (peeled levels, halved unbalanced levels, 7 products
+ * and 18 block additions per Strassen level, leaf products at the
+ * cutoff), so the plan favours the shapes Strassen handles well.
+ *
+ * Execution walks the plan in post-order. Every intermediate product
+ * gets a slot of a buffer pool, and a slot is released as soon as its
+ * product has been consumed. A dry run of the walk assigns the slots
+ * and sizes them first, so the whole chain performs one allocation:
+ * the slots followed by one Strassen arena sized for the largest
+ * product of the plan.
+ *******************************************/
+
+/**
+ * One buffer of the pool
+ */
+struct ChainSlot {
+    size_t offset;              /* In ints from the start of the allocation */
+    size_t capacity;            /* In ints */
+    int busy;
+};
+
+/**
+ * State of one execution of a plan
+ */
+struct ChainRun {
+    struct Matrix** mats;
+    const int* dims;            /* Matrix i is dims[i] x dims[i + 1] */
+    const int* split;           /* split[i * count + j]: last matrix of the left factor */
+    int count;
+    int cutoff;
+    int dry;                    /* Assign and size slots without multiplying */
+    struct ChainSlot* slots;    /* At most count - 1 intermediates */
+    int slotCount;
+    int* assigned;              /* Slot of product (i, j), at i * count + j */
+    int* buffers;               /* Slots of the pool, NULL during the dry run */
+    void* workspace;            /* Strassen arena */
+    size_t workspaceBytes;
+};
+
+/**
+ * A factor of a product: an input matrix or an intermediate in a slot
+ */
+struct ChainOperand {
+    struct Matrix mat;
+    int slot;                   /* -1 for an input matrix or C */
+};
+
+/**
+ * Returns the model cost of an m x k by k x n product with the hybrid engine
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine
+ * @return           Number of scalar additions and multiplications
+ */
+double strassenCost(int m, int k, int n, int cutoff) {
+    if (cutoff < 1) cutoff = 1;
+
+    /* Leaf kernel: one multiply and one add per term */
+    if (m <= cutoff || k <= cutoff || n <= cutoff) {
+        return 2.0 * m * k * n;
+    }
+
+    /* Peeled level: even leading product plus the rank-1, column and row fix-ups */
+    if ((m | k | n) & 1) {
+        int me = m & ~1, ke = k & ~1, ne = n & ~1;
+        double peel = 2.0 * ((double)me * ne * (k & 1) + (double)m * k * (n & 1) + (double)k * ne * (m & 1));
+        return strassenCost(me, ke, ne, cutoff) + peel;
+    }
+
+    /* Unbalanced level: halve the largest dimension only */
+    int largest = m > k ? (m > n ? m : n) : (k > n ? k : n);
+    int smallest = m < k ? (m < n ? m : n) : (k < n ? k : n);
+    if (largest >= 2 * smallest) {
+        if (m == largest) return 2.0 * strassenCost(m / 2, k, n, cutoff);
+        if (n == largest) return 2.0 * strassenCost(m, k, n / 2, cutoff);
+        return 2.0 * strassenCost(m, k / 2, n, cutoff) + (double)m * n;
+    }
+
+    /* Strassen level: 7 half products, 5 sums of A blocks, 5 of B blocks, 8 updates and 1 copy of C blocks */
+    double hm = m / 2, hk = k / 2, hn = n / 2;
+    return 7.0 * strassenCost(m / 2, k / 2, n / 2, cutoff) + 5.0 * hm * hk + 5.0 * hk * hn + 9.0 * hm * hn;
+}
+
+/**
+ * Chooses the cheapest parenthesisation of a chain
+ * @param dims       count + 1 dimensions, matrix i is dims[i] x dims[i + 1]
+ * @param count      Number of matrices
+ * @param cutoff     Size threshold of the hybrid engine
+ * @param split      Receives count * count split points (may be NULL)
+ * @return           Model cost of the plan, -1 if a buffer cannot be allocated
+ */
+double chainPlan(const int* dims, int count, int cutoff, int* split) {
+    if (count < 1) return 0.0;
+
+    double* cost = calloc((size_t)count * count, sizeof(double));
+    int* choice = split != NULL ? split : malloc(sizeof(int) * count * count);
+    if (cost == NULL || choice == NULL) {
+        free(cost);
+        if (split == NULL) free(choice);
+        return -1.0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        cost[i * count + i] = 0.0;
+        choice[i * count + i] = i;
+    }
+
+    /* Chains of increasing length: cost(i, j) = min over s of cost(i, s) + cost(s + 1, j) + product */
+    for (int length = 2; length <= count; length++) {
+        for (int i = 0; i + length - 1 < count; i++) {
+            int j = i + length - 1;
+            double best = -1.0;
+            for (int s = i; s < j; s++) {
+                double c = cost[i * count + s] + cost[(s + 1) * count + j] +
+                           strassenCost(dims[i], dims[s + 1], dims[j + 1], cutoff);
+                if (best < 0.0 || c < best) {
+                    best = c;
+                    choice[i * count + j] = s;
+                }
+            }
+            cost[i * count + j] = best;
+        }
+    }
+
+    double total = cost[count - 1];
+    free(cost);
+    if (split == NULL) free(choice);
+    return total;
+}
+
+/**
+ * Takes a free slot of at least elems ints
+ * The dry run picks the smallest free slot that fits, otherwise grows
+ * the largest free one, otherwise opens a new slot; the real run reuses
+ * the slot recorded for the product
+ *
+ * @param run    Execution state
+ * @param node   Product index i * count + j
+ * @param elems  Size of the product in ints
+ * @return       Slot index
+ */
+static int acquireSlot(struct ChainRun* run, int node, size_t elems) {
+    if (!run->dry) {
+        run->slots[run->assigned[node]].busy = 1;
+        return run->assigned[node];
+    }
+
+    int fit = -1, largest = -1;
+    for (int s = 0; s < run->slotCount; s++) {
+        if (run->slots[s].busy) continue;
+        if (run->slots[s].capacity >= elems &&
+            (fit < 0 || run->slots[s].capacity < run->slots[fit].capacity)) {
+            fit = s;
+        }
+        if (largest < 0 || run->slots[s].capacity > run->slots[largest].capacity) {
+            largest = s;
+        }
+    }
+
+    int slot = fit >= 0 ? fit : largest;
+    if (slot < 0) {
+        slot = run->slotCount++;
+        run->slots[slot].capacity = 0;
+    }
+    if (run->slots[slot].capacity < elems) run->slots[slot].capacity = elems;
+    run->slots[slot].busy = 1;
+    run->assigned[node] = slot;
+    return slot;
+}
+
+/**
+ * Returns the slot of an operand to the pool
+ * @param run    Execution state
+ * @param op     Operand
+ */
+static void releaseOperand(struct ChainRun* run, struct ChainOperand* op) {
+    if (op->slot >= 0) run->slots[op->slot].busy = 0;
+}
+
+/**
+ * Multiplies matrices i..j of the chain following the plan
+ * @param run    Execution state
+ * @param i      First matrix
+ * @param j      Last matrix
+ * @param out    Destination of the product, NULL to use a pool slot
+ * @return       The product (an input matrix when i == j)
+ */
+static struct ChainOperand chainRun(struct ChainRun* run, int i, int j, struct Matrix* out) {
+    struct ChainOperand result;
+
+    if (i == j) {
+        result.mat = *run->mats[i];
+        result.slot = -1;
+        return result;
+    }
+
+    int s = run->split[i * run->count + j];
+    struct ChainOperand left = chainRun(run, i, s, NULL);
+    struct ChainOperand right = chainRun(run, s + 1, j, NULL);
+    int rows = run->dims[i], cols = run->dims[j + 1];
+
+    if (out != NULL) {
+        result.mat = *out;
+        result.slot = -1;
+    } else {
+        result.slot = acquireSlot(run, i * run->count + j, (size_t)rows * cols);
+        result.mat.matrix = run->buffers != NULL ? run->buffers + run->slots[result.slot].offset : NULL;
+        result.mat.row = rows;
+        result.mat.col = cols;
+        result.mat.ld = cols;
+    }
+
+    if (run->dry) {
+        size_t bytes = strassenWorkspaceSizeRect(rows, run->dims[s + 1], cols, run->cutoff);
+        if (bytes > run->workspaceBytes) run->workspaceBytes = bytes;
+    } else {
+        strassenMul_hybrid_ws(&left.mat, &right.mat, &result.mat, run->cutoff, run->workspace);
+    }
+
+    releaseOperand(run, &left);
+    releaseOperand(run, &right);
+    return result;
+}
+
+/**
+ * Plans and runs a chain on bookkeeping arrays allocated by chainMul
+ * @param run        Execution state with mats, count, cutoff, slots and assigned set
+ * @param dims       Receives the count + 1 dimensions
+ * @param split      Receives the count * count split points
+ * @param C          Output matrix
+ * @param report     Receives the model costs and the buffer size (may be NULL)
+ * @return           Pointer to the result matrix C, NULL if the buffers cannot be allocated
+ */
+static struct Matrix* chainExecute(struct ChainRun* run, int* dims, int* split, struct Matrix* C,
+                                   struct ChainReport* report) {
+    int count = run->count;
+    int largest = 0;
+
+    for (int i = 0; i < count; i++) {
+        dims[i] = run->mats[i]->row;
+        if (dims[i] > largest) largest = dims[i];
+    }
+    dims[count] = run->mats[count - 1]->col;
+    if (dims[count] > largest) largest = dims[count];
+
+    if (run->cutoff == CUTOFF_AUTO) run->cutoff = profileCutoff(largest);
+    if (run->cutoff < 1) run->cutoff = 1;
+
+    double planned = chainPlan(dims, count, run->cutoff, split);
+    if (planned < 0.0) return NULL;
+
+    /* Dry run: assign the slots and size the pool and the arena */
+    run->dims = dims;
+    run->split = split;
+    run->dry = 1;
+    if (count > 1) chainRun(run, 0, count - 1, C);
+
+    size_t elems = 0;
+    for (int s = 0; s < run->slotCount; s++) {
+        run->slots[s].offset = elems;
+        run->slots[s].busy = 0;
+        elems += (run->slots[s].capacity + 15) & ~(size_t)15;   /* 64-byte aligned slots */
+    }
+    size_t bytes = elems * sizeof(int) + run->workspaceBytes;
+
+    if (report != NULL) {
+        report->plannedCost = planned;
+        report->leftToRightCost = 0.0;
+        for (int i = 1; i < count; i++) {
+            report->leftToRightCost += strassenCost(dims[0], dims[i], dims[i + 1], run->cutoff);
+        }
+        report->bufferBytes = bytes;
+    }
+
+    if (count == 1) {
+        copySubmatrixRect(run->mats[0], 0, 0, C, 0, 0, C->row, C->col);
+        return C;
+    }
+
+    run->buffers = malloc(bytes > 0 ? bytes : 1);
+    if (run->buffers == NULL) return NULL;
+    run->workspace = run->buffers + elems;
+    run->dry = 0;
+
+    chainRun(run, 0, count - 1, C);
+
+    free(run->buffers);
+    return C;
+}
+
+/**
+ * Multiplies a chain of matrices in the cheapest order of the cost model
+ * @param mats       count matrices, mats[i]->col == mats[i + 1]->row
+ * @param count      Number of matrices
+ * @param C          Output matrix (mats[0]->row x mats[count - 1]->col, must not overlap the inputs)
+ * @param cutoff     Size threshold of the hybrid engine, CUTOFF_AUTO for the tuned profile
+ * @param report     Receives the model costs and the buffer size (may be NULL)
+ * @return           Pointer to the result matrix C, NULL if the shapes do not
+ *                   chain or the buffers cannot be allocated
+ */
+struct Matrix* chainMul(struct Matrix** mats, int count, struct Matrix* C, int cutoff,
+                        struct ChainReport* report) {
+    if (count < 1) return NULL;
+    if (C->row != mats[0]->row || C->col != mats[count - 1]->col) return NULL;
+    for (int i = 0; i + 1 < count; i++) {
+        if (mats[i]->col != mats[i + 1]->row) return NULL;
+    }
+
+    int* dims = malloc(sizeof(int) * (count + 1));
+    int* split = malloc(sizeof(int) * count * count);
+    int* assigned = malloc(sizeof(int) * count * count);
+    struct ChainSlot* slots = malloc(sizeof(struct ChainSlot) * count);
+    struct Matrix* result = NULL;
+
+    if (dims != NULL && split != NULL && assigned != NULL && slots != NULL) {
+        struct ChainRun run = { mats, NULL, NULL, count, cutoff, 1, slots, 0, assigned, NULL, NULL, 0 };
+        result = chainExecute(&run, dims, split, C, report);
+    }
+
+    free(dims);
+    free(split);
+    free(assigned);
+    free(slots);
+    return result;
+}
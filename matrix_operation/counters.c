@@ -0,0 +1,319 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "counters.h"
+
+/******************************************
+ * Hardware counters per recursion level
+ *
+ * Every thread keeps a stack of the phases of its active levels and the
+ * counter values at the last phase change. A hook reads the counters,
+ * charges the difference to the phase on top of the stack, then pushes,
+ * pops or replaces that phase. The totals are shared by all threads and
+ * updated under a mutex; the instrumented build is for analysis, not
+ * for timing runs.
+ *
+ * The descriptors of a thread are closed by a thread-specific key
+ * destructor when the thread exits, so the workers of every runtime
+ * release theirs in runtimeDestroy. A sample whose read fails is marked
+ * invalid and no counter delta is charged across it, only time.
+ *******************************************/
+
+#define EVENT_COUNT 5
+
+static const char* const phaseNames[PHASE_COUNT] = { "form", "multiply", "accumulate", "peel" };
+
+/**
+ * Counter values at one point of a thread
+ */
+struct CounterSample {
+    double seconds;
+    int valid;                          /* 0 if the counters could not be read */
+    uint64_t values[EVENT_COUNT];
+};
+
+/**
+ * Totals of one depth and phase
+ */
+struct PhaseTotals {
+    long calls;
+    double seconds;
+    uint64_t values[EVENT_COUNT];
+};
+
+/**
+ * Counters and phase stack of one thread
+ */
+struct ThreadCounters {
+    int opened;                         /* Counters opened (or tried) */
+    int leader;                         /* Group leader fd, -1 for timing only */
+    int fd[EVENT_COUNT];                /* Descriptor of each event, -1 if unavailable */
+    int slot[EVENT_COUNT];              /* Position in the group read, -1 if unavailable */
+    int events;                         /* Number of events in the group */
+    int depth;                          /* Number of active levels */
+    enum CounterPhase phase[COUNTER_MAX_DEPTH];
+    struct CounterSample last;
+};
+
+static __thread struct ThreadCounters thread = { .leader = -1, .fd = { -1, -1, -1, -1, -1 },
+                                                 .slot = { -1, -1, -1, -1, -1 } };
+
+static int enabled = 0;                 /* Read and written with __atomic builtins */
+static pthread_once_t closeKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t closeKey;          /* Destructor closes the counters of an exiting thread */
+static int available[EVENT_COUNT];      /* Events opened by the thread that called countersStart */
+static struct PhaseTotals totals[COUNTER_MAX_DEPTH][PHASE_COUNT];
+static pthread_mutex_t totalsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns the perf configuration of an event
+ * @param event  Index: cycles, instructions, L1D, LLC, dTLB
+ * @param attr   Attribute to fill
+ */
+static void eventAttr(int event, struct perf_event_attr* attr) {
+    static const uint64_t cacheReadMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+    attr->read_format = PERF_FORMAT_GROUP;
+
+    switch (event) {
+        case 0: attr->type = PERF_TYPE_HARDWARE; attr->config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case 1: attr->type = PERF_TYPE_HARDWARE; attr->config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case 2: attr->type = PERF_TYPE_HW_CACHE; attr->config = PERF_COUNT_HW_CACHE_L1D | cacheReadMiss; break;
+        case 3: attr->type = PERF_TYPE_HARDWARE; attr->config = PERF_COUNT_HW_CACHE_MISSES; break;
+        default: attr->type = PERF_TYPE_HW_CACHE; attr->config = PERF_COUNT_HW_CACHE_DTLB | cacheReadMiss; break;
+    }
+}
+
+/**
+ * Closes the counters of a thread
+ * Used as the destructor of closeKey, so it runs when the thread exits
+ * @param arg    ThreadCounters of the exiting thread
+ */
+static void closeThreadCounters(void* arg) {
+    struct ThreadCounters* counters = arg;
+
+    /* Members first, the group leader last */
+    for (int e = EVENT_COUNT - 1; e >= 0; e--) {
+        if (counters->fd[e] >= 0) close(counters->fd[e]);
+        counters->fd[e] = -1;
+        counters->slot[e] = -1;
+    }
+    counters->leader = -1;
+    counters->events = 0;
+}
+
+/**
+ * Creates the key whose destructor closes the counters of a thread
+ */
+static void createCloseKey(void) {
+    pthread_key_create(&closeKey, closeThreadCounters);
+}
+
+/**
+ * Opens the counters of the calling thread as one group
+ * Events the PMU refuses are skipped; if none opens, only time is recorded
+ */
+static void openThreadCounters(void) {
+    thread.opened = 1;
+    thread.leader = -1;
+    thread.events = 0;
+
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        struct perf_event_attr attr;
+        eventAttr(e, &attr);
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, thread.leader, 0);
+        thread.fd[e] = fd;
+        thread.slot[e] = -1;
+        if (fd < 0) continue;
+        if (thread.leader < 0) thread.leader = fd;
+        thread.slot[e] = thread.events++;
+    }
+
+    if (thread.leader >= 0) {
+        pthread_once(&closeKeyOnce, createCloseKey);
+        pthread_setspecific(closeKey, &thread);
+    }
+}
+
+/**
+ * Reads the time and counters of the calling thread
+ * @param sample     Receives the values; valid is 0 if the group read failed
+ */
+static void readSample(struct CounterSample* sample) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    sample->seconds = ts.tv_sec + ts.tv_nsec * 1e-9;
+    sample->valid = 1;
+
+    uint64_t buffer[1 + EVENT_COUNT] = { 0 };
+    if (thread.leader >= 0) {
+        ssize_t bytes = read(thread.leader, buffer, sizeof(buffer));
+        if (bytes < (ssize_t)(sizeof(uint64_t) * (1 + thread.events))) {
+            sample->valid = 0;
+            buffer[0] = 0;
+        }
+    }
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        int slot = thread.slot[e];
+        sample->values[e] = slot >= 0 && (uint64_t)slot < buffer[0] ? buffer[1 + slot] : 0;
+    }
+}
+
+/**
+ * Returns the entry of the totals used by the current level
+ * Levels below COUNTER_MAX_DEPTH share the deepest entry
+ * @return       Index in the phase stack and the totals
+ */
+static int currentLevel(void) {
+    return thread.depth < COUNTER_MAX_DEPTH ? thread.depth - 1 : COUNTER_MAX_DEPTH - 1;
+}
+
+/**
+ * Charges the counters since the last hook to the current phase
+ * and moves the reference point to now
+ * The counters are only charged when both ends of the interval were read
+ */
+static void chargeCurrentPhase(void) {
+    struct CounterSample now;
+    readSample(&now);
+
+    if (thread.depth > 0) {
+        int level = currentLevel();
+        struct PhaseTotals* total = &totals[level][thread.phase[level]];
+        pthread_mutex_lock(&totalsLock);
+        total->seconds += now.seconds - thread.last.seconds;
+        if (now.valid && thread.last.valid) {
+            for (int e = 0; e < EVENT_COUNT; e++) {
+                total->values[e] += now.values[e] - thread.last.values[e];
+            }
+        }
+        pthread_mutex_unlock(&totalsLock);
+    }
+    thread.last = now;
+}
+
+/**
+ * Called when a recursion level starts
+ * The set-up of the level, before its first phase hook, is charged to
+ * form without counting as a call
+ */
+void counterEnter(void) {
+    if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE)) return;
+    if (!thread.opened) openThreadCounters();
+
+    chargeCurrentPhase();
+    thread.depth++;
+    thread.phase[currentLevel()] = PHASE_FORM;
+}
+
+/**
+ * Called when the current level starts a phase
+ * Every call counts as one execution of the phase
+ * @param phase  New phase of the level
+ */
+void counterPhase(enum CounterPhase phase) {
+    if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE) || thread.depth == 0) return;
+
+    chargeCurrentPhase();
+    thread.phase[currentLevel()] = phase;
+    pthread_mutex_lock(&totalsLock);
+    totals[currentLevel()][phase].calls++;
+    pthread_mutex_unlock(&totalsLock);
+}
+
+/**
+ * Called when a recursion level returns
+ */
+void counterLeave(void) {
+    if (!__atomic_load_n(&enabled, __ATOMIC_ACQUIRE) || thread.depth == 0) return;
+
+    chargeCurrentPhase();
+    thread.depth--;
+}
+
+/**
+ * Clears the totals and starts recording
+ * @return      Number of hardware events available, 0 for timing only,
+ *              -1 if built without MATRIX_COUNTERS
+ */
+int countersStart(void) {
+#ifndef MATRIX_COUNTERS
+    return -1;
+#else
+    int events = 0;
+
+    if (!thread.opened) openThreadCounters();
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        available[e] = thread.slot[e] >= 0;
+        events += available[e];
+    }
+
+    pthread_mutex_lock(&totalsLock);
+    memset(totals, 0, sizeof(totals));
+    pthread_mutex_unlock(&totalsLock);
+    thread.depth = 0;
+    __atomic_store_n(&enabled, 1, __ATOMIC_RELEASE);
+    return events;
+#endif
+}
+
+/**
+ * Stops recording
+ */
+void countersStop(void) {
+    __atomic_store_n(&enabled, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Prints one counter as a CSV field, empty when the event is unavailable
+ * @param out    Output stream
+ * @param total  Totals of a depth and phase
+ * @param event  Event index
+ */
+static void printEvent(FILE* out, const struct PhaseTotals* total, int event) {
+    if (available[event]) {
+        fprintf(out, ",%llu", (unsigned long long)total->values[event]);
+    } else {
+        fprintf(out, ",");
+    }
+}
+
+/**
+ * Prints the totals as CSV
+ * @param out   Output stream
+ */
+void countersPrint(FILE* out) {
+    fprintf(out, "depth,phase,calls,seconds,cycles,instructions,ipc,l1d_misses,llc_misses,dtlb_misses\n");
+
+    pthread_mutex_lock(&totalsLock);
+    for (int depth = 0; depth < COUNTER_MAX_DEPTH; depth++) {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            const struct PhaseTotals* total = &totals[depth][phase];
+            if (total->calls == 0) continue;
+
+            fprintf(out, "%d,%s,%ld,%f", depth, phaseNames[phase], total->calls, total->seconds);
+            printEvent(out, total, 0);
+            printEvent(out, total, 1);
+            if (available[0] && available[1] && total->values[0] > 0) {
+                fprintf(out, ",%.3f", (double)total->values[1] / total->values[0]);
+            } else {
+                fprintf(out, ",");
+            }
+            printEvent(out, total, 2);
+            printEvent(out, total, 3);
+            printEvent(out, total, 4);
+            fprintf(out, "\n");
+        }
+    }
+    pthread_mutex_unlock(&totalsLock);
+}
@@ -0,0 +1,77 @@
+#ifndef counters_H_
+#define counters_H_
+
+#include <stdio.h>
+
+/*********************************************
+ * Hardware counters per recursion level
+ *
+ * Built with -DMATRIX_COUNTERS, the Strassen engine brackets every
+ * recursion level and every phase of a level with perf_event_open
+ * counters (cycles, instructions, L1D read misses, LLC misses, dTLB read
+ * misses) and wall time. Costs are exclusive: a level is charged for its
+ * own work only, the products it delegates are charged to the level
+ * below. Phases:
+ *
+ *   form        operand sums and differences (temporaries of a level)
+ *   multiply    leaf kernel (mul or mulBlocked) at the deepest level
+ *   accumulate  updates of the quadrants of C
+ *   peel        peelUpdate on odd dimensions
+ *
+ * Each thread opens its own counters on first use; when the PMU is not
+ * accessible (perf_event_paranoid, containers, virtual machines) only
+ * time is recorded. Without -DMATRIX_COUNTERS the hooks compile to
+ * nothing and countersStart returns -1.
+ *********************************************/
+
+/* Deepest level recorded separately, deeper levels are merged into it */
+#define COUNTER_MAX_DEPTH 32
+
+enum CounterPhase {
+    PHASE_FORM,
+    PHASE_MULTIPLY,
+    PHASE_ACCUMULATE,
+    PHASE_PEEL,
+    PHASE_COUNT
+};
+
+/**
+ * Clears the totals and starts recording
+ *
+ * @return      Number of hardware events available on the calling thread,
+ *              0 for timing only, -1 if built without MATRIX_COUNTERS
+ */
+int countersStart(void);
+
+/**
+ * Stops recording; the totals are kept until the next countersStart
+ */
+void countersStop(void);
+
+/**
+ * Prints the totals as CSV, one line per depth and phase that ran:
+ * depth,phase,calls,seconds,cycles,instructions,ipc,l1d_misses,llc_misses,dtlb_misses
+ * Unavailable events are printed as empty fields
+ *
+ * @param out   Output stream
+ */
+void countersPrint(FILE* out);
+
+/**
+ * Hooks called by the engines, through the COUNTERS_* macros below
+ */
+void counterEnter(void);
+void counterPhase(enum CounterPhase phase);
+void counterLeave(void);
+
+#ifdef MATRIX_COUNTERS
+#define COUNTERS_ENTER()        counterEnter()
+#define COUNTERS_PHASE(phase)   counterPhase(phase)
+#define COUNTERS_LEAVE()        counterLeave()
+#else
+#define COUNTERS_ENTER()        ((void)0)
+#define COUNTERS_PHASE(phase)   ((void)0)
+#define COUNTERS_LEAVE()        ((void)0)
+#endif
+
+#endif /* counters_H_ */
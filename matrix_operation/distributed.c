@@ -0,0 +1,431 @@
+#ifdef MATRIX_MPI
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "distributed.h"
+
+/******************************************
+ * Distributed Strassen (CAPS schedule)
+ *
+ * Every rank plans the same schedule from the broadcast dimensions. It
+ * then allocates one arena for its local operands, the buffers of every
+ * level and the arena of its in-memory product, so that a failed
+ * allocation is agreed on before the first message. m and k are padded
+ * to multiples of 2^steps * P and n to a multiple of 2^steps: every
+ * level then splits the local rows of A, B and C evenly between
+ * quadrants.
+ *
+ * The 7 products are those of strassenLevel. Here each level zeroes C
+ * and adds or subtracts every product into its quadrants.
+ *******************************************/
+
+/**
+ * Operands of one Strassen product and its contributions to C
+ * Quadrants are numbered 0 = 11, 1 = 12, 2 = 21, 3 = 22
+ */
+struct CapsProduct {
+    int a[2];           /* Quadrants of A, a[1] < 0 for a single one */
+    int aSign;          /* a[0] + a[1] (1) or a[0] - a[1] (-1) */
+    int b[2];           /* Quadrants of B */
+    int bSign;
+    int c[4];           /* Coefficient of the product in each quadrant of C */
+};
+
+static const struct CapsProduct capsProducts[7] = {
+    { { 1, 3 }, -1, { 2, 3 }, 1, { 1, 0, 0, 0 } },      /* P1 = (A12 - A22) * (B21 + B22) */
+    { { 0, 3 }, 1, { 0, 3 }, 1, { 1, 0, 0, 1 } },       /* P2 = (A11 + A22) * (B11 + B22) */
+    { { 0, 2 }, -1, { 0, 1 }, 1, { 0, 0, 0, -1 } },     /* P3 = (A11 - A21) * (B11 + B12) */
+    { { 0, 1 }, 1, { 3, -1 }, 1, { -1, 1, 0, 0 } },     /* P4 = (A11 + A12) * B22 */
+    { { 0, -1 }, 1, { 1, 3 }, -1, { 0, 1, 0, 1 } },     /* P5 = A11 * (B12 - B22) */
+    { { 3, -1 }, 1, { 2, 0 }, -1, { 1, 0, 1, 0 } },     /* P6 = A22 * (B21 - B11) */
+    { { 2, 3 }, 1, { 0, -1 }, 1, { 0, 0, 1, -1 } }      /* P7 = (A21 + A22) * B11 */
+};
+
+/**
+ * State of one distributed multiplication on a rank
+ */
+struct CapsRun {
+    int cutoff;
+    const char* schedule;       /* 'D' and 'B' steps from the top */
+    long long commBytes;        /* Bytes this rank sent to other ranks */
+    double commSeconds;         /* Time this rank spent in the all-to-alls */
+};
+
+/**
+ * Returns a quadrant of a local matrix
+ * @param X      Local part of a matrix
+ * @param q      Quadrant (0 = 11, 1 = 12, 2 = 21, 3 = 22)
+ * @return       View on the quadrant
+ */
+static struct Matrix capsQuadrant(struct Matrix* X, int q) {
+    int rows = X->row / 2, cols = X->col / 2;
+    return matrixView(X, (q >> 1) * rows, (q & 1) * cols, rows, cols);
+}
+
+/**
+ * Forms the operand of a product from the quadrants of a local matrix
+ * @param X      Local part of A or B
+ * @param quads  Quadrants to combine, quads[1] < 0 for a single one
+ * @param sign   1 for a sum, -1 for a difference
+ * @param out    Receives the operand
+ */
+static void capsOperand(struct Matrix* X, const int* quads, int sign, struct Matrix* out) {
+    struct Matrix X1 = capsQuadrant(X, quads[0]);
+    if (quads[1] < 0) {
+        copySubmatrixRect(&X1, 0, 0, out, 0, 0, out->row, out->col);
+        return;
+    }
+    struct Matrix X2 = capsQuadrant(X, quads[1]);
+    if (sign > 0) {
+        sumMatrixRect(&X1, 0, 0, &X2, 0, 0, out, 0, 0, out->row, out->col);
+    } else {
+        subMatrixRect(&X1, 0, 0, &X2, 0, 0, out, 0, 0, out->row, out->col);
+    }
+}
+
+/**
+ * Adds a product into the quadrants of a local C with its coefficients
+ * @param product    Product description
+ * @param P          Local part of the product
+ * @param C          Local part of C
+ */
+static void capsAccumulate(const struct CapsProduct* product, struct Matrix* P, struct Matrix* C) {
+    for (int q = 0; q < 4; q++) {
+        int row = (q >> 1) * P->row, col = (q & 1) * P->col;
+        if (product->c[q] > 0) {
+            addSubmatrixRect(P, C, row, col, P->row, P->col);
+        } else if (product->c[q] < 0) {
+            subSubmatrixRect(P, C, row, col, P->row, P->col);
+        }
+    }
+}
+
+/**
+ * Returns the ints a level needs on each rank for its temporaries
+ * @param m      Rows of A and C (padded)
+ * @param k      Columns of A / rows of B
+ * @param n      Columns of B and C
+ * @param ranks  Ranks sharing the level
+ * @param step   'D' or 'B'
+ * @return       Number of ints
+ */
+static size_t capsLevelElems(int m, int k, int n, int ranks, char step) {
+    size_t hmL = (size_t)m / 2 / ranks, hkL = (size_t)k / 2 / ranks;
+    size_t block = hmL * (k / 2) + hkL * (n / 2), cBlock = hmL * (n / 2);
+    if (step == 'D') return block + cBlock;        /* S, T and Q */
+    return 14 * block + 21 * cBlock;               /* Send, receive; Q, packed Q, received Q */
+}
+
+/**
+ * Pads the dimensions for a schedule and returns the memory it needs per rank
+ * @param m          Rows of A and C, padded on return
+ * @param k          Columns of A / rows of B, padded on return
+ * @param n          Columns of B and C, padded on return
+ * @param ranks      Ranks at the top level (a power of 7)
+ * @param cutoff     Size threshold of the local hybrid engine
+ * @param schedule   'D' and 'B' steps from the top
+ * @return           Bytes of the arena of one rank
+ */
+static size_t capsPlan(int* m, int* k, int* n, int ranks, int cutoff, const char* schedule) {
+    int steps = (int)strlen(schedule);
+    int unitRows = ranks << steps, unitCols = 1 << steps;
+    *m = (*m + unitRows - 1) / unitRows * unitRows;
+    *k = (*k + unitRows - 1) / unitRows * unitRows;
+    *n = (*n + unitCols - 1) / unitCols * unitCols;
+
+    int pm = *m, pk = *k, pn = *n;
+    size_t elems = ((size_t)pm * pk + (size_t)pk * pn + (size_t)pm * pn) / ranks;
+    for (int i = 0; i < steps; i++) {
+        elems += capsLevelElems(pm, pk, pn, ranks, schedule[i]);
+        pm /= 2;
+        pk /= 2;
+        pn /= 2;
+        if (schedule[i] == 'B') ranks /= 7;
+    }
+    return elems * sizeof(int) + strassenWorkspaceSizeRect(pm, pk, pn, cutoff);
+}
+
+/**
+ * One level of the distributed recursion, on the local parts of a rank
+ * @param run    State of the multiplication
+ * @param A      Local rows of A
+ * @param B      Local rows of B
+ * @param C      Local rows of C
+ * @param comm   Ranks sharing this level
+ * @param ranks  Size of comm
+ * @param step   Index of the level in the schedule
+ * @param ws     Arena for this level and the ones below it
+ */
+static void capsLevel(struct CapsRun* run, struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                      MPI_Comm comm, int ranks, int step, int* ws) {
+    char kind = run->schedule[step];
+
+    /* End of the schedule: the whole subproblem is local */
+    if (kind == '\0') {
+        strassenMul_hybrid_ws(A, B, C, run->cutoff, ws);
+        return;
+    }
+
+    int hmL = A->row / 2, hk = A->col / 2, hkL = B->row / 2, hn = B->col / 2;
+    size_t aBlock = (size_t)hmL * hk, bBlock = (size_t)hkL * hn, cBlock = (size_t)hmL * hn;
+    initMatrixZeros(C);
+
+    /* DFS: the 7 products one after the other, on all ranks */
+    if (kind == 'D') {
+        struct Matrix S = { ws, hmL, hk, hk };
+        struct Matrix T = { ws + aBlock, hkL, hn, hn };
+        struct Matrix Q = { ws + aBlock + bBlock, hmL, hn, hn };
+        int* next = ws + aBlock + bBlock + cBlock;
+        for (int p = 0; p < 7; p++) {
+            capsOperand(A, capsProducts[p].a, capsProducts[p].aSign, &S);
+            capsOperand(B, capsProducts[p].b, capsProducts[p].bSign, &T);
+            capsLevel(run, &S, &T, &Q, comm, ranks, step + 1, next);
+            capsAccumulate(&capsProducts[p], &Q, C);
+        }
+        return;
+    }
+
+    /*
+     * BFS: product p goes to the ranks group * sub .. group * sub + sub - 1
+     * with group = p. The 7 ranks with the same index in their group
+     * (one per group) exchange operands and products.
+     */
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    int sub = ranks / 7, group = rank / sub, member = rank % sub;
+    MPI_Comm cross, groupComm;
+    MPI_Comm_split(comm, member, group, &cross);
+    MPI_Comm_split(comm, group, member, &groupComm);
+
+    size_t block = aBlock + bBlock;
+    int* send = ws;
+    int* recv = send + 7 * block;
+    int* q = recv + 7 * block;
+    int* qSend = q + 7 * cBlock;
+    int* qRecv = qSend + 7 * cBlock;
+    int* next = qRecv + 7 * cBlock;
+
+    for (int p = 0; p < 7; p++) {
+        struct Matrix S = { send + p * block, hmL, hk, hk };
+        struct Matrix T = { send + p * block + aBlock, hkL, hn, hn };
+        capsOperand(A, capsProducts[p].a, capsProducts[p].aSign, &S);
+        capsOperand(B, capsProducts[p].b, capsProducts[p].bSign, &T);
+    }
+
+    double start = MPI_Wtime();
+    MPI_Alltoall(send, (int)block, MPI_INT, recv, (int)block, MPI_INT, cross);
+    run->commSeconds += MPI_Wtime() - start;
+    run->commBytes += 6 * (long long)block * sizeof(int);
+
+    /* Row j of the group's operands is row j / 7 of the block sent by cross rank j % 7 */
+    struct Matrix S = { send, 7 * hmL, hk, hk };
+    struct Matrix T = { send + 7 * aBlock, 7 * hkL, hn, hn };
+    struct Matrix Q = { q, 7 * hmL, hn, hn };
+    for (int j = 0; j < S.row; j++) {
+        memcpy(&matrixElem(S.matrix, j, 0, S.ld), recv + (j % 7) * block + (size_t)(j / 7) * hk,
+               sizeof(int) * hk);
+    }
+    for (int j = 0; j < T.row; j++) {
+        memcpy(&matrixElem(T.matrix, j, 0, T.ld), recv + (j % 7) * block + aBlock + (size_t)(j / 7) * hn,
+               sizeof(int) * hn);
+    }
+
+    capsLevel(run, &S, &T, &Q, groupComm, sub, step + 1, next);
+
+    /* Send every row of the product back to the rank that owns it */
+    for (int j = 0; j < Q.row; j++) {
+        memcpy(qSend + (j % 7) * cBlock + (size_t)(j / 7) * hn, &matrixElem(Q.matrix, j, 0, Q.ld),
+               sizeof(int) * hn);
+    }
+    start = MPI_Wtime();
+    MPI_Alltoall(qSend, (int)cBlock, MPI_INT, qRecv, (int)cBlock, MPI_INT, cross);
+    run->commSeconds += MPI_Wtime() - start;
+    run->commBytes += 6 * (long long)cBlock * sizeof(int);
+
+    for (int p = 0; p < 7; p++) {
+        struct Matrix P = { qRecv + p * cBlock, hmL, hn, hn };
+        capsAccumulate(&capsProducts[p], &P, C);
+    }
+
+    MPI_Comm_free(&cross);
+    MPI_Comm_free(&groupComm);
+}
+
+/**
+ * Packs the rows of a matrix owned by each rank, zero-padded, rank after rank
+ * @param X      Matrix on rank 0
+ * @param rows   Padded rows
+ * @param cols   Padded columns
+ * @param ranks  Number of ranks
+ * @param out    Receives ranks blocks of rows / ranks x cols ints
+ */
+static void capsPack(struct Matrix* X, int rows, int cols, int ranks, int* out) {
+    for (int i = 0; i < rows; i++) {
+        int* dst = out + ((size_t)(i % ranks) * (rows / ranks) + i / ranks) * cols;
+        int valid = i < X->row ? X->col : 0;
+        if (valid > 0) memcpy(dst, &matrixElem(X->matrix, i, 0, X->ld), sizeof(int) * valid);
+        memset(dst + valid, 0, sizeof(int) * (cols - valid));
+    }
+}
+
+/**
+ * Copies the gathered rows of C back into the unpadded result
+ * @param in     ranks blocks of rows / ranks x cols ints
+ * @param rows   Padded rows
+ * @param cols   Padded columns
+ * @param ranks  Number of ranks
+ * @param X      Result on rank 0
+ */
+static void capsUnpack(const int* in, int rows, int cols, int ranks, struct Matrix* X) {
+    for (int i = 0; i < X->row; i++) {
+        const int* src = in + ((size_t)(i % ranks) * (rows / ranks) + i / ranks) * cols;
+        memcpy(&matrixElem(X->matrix, i, 0, X->ld), src, sizeof(int) * X->col);
+    }
+}
+
+/**
+ * Multiplies A (m x k) by B (k x n) on the ranks of a communicator
+ * @param A              First operand (rank 0)
+ * @param B              Second operand (rank 0)
+ * @param C              Result (rank 0)
+ * @param cutoff         Size threshold of the local hybrid engine, or CUTOFF_AUTO
+ * @param memoryLimit    Memory limit per rank in bytes, 0 for no limit
+ * @param comm           Communicator of the ranks
+ * @param report         Receives the schedule and statistics (may be NULL)
+ * @return               0 on success, -1 if a rank cannot allocate its buffers
+ */
+int strassenMul_caps(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                     size_t memoryLimit, MPI_Comm comm, struct CapsReport* report) {
+    int size, rank;
+    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm, &rank);
+
+    /* Dimensions and cutoff of rank 0 */
+    int params[4] = { 0, 0, 0, cutoff };
+    if (rank == 0) {
+        params[0] = A->row;
+        params[1] = A->col;
+        params[2] = B->col;
+        if (cutoff == CUTOFF_AUTO) {
+            int largest = params[0] > params[1] ? params[0] : params[1];
+            params[3] = profileCutoff(largest > params[2] ? largest : params[2]);
+        }
+    }
+    MPI_Bcast(params, 4, MPI_INT, 0, comm);
+    int m = params[0], k = params[1], n = params[2];
+    cutoff = params[3] < 1 ? 1 : params[3];
+
+    struct CapsReport local;
+    memset(&local, 0, sizeof(local));
+    local.ranks = 1;
+    while (local.ranks * 7 <= size) {
+        local.ranks *= 7;
+        local.bfsSteps++;
+    }
+    int ranks = local.ranks;
+
+    /*
+     * Fewest DFS steps that fit the limit, else the schedule with the least
+     * memory; steps that would take the leaves below the cutoff only add padding
+     */
+    int smallest = m < k ? (m < n ? m : n) : (k < n ? k : n);
+    size_t best = 0;
+    for (int dfs = 0; dfs + local.bfsSteps <= CAPS_MAX_STEPS; dfs++) {
+        char schedule[CAPS_MAX_STEPS + 1];
+        memset(schedule, 'D', dfs);
+        memset(schedule + dfs, 'B', local.bfsSteps);
+        schedule[dfs + local.bfsSteps] = '\0';
+        int pm = m, pk = k, pn = n;
+        size_t bytes = capsPlan(&pm, &pk, &pn, ranks, cutoff, schedule);
+        if (dfs == 0 || bytes < best) {
+            best = bytes;
+            local.dfsSteps = dfs;
+            memcpy(local.schedule, schedule, sizeof(schedule));
+        }
+        if (memoryLimit == 0 || bytes <= memoryLimit || (smallest >> (dfs + local.bfsSteps)) <= cutoff) break;
+    }
+    local.paddedM = m;
+    local.paddedK = k;
+    local.paddedN = n;
+    local.memoryBytes = capsPlan(&local.paddedM, &local.paddedK, &local.paddedN, ranks, cutoff, local.schedule);
+
+    int pm = local.paddedM, pk = local.paddedK, pn = local.paddedN;
+    size_t la = (size_t)pm / ranks * pk, lb = (size_t)pk / ranks * pn, lc = (size_t)pm / ranks * pn;
+
+    /* Ranks beyond the largest power of 7 only join the final reductions */
+    MPI_Comm work;
+    MPI_Comm_split(comm, rank < ranks ? 0 : MPI_UNDEFINED, rank, &work);
+
+    int* arena = NULL;
+    int* pack = NULL;
+    int ok = 1;
+    if (rank < ranks) {
+        arena = malloc(local.memoryBytes > 0 ? local.memoryBytes : 1);
+        ok = arena != NULL;
+    }
+    if (rank == 0) {
+        size_t packElems = (size_t)pm * pk + (size_t)pk * pn;
+        if ((size_t)pm * pn > packElems) packElems = (size_t)pm * pn;
+        pack = malloc(packElems > 0 ? packElems * sizeof(int) : 1);
+        ok = ok && pack != NULL;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, comm);
+    if (!ok) {
+        free(arena);
+        free(pack);
+        if (work != MPI_COMM_NULL) MPI_Comm_free(&work);
+        return -1;
+    }
+
+    struct CapsRun run = { cutoff, local.schedule, 0, 0.0 };
+    double seconds = 0.0;
+    if (work != MPI_COMM_NULL) {
+        struct Matrix localA = { arena, pm / ranks, pk, pk };
+        struct Matrix localB = { arena + la, pk / ranks, pn, pn };
+        struct Matrix localC = { arena + la + lb, pm / ranks, pn, pn };
+
+        if (rank == 0) {
+            capsPack(A, pm, pk, ranks, pack);
+            capsPack(B, pk, pn, ranks, pack + (size_t)pm * pk);
+        }
+        MPI_Barrier(work);
+        double start = MPI_Wtime();
+        MPI_Scatter(pack, (int)la, MPI_INT, localA.matrix, (int)la, MPI_INT, 0, work);
+        MPI_Scatter(pack + (size_t)pm * pk, (int)lb, MPI_INT, localB.matrix, (int)lb, MPI_INT, 0, work);
+
+        capsLevel(&run, &localA, &localB, &localC, work, ranks, 0, arena + la + lb + lc);
+
+        MPI_Gather(localC.matrix, (int)lc, MPI_INT, pack, (int)lc, MPI_INT, 0, work);
+        seconds = MPI_Wtime() - start;
+        if (rank == 0) capsUnpack(pack, pm, pn, ranks, C);
+        MPI_Comm_free(&work);
+    }
+    free(arena);
+    free(pack);
+
+    /* Collective on every rank, whether or not it asked for the report */
+    local.distributeBytes = (long long)(ranks - 1) * (la + lb + lc) * sizeof(int);
+    MPI_Allreduce(&run.commBytes, &local.commBytes, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    MPI_Allreduce(&run.commBytes, &local.maxRankCommBytes, 1, MPI_LONG_LONG, MPI_MAX, comm);
+    MPI_Allreduce(&run.commSeconds, &local.commSeconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(&seconds, &local.seconds, 1, MPI_DOUBLE, MPI_MAX, comm);
+    if (report != NULL) *report = local;
+    return 0;
+}
+
+/**
+ * Prints a distributed run as one CSV header and line
+ * @param out        Output stream
+ * @param report     Statistics returned by strassenMul_caps
+ */
+void printCapsReport(FILE* out, const struct CapsReport* report) {
+    fprintf(out, "ranks,schedule,padded,memory_bytes,comm_bytes,max_rank_comm_bytes,distribute_bytes,"
+                 "seconds,comm_seconds\n");
+    fprintf(out, "%d,%s,%dx%dx%d,%zu,%lld,%lld,%lld,%f,%f\n", report->ranks,
+            report->schedule[0] != '\0' ? report->schedule : "-", report->paddedM, report->paddedK,
+            report->paddedN, report->memoryBytes, report->commBytes, report->maxRankCommBytes,
+            report->distributeBytes, report->seconds, report->commSeconds);
+}
+
+#endif /* MATRIX_MPI */
@@ -0,0 +1,84 @@
+#ifndef distributed_H_
+#define distributed_H_
+
+#include <stdio.h>
+#include <mpi.h>
+#include "matrix.h"
+
+/*********************************************
+ * Distributed Strassen (CAPS schedule)
+ *
+ * Communication-avoiding parallel Strassen (Ballard, Demmel, Holtz,
+ * Lipshitz, Schwartz, SPAA 2012) over MPI. Build with mpicc and
+ * -DMATRIX_MPI; without the flag distributed.c compiles to nothing.
+ *
+ * The operands are distributed row-cyclically over P = 7^l ranks: rank
+ * r holds rows r, r + P, r + 2P, ... of A, B and C as a local matrix.
+ * With the padded dimensions used by the engine, the quadrants of a
+ * local matrix are the local parts of the global quadrants. So the
+ * operand sums of a level need no communication.
+ *
+ *   BFS step   every rank forms its share of the 7 operand pairs. One
+ *              all-to-all among 7 ranks (one per group) hands pair i to
+ *              the P/7 ranks of group i, still row-cyclic. The groups
+ *              recurse in parallel, and a second all-to-all returns the
+ *              products for the local update of C.
+ *   DFS step   all P ranks run the 7 products one after the other on
+ *              their local parts, with no communication and only the
+ *              temporaries of one product.
+ *
+ * As in CAPS, the schedule takes the fewest DFS steps (first) that
+ * keep the planned memory per rank within the limit, then l BFS steps.
+ * Each rank then holds a whole subproblem and calls strassenMul_hybrid.
+ * Extra ranks beyond the largest power of 7 stay idle. Results are
+ * identical to strassenMul_hybrid.
+ *********************************************/
+
+#define CAPS_MAX_STEPS 32
+
+/**
+ * Schedule and statistics of a distributed multiplication
+ * The same values are returned on every rank of the communicator
+ */
+struct CapsReport {
+    int ranks;                  /* Ranks that took part (a power of 7) */
+    int bfsSteps;               /* Levels split across rank groups */
+    int dfsSteps;               /* Levels run by all ranks in sequence */
+    char schedule[CAPS_MAX_STEPS + 1];  /* Steps from the top, e.g. "DBB" */
+    int paddedM;                /* Dimensions after padding for the distribution */
+    int paddedK;
+    int paddedN;
+    size_t memoryBytes;         /* Planned peak memory per rank */
+    long long commBytes;        /* Bytes sent between ranks by the BFS steps, all ranks */
+    long long maxRankCommBytes; /* Largest share of commBytes sent by one rank */
+    long long distributeBytes;  /* Bytes of the scatter of A, B and the gather of C */
+    double seconds;             /* Wall time from scatter to gather */
+    double commSeconds;         /* Longest time a rank spent in the BFS all-to-alls */
+};
+
+/**
+ * Multiplies A (m x k) by B (k x n) on the ranks of a communicator
+ * Collective: every rank of comm must call it. The matrices are only
+ * read and written on rank 0, the other ranks may pass NULL
+ *
+ * @param A              First operand (rank 0)
+ * @param B              Second operand (rank 0)
+ * @param C              Result (rank 0)
+ * @param cutoff         Size threshold of the local hybrid engine, or CUTOFF_AUTO
+ * @param memoryLimit    Memory limit per rank in bytes for choosing DFS steps, 0 for no limit
+ * @param comm           Communicator of the ranks
+ * @param report         Receives the schedule and statistics (may be NULL)
+ * @return               0 on success, -1 on any rank if a rank cannot allocate its buffers
+ */
+int strassenMul_caps(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                     size_t memoryLimit, MPI_Comm comm, struct CapsReport* report);
+
+/**
+ * Prints a distributed run as a CSV header and one line
+ *
+ * @param out        Output stream
+ * @param report     Statistics returned by strassenMul_caps
+ */
+void printCapsReport(FILE* out, const struct CapsReport* report);
+
+#endif /* distributed_H_ */
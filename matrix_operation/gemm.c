@@ -0,0 +1,211 @@
+#include <stdlib.h>
+#include "matrix.h"
+#include "trace.h"
+
+/******************************************
+ * Cache-blocked, packed matrix multiplication
+ *
+ * The loop nest follows the classic GotoBLAS/BLIS structure:
+ *
+ *   for jc in steps of NC        (B panel of KC x NC kept in L3)
+ *     for pc in steps of KC      (pack B[pc:pc+KC][jc:jc+NC])
+ *       for ic in steps of MC    (pack A[ic:ic+MC][pc:pc+KC], kept in L2)
+ *         for jr in steps of NR  (KC x NR sliver of packed B, kept in L1)
+ *           for ir in steps of MR
+ *             MR x NR micro-kernel, accumulators held in registers
+ *
+ * Packed panels are stored sliver by sliver: an MR-row sliver of A is
+ * stored column after column (MR contiguous elements per k), an NR-column
+ * sliver of B row after row (NR contiguous elements per k). Slivers at the
+ * matrix edges are zero padded, so the micro-kernel always runs on full
+ * MR x NR tiles and only the store back to C is clipped.
+ *******************************************/
+
+/**
+ * Rounds n up to the next multiple of m
+ * @param n     Value to round
+ * @param m     Granularity
+ * @return      Smallest multiple of m that is >= n
+ */
+static int roundUp(int n, int m) {
+    return (n + m - 1) / m * m;
+}
+
+/**
+ * Returns the smaller of two integers
+ * @param a     First value
+ * @param b     Second value
+ * @return      min(a, b)
+ */
+static int minInt(int a, int b) {
+    return a < b ? a : b;
+}
+
+/**
+ * Packs the mc x kc block of A starting at (row, col) into MR-row slivers
+ * @param A      Source matrix
+ * @param row    Starting row of the block
+ * @param col    Starting column of the block
+ * @param mc     Number of rows of the block
+ * @param kc     Number of columns of the block
+ * @param Ap     Destination buffer of roundUp(mc, MR) * kc elements
+ */
+static void packA(struct Matrix* A, int row, int col, int mc, int kc, int* Ap) {
+    for (int ir = 0; ir < mc; ir += GEMM_MR) {
+        int mr = minInt(GEMM_MR, mc - ir);
+        for (int k = 0; k < kc; k++) {
+            for (int r = 0; r < GEMM_MR; r++) {
+                /* Rows past the edge of A are padded with zeros */
+                *Ap++ = r < mr ? matrixElem(A->matrix, row + ir + r, col + k, A->ld) : 0;
+            }
+        }
+    }
+}
+
+/**
+ * Packs the kc x nc block of B starting at (row, col) into NR-column slivers
+ * @param B      Source matrix
+ * @param row    Starting row of the block
+ * @param col    Starting column of the block
+ * @param kc     Number of rows of the block
+ * @param nc     Number of columns of the block
+ * @param Bp     Destination buffer of kc * roundUp(nc, NR) elements
+ */
+static void packB(struct Matrix* B, int row, int col, int kc, int nc, int* Bp) {
+    for (int jr = 0; jr < nc; jr += GEMM_NR) {
+        int nr = minInt(GEMM_NR, nc - jr);
+        for (int k = 0; k < kc; k++) {
+            const int* src = &matrixElem(B->matrix, row + k, col + jr, B->ld);
+            for (int c = 0; c < GEMM_NR; c++) {
+                /* Columns past the edge of B are padded with zeros */
+                *Bp++ = c < nr ? src[c] : 0;
+            }
+        }
+    }
+}
+
+/**
+ * MR x NR register-tiled micro-kernel
+ * Computes the product of one packed A sliver and one packed B sliver
+ * and stores (first == 1) or accumulates (first == 0) the mr x nr
+ * valid part of the tile into C
+ *
+ * @param kc     Depth of the slivers
+ * @param Ap     Packed A sliver (kc groups of MR elements)
+ * @param Bp     Packed B sliver (kc groups of NR elements)
+ * @param C      First element of the destination tile
+ * @param ldc    Leading dimension of C
+ * @param mr     Valid rows of the tile
+ * @param nr     Valid columns of the tile
+ * @param first  Non-zero if this is the first KC block (overwrite C)
+ */
+static void microKernel(int kc, const int* restrict Ap, const int* restrict Bp,
+                        int* restrict C, int ldc, int mr, int nr, int first) {
+    int acc[GEMM_MR][GEMM_NR] = {{0}};
+
+    for (int k = 0; k < kc; k++) {
+        for (int r = 0; r < GEMM_MR; r++) {
+            int a = Ap[r];
+            for (int c = 0; c < GEMM_NR; c++) {
+                acc[r][c] += a * Bp[c];
+            }
+        }
+        Ap += GEMM_MR;
+        Bp += GEMM_NR;
+    }
+
+    for (int r = 0; r < mr; r++) {
+        for (int c = 0; c < nr; c++) {
+            if (first) {
+                C[r * ldc + c] = acc[r][c];
+            } else {
+                C[r * ldc + c] += acc[r][c];
+            }
+        }
+    }
+}
+
+/**
+ * Returns the number of bytes of packing buffers needed by mulBlocked_ws
+ * @param m     Rows of A and C
+ * @param n     Columns of B and C
+ * @param k     Columns of A / rows of B
+ * @return      Size of the packing buffers in bytes
+ */
+size_t gemmPackSize(int m, int n, int k) {
+    size_t kc = minInt(k, GEMM_KC);
+    size_t aElems = (size_t)roundUp(minInt(m, GEMM_MC), GEMM_MR) * kc;
+    size_t bElems = kc * (size_t)roundUp(minInt(n, GEMM_NC), GEMM_NR);
+    return (aElems + bElems) * sizeof(int);
+}
+
+/**
+ * Blocked, packed matrix multiplication on caller-supplied packing buffers
+ * Computes C = A * B
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param workspace  Buffer of at least gemmPackSize(A->row, B->col, A->col) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* mulBlocked_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C, void* workspace) {
+    /* Empty inner dimension: the product is the zero matrix */
+    if (A->col == 0) {
+        initMatrixZeros(C);
+        return C;
+    }
+
+    TRACE_BEGIN(traceStart);
+    int m = A->row;
+    int n = B->col;
+    int k = A->col;
+    int* Ap = workspace;
+    int* Bp = Ap + (size_t)roundUp(minInt(m, GEMM_MC), GEMM_MR) * minInt(k, GEMM_KC);
+
+    for (int jc = 0; jc < n; jc += GEMM_NC) {
+        int nc = minInt(GEMM_NC, n - jc);
+
+        for (int pc = 0; pc < k; pc += GEMM_KC) {
+            int kc = minInt(GEMM_KC, k - pc);
+            packB(B, pc, jc, kc, nc, Bp);
+
+            for (int ic = 0; ic < m; ic += GEMM_MC) {
+                int mc = minInt(GEMM_MC, m - ic);
+                packA(A, ic, pc, mc, kc, Ap);
+
+                for (int jr = 0; jr < nc; jr += GEMM_NR) {
+                    for (int ir = 0; ir < mc; ir += GEMM_MR) {
+                        microKernel(kc, Ap + (size_t)ir * kc, Bp + (size_t)jr * kc,
+                                    &matrixElem(C->matrix, ic + ir, jc + jr, C->ld), C->ld,
+                                    minInt(GEMM_MR, mc - ir), minInt(GEMM_NR, nc - jr),
+                                    pc == 0);
+                    }
+                }
+            }
+        }
+    }
+
+    TRACE_END(traceStart, "mulBlocked", m, n);
+    return C;
+}
+
+/**
+ * Blocked, packed matrix multiplication
+ * Computes C = A * B, allocating the packing buffers for the call
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @return       Pointer to the result matrix C, NULL if the packing
+ *               buffers cannot be allocated
+ */
+struct Matrix* mulBlocked(struct Matrix* A, struct Matrix* B, struct Matrix* C) {
+    void* workspace = malloc(gemmPackSize(A->row, B->col, A->col) + 1);
+    if (workspace == NULL) return NULL;
+
+    mulBlocked_ws(A, B, C, workspace);
+
+    free(workspace);
+    return C;
+}
@@ -3,6 +3,9 @@
 #include <math.h>
 #include <time.h>
 #include "matrix.h"
+#include "simd.h"
+#include "counters.h"
+#include "trace.h"
 
 /* Maximum random value for matrix elements when filling matrices with random values */
 #define MaxRandVal 9
@@ -20,9 +23,43 @@ struct Matrix allocMatrix(int side) {
     mat.matrix = malloc(sizeof(int) * side * side);  /* Allocate memory for matrix elements */
     mat.row = side;
     mat.col = side;
+    mat.ld = side;
     return mat;
 }
 
+/**
+ * Allocates memory for a rectangular matrix
+ * @param rows  Number of rows
+ * @param cols  Number of columns
+ * @return      Matrix struct with allocated memory
+ */
+struct Matrix allocMatrixRect(int rows, int cols) {
+    struct Matrix mat;
+    mat.matrix = malloc(sizeof(int) * rows * cols);
+    mat.row = rows;
+    mat.col = cols;
+    mat.ld = cols;
+    return mat;
+}
+
+/**
+ * Creates a view on a block of a matrix without copying it
+ * @param mat   Matrix (or view) containing the block
+ * @param row   Starting row of the block
+ * @param col   Starting column of the block
+ * @param rows  Number of rows of the block
+ * @param cols  Number of columns of the block
+ * @return      View sharing the data of mat
+ */
+struct Matrix matrixView(struct Matrix* mat, int row, int col, int rows, int cols) {
+    struct Matrix view;
+    view.matrix = &matrixElem(mat->matrix, row, col, mat->ld);
+    view.row = rows;
+    view.col = cols;
+    view.ld = mat->ld;    /* Rows of the block are still one parent row apart */
+    return view;
+}
+
 /** 
  * Frees the memory allocated for a matrix
  * @param mat   Matrix to free
@@ -34,6 +71,7 @@ void freeMatrix(struct Matrix* mat) {
     }
     mat->row = 0;                 /* Reset dimensions */
     mat->col = 0;
+    mat->ld = 0;
 }
 
 /**
@@ -44,7 +82,7 @@ void fillMatrixRand(struct Matrix* mat) {
     for (int i = 0; i < mat->row; i++) {
         for (int j = 0; j < mat->col; j++) {
             /* Use macro to access elements in the 1D array as if it were 2D */
-            matrixElem(mat->matrix, i, j, mat->col) = rand() % (MaxRandVal + 1);
+            matrixElem(mat->matrix, i, j, mat->ld) = rand() % (MaxRandVal + 1);
         }
     }
 }
@@ -55,9 +93,7 @@ void fillMatrixRand(struct Matrix* mat) {
  */
 void initMatrixZeros(struct Matrix* mat) {
     for (int i = 0; i < mat->row; i++) {
-        for (int j = 0; j < mat->col; j++) {
-            matrixElem(mat->matrix, i, j, mat->col) = 0;
-        }
+        rowKernels.zero(&matrixElem(mat->matrix, i, 0, mat->ld), mat->col);
     }
 }
 
@@ -69,7 +105,7 @@ void initMatrixZeros(struct Matrix* mat) {
 void printMatrix(struct Matrix* mat) {
     for (int i = 0; i < mat->row; i++) {
         for (int j = 0; j < mat->col; j++) {
-            printf("(%d,%d): %4d  ", i, j, matrixElem(mat->matrix, i, j, mat->col));
+            printf("(%d,%d): %4d  ", i, j, matrixElem(mat->matrix, i, j, mat->ld));
         }
         printf("\n");
     }
@@ -93,6 +129,7 @@ int nextPowerOfTwo(int n) {
 /**********************************************
  * Helper functions for matrix operations
  * These functions operate on submatrices (blocks) of larger matrices
+ * Each row of a block is processed by the SIMD row kernels (simd.c)
  **********************************************/
 
 /**
@@ -117,15 +154,7 @@ int sumMatrix(struct Matrix* A, int rowA, int colA,
               struct Matrix* B, int rowB, int colB,
               struct Matrix* C, int rowC, int colC,
               int blockSize) {
-    for (int i = 0; i < blockSize; i++) {
-        for (int j = 0; j < blockSize; j++) {
-            /* Addition of corresponding elements from A and B, storing in C */
-            matrixElem(C->matrix, i + rowC, j + colC, C->col) =
-                matrixElem(A->matrix, i + rowA, j + colA, A->col) +
-                matrixElem(B->matrix, i + rowB, j + colB, B->col);
-        }
-    }
-    return 0;
+    return sumMatrixRect(A, rowA, colA, B, rowB, colB, C, rowC, colC, blockSize, blockSize);
 }
 
 /**
@@ -150,15 +179,7 @@ int subMatrix(struct Matrix* A, int rowA, int colA,
               struct Matrix* B, int rowB, int colB,
               struct Matrix* C, int rowC, int colC,
               int blockSize) {
-    for (int i = 0; i < blockSize; i++) {
-        for (int j = 0; j < blockSize; j++) {
-            /* Subtraction of B from A, storing in C */
-            matrixElem(C->matrix, i + rowC, j + colC, C->col) =
-                matrixElem(A->matrix, i + rowA, j + colA, A->col) -
-                matrixElem(B->matrix, i + rowB, j + colB, B->col);
-        }
-    }
-    return 0;
+    return subMatrixRect(A, rowA, colA, B, rowB, colB, C, rowC, colC, blockSize, blockSize);
 }
 
 /**
@@ -174,14 +195,7 @@ int subMatrix(struct Matrix* A, int rowA, int colA,
  * @return           0 on success
  */
 int addSubmatrix(struct Matrix* A, struct Matrix* B, int rowB, int colB, int blockSize) {
-    for (int i = 0; i < blockSize; i++) {
-        for (int j = 0; j < blockSize; j++) {
-            /* Add values from A to B in-place */
-            matrixElem(B->matrix, i + rowB, j + colB, B->col) += 
-                matrixElem(A->matrix, i, j, A->col);
-        }
-    }
-    return 0;
+    return addSubmatrixRect(A, B, rowB, colB, blockSize, blockSize);
 }
 
 /**
@@ -197,14 +211,7 @@ int addSubmatrix(struct Matrix* A, struct Matrix* B, int rowB, int colB, int blo
  * @return           0 on success
  */
 int subSubmatrix(struct Matrix* A, struct Matrix* B, int rowB, int colB, int blockSize) {
-    for (int i = 0; i < blockSize; i++) {
-        for (int j = 0; j < blockSize; j++) {
-            /* Subtract values from A from B in-place */
-            matrixElem(B->matrix, i + rowB, j + colB, B->col) -= 
-                matrixElem(A->matrix, i, j, A->col);
-        }
-    }
-    return 0;
+    return subSubmatrixRect(A, B, rowB, colB, blockSize, blockSize);
 }
 
 /**
@@ -224,13 +231,202 @@ int subSubmatrix(struct Matrix* A, struct Matrix* B, int rowB, int colB, int blo
 int copySubmatrix(struct Matrix* A, int rowA, int colA,
                   struct Matrix* C, int rowC, int colC,
                   int blockSize) {
-    for (int i = 0; i < blockSize; i++) {
-        for (int j = 0; j < blockSize; j++) {
-            /* Copy values from A to C */
-            matrixElem(C->matrix, i + rowC, j + colC, C->col) = 
-                matrixElem(A->matrix, i + rowA, j + colA, A->col);
+    return copySubmatrixRect(A, rowA, colA, C, rowC, colC, blockSize, blockSize);
+}
+
+/**
+ * Adds two rows x cols blocks of A and B and stores the result in C
+ * Rectangular version of sumMatrix
+ *
+ * @param A          First source matrix
+ * @param rowA       Starting row in A
+ * @param colA       Starting column in A
+ * @param B          Second source matrix
+ * @param rowB       Starting row in B
+ * @param colB       Starting column in B
+ * @param C          Destination matrix
+ * @param rowC       Starting row in C
+ * @param colC       Starting column in C
+ * @param rows       Number of rows of the blocks
+ * @param cols       Number of columns of the blocks
+ * @return           0 on success
+ */
+int sumMatrixRect(struct Matrix* A, int rowA, int colA,
+                  struct Matrix* B, int rowB, int colB,
+                  struct Matrix* C, int rowC, int colC,
+                  int rows, int cols) {
+    TRACE_BEGIN(traceStart);
+    for (int i = 0; i < rows; i++) {
+        /* Addition of corresponding rows from A and B, storing in C */
+        rowKernels.add(&matrixElem(C->matrix, i + rowC, colC, C->ld),
+                       &matrixElem(A->matrix, i + rowA, colA, A->ld),
+                       &matrixElem(B->matrix, i + rowB, colB, B->ld), cols);
+    }
+    TRACE_END(traceStart, "sumMatrixRect", rows, cols);
+    return 0;
+}
+
+/**
+ * Subtracts a rows x cols block of B from one of A and stores the result in C
+ * Rectangular version of subMatrix
+ *
+ * @param A          First source matrix
+ * @param rowA       Starting row in A
+ * @param colA       Starting column in A
+ * @param B          Second source matrix
+ * @param rowB       Starting row in B
+ * @param colB       Starting column in B
+ * @param C          Destination matrix
+ * @param rowC       Starting row in C
+ * @param colC       Starting column in C
+ * @param rows       Number of rows of the blocks
+ * @param cols       Number of columns of the blocks
+ * @return           0 on success
+ */
+int subMatrixRect(struct Matrix* A, int rowA, int colA,
+                  struct Matrix* B, int rowB, int colB,
+                  struct Matrix* C, int rowC, int colC,
+                  int rows, int cols) {
+    TRACE_BEGIN(traceStart);
+    for (int i = 0; i < rows; i++) {
+        /* Subtraction of the rows of B from A, storing in C */
+        rowKernels.sub(&matrixElem(C->matrix, i + rowC, colC, C->ld),
+                       &matrixElem(A->matrix, i + rowA, colA, A->ld),
+                       &matrixElem(B->matrix, i + rowB, colB, B->ld), cols);
+    }
+    TRACE_END(traceStart, "subMatrixRect", rows, cols);
+    return 0;
+}
+
+/**
+ * Adds the leading rows x cols block of A to a block of B (in-place)
+ * Rectangular version of addSubmatrix
+ *
+ * @param A          Source matrix
+ * @param B          Destination matrix (modified in-place)
+ * @param rowB       Starting row in B
+ * @param colB       Starting column in B
+ * @param rows       Number of rows of the block
+ * @param cols       Number of columns of the block
+ * @return           0 on success
+ */
+int addSubmatrixRect(struct Matrix* A, struct Matrix* B, int rowB, int colB, int rows, int cols) {
+    TRACE_BEGIN(traceStart);
+    for (int i = 0; i < rows; i++) {
+        /* Add the rows of A to B in-place */
+        rowKernels.addInPlace(&matrixElem(B->matrix, i + rowB, colB, B->ld),
+                              &matrixElem(A->matrix, i, 0, A->ld), cols);
+    }
+    TRACE_END(traceStart, "addSubmatrixRect", rows, cols);
+    return 0;
+}
+
+/**
+ * Subtracts the leading rows x cols block of A from a block of B (in-place)
+ * Rectangular version of subSubmatrix
+ *
+ * @param A          Source matrix
+ * @param B          Destination matrix (modified in-place)
+ * @param rowB       Starting row in B
+ * @param colB       Starting column in B
+ * @param rows       Number of rows of the block
+ * @param cols       Number of columns of the block
+ * @return           0 on success
+ */
+int subSubmatrixRect(struct Matrix* A, struct Matrix* B, int rowB, int colB, int rows, int cols) {
+    TRACE_BEGIN(traceStart);
+    for (int i = 0; i < rows; i++) {
+        /* Subtract the rows of A from B in-place */
+        rowKernels.subInPlace(&matrixElem(B->matrix, i + rowB, colB, B->ld),
+                              &matrixElem(A->matrix, i, 0, A->ld), cols);
+    }
+    TRACE_END(traceStart, "subSubmatrixRect", rows, cols);
+    return 0;
+}
+
+/**
+ * Copies a rows x cols block from A to C
+ * Rectangular version of copySubmatrix
+ *
+ * @param A          Source matrix
+ * @param rowA       Starting row in A
+ * @param colA       Starting column in A
+ * @param C          Destination matrix
+ * @param rowC       Starting row in C
+ * @param colC       Starting column in C
+ * @param rows       Number of rows of the block
+ * @param cols       Number of columns of the block
+ * @return           0 on success
+ */
+int copySubmatrixRect(struct Matrix* A, int rowA, int colA,
+                      struct Matrix* C, int rowC, int colC,
+                      int rows, int cols) {
+    TRACE_BEGIN(traceStart);
+    for (int i = 0; i < rows; i++) {
+        /* Copy the rows of A to C */
+        rowKernels.copy(&matrixElem(C->matrix, i + rowC, colC, C->ld),
+                        &matrixElem(A->matrix, i + rowA, colA, A->ld), cols);
+    }
+    TRACE_END(traceStart, "copySubmatrixRect", rows, cols);
+    return 0;
+}
+
+/**
+ * Completes C = A * B after dynamic peeling of the odd dimensions
+ * With A m x k and B k x n, let m', k' and n' be m, k and n rounded down
+ * to even. The block C[0:m'][0:n'] must already hold
+ * A[0:m'][0:k'] * B[0:k'][0:n']. Adds the rank-1 contribution of the
+ * last column of A and the last row of B when k is odd, then computes
+ * the last column of C when n is odd and the last row when m is odd.
+ *
+ * @param A      First input matrix (m x k)
+ * @param B      Second input matrix (k x n)
+ * @param C      Output matrix (m x n)
+ * @return       0 on success
+ */
+int peelUpdate(struct Matrix* A, struct Matrix* B, struct Matrix* C) {
+    TRACE_BEGIN(traceStart);
+    int m = A->row, k = A->col, n = B->col;
+    int evenM = m & ~1, evenK = k & ~1, evenN = n & ~1;
+
+    /* Odd k: C11 += a12 * b21 */
+    if (evenK != k) {
+        int* b = &matrixElem(B->matrix, k - 1, 0, B->ld);
+        for (int i = 0; i < evenM; i++) {
+            int a = matrixElem(A->matrix, i, k - 1, A->ld);
+            int* c = &matrixElem(C->matrix, i, 0, C->ld);
+            for (int j = 0; j < evenN; j++) {
+                c[j] += a * b[j];
+            }
+        }
+    }
+
+    /* Odd n: last column, c12 = A1* * b*2 */
+    if (evenN != n) {
+        for (int i = 0; i < evenM; i++) {
+            int sum = 0;
+            for (int l = 0; l < k; l++) {
+                sum += matrixElem(A->matrix, i, l, A->ld) * matrixElem(B->matrix, l, n - 1, B->ld);
+            }
+            matrixElem(C->matrix, i, n - 1, C->ld) = sum;
+        }
+    }
+
+    /* Odd m: last row, c2* = a2* * B, accumulated row by row of B */
+    if (evenM != m) {
+        int* c = &matrixElem(C->matrix, m - 1, 0, C->ld);
+        for (int j = 0; j < n; j++) {
+            c[j] = 0;
+        }
+        for (int l = 0; l < k; l++) {
+            int a = matrixElem(A->matrix, m - 1, l, A->ld);
+            int* b = &matrixElem(B->matrix, l, 0, B->ld);
+            for (int j = 0; j < n; j++) {
+                c[j] += a * b[j];
+            }
         }
     }
+    TRACE_END(traceStart, "peelUpdate", m, n);
     return 0;
 }
 
@@ -244,20 +440,22 @@ int copySubmatrix(struct Matrix* A, int rowA, int colA,
  * @return       Pointer to the result matrix C
  */
 struct Matrix* mul(struct Matrix* A, struct Matrix* B, struct Matrix* C){
+    TRACE_BEGIN(traceStart);
     /* For each element in the result matrix */
     for(int i = 0; i < A->row; i++){
-        for(int j = 0; j < A->col; j++){
+        for(int j = 0; j < B->col; j++){
             /* Initialize with first multiplication */
-            matrixElem(C->matrix, i, j, C->row) = matrixElem(A->matrix, i, 0, A->row) * matrixElem(B->matrix, 0, j, B->row);
+            matrixElem(C->matrix, i, j, C->ld) = matrixElem(A->matrix, i, 0, A->ld) * matrixElem(B->matrix, 0, j, B->ld);
             
             /* Add remaining products for this cell */
-            for(int k = 1; k < A->row; k++){
-                matrixElem(C->matrix, i, j, C->row) = matrixElem(C->matrix, i, j, C->row) + 
-                    matrixElem(A->matrix, i, k, A->row) * matrixElem(B->matrix, k, j, B->row);
+            for(int k = 1; k < A->col; k++){
+                matrixElem(C->matrix, i, j, C->ld) = matrixElem(C->matrix, i, j, C->ld) + 
+                    matrixElem(A->matrix, i, k, A->ld) * matrixElem(B->matrix, k, j, B->ld);
             }    
         }
     }
     
+    TRACE_END(traceStart, "mul", A->row, B->col);
     return C;
 }    
 
@@ -282,222 +480,946 @@ struct Matrix* mul(struct Matrix* A, struct Matrix* B, struct Matrix* C){
  * C21 = P6 + P7
  * C22 = P2 − P3 + P5 − P7
  *
- * This algorithm works with squared matrices 
+ * A is m x k and B is k x n, with any m, k, n: odd dimensions are
+ * peeled (see peelUpdate), so no padding to a power of two is needed.
+ * When the largest dimension is at least twice the smallest, a level
+ * halves only that dimension (two half products) instead of applying
+ * Strassen's formulas to a very flat or very thin block.
+ *
+ * The three temporaries of every recursion level are not allocated
+ * on the heap: they are sliced from a single workspace arena.
+ * Level d (top level is d = 0, side n) uses the 3 * (n/2^(d+1))^2
+ * elements that follow the ones used by level d-1, so the arena is
+ * laid out as [temp1 temp2 P | temp1 temp2 P | ...] from the top
+ * level down to the last level above the cutoff.
+ *
+ * Quadrants of A, B and C are never copied: operands that are a single
+ * quadrant (A11 in P5, A22 in P6, B22 in P4, B11 in P7) are passed to
+ * the recursion as views, and P1, P4 and P6 are written directly into
+ * the C quadrant they initialize.
  *********************************************/
 
+/* Kernel used by the hybrid engine below the cutoff */
+static enum LeafKernel hybridLeaf = LEAF_NAIVE;
+
 /**
- * Performs Strassen's matrix multiplication algorithm
- * Computes C = A * B with time complexity O(n^log₂7) ≈ O(n^2.81)
+ * Selects the kernel used by strassenMul_hybrid below the cutoff
+ * @param leaf   Leaf kernel
+ */
+void setHybridLeaf(enum LeafKernel leaf) {
+    hybridLeaf = leaf;
+}
+
+/**
+ * Returns the kernel used by strassenMul_hybrid below the cutoff
+ * @return       Current leaf kernel
+ */
+enum LeafKernel getHybridLeaf(void) {
+    return hybridLeaf;
+}
+
+/* Runtime on which strassenMul_hybrid spawns its products, if any */
+static struct TaskRuntime* hybridRuntime = NULL;
+static int hybridSpawnDepth = 0;
+
+/**
+ * Makes strassenMul_hybrid spawn its top levels on a work-stealing runtime
+ * @param rt     Runtime, NULL for serial execution
+ * @param depth  Number of levels spawned as tasks
+ */
+void setHybridRuntime(struct TaskRuntime* rt, int depth) {
+    hybridRuntime = rt;
+    hybridSpawnDepth = depth;
+}
+
+/**
+ * Returns the larger of two ints
+ * @param a      First value
+ * @param b      Second value
+ * @return       max(a, b)
+ */
+static int maxInt(int a, int b) {
+    return a > b ? a : b;
+}
+
+/**
+ * Returns the smaller of two ints
+ * @param a      First value
+ * @param b      Second value
+ * @return       min(a, b)
+ */
+static int minInt(int a, int b) {
+    return a < b ? a : b;
+}
+
+/**
+ * Returns the number of bytes of workspace needed by the Strassen engines
+ * for an m x k by k x n product
+ * Follows the recursion level by level until one dimension drops to the
+ * cutoff: peeled levels need no temporaries, a level that halves k needs
+ * one m x n temporary, a Strassen level needs temp1 (m/2 x k/2),
+ * temp2 (k/2 x n/2) and P (m/2 x n/2)
  *
- * @param A      First input matrix
- * @param B      Second input matrix
- * @param C      Output matrix
- * @return       Pointer to the result matrix C
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Strassen),
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @return           Size of the arena in bytes
  */
-struct Matrix* strassenMul(struct Matrix* A, struct Matrix* B, struct Matrix* C) {
-    /* Base case for recursion - single element matrices */
-    if (A->row == 1) {
-        matrixElem(C->matrix, 0, 0, C->col) = 
-            matrixElem(A->matrix, 0, 0, A->col) * matrixElem(B->matrix, 0, 0, B->col);
+size_t strassenWorkspaceSizeRect(int m, int k, int n, int cutoff) {
+    size_t elems = 0;
+
+    if (cutoff == CUTOFF_AUTO) cutoff = profileCutoff(maxInt(m, maxInt(k, n)));
+    if (cutoff < 1) cutoff = 1;  /* Pure Strassen recurses down to 1x1 */
+
+    while (m > cutoff && k > cutoff && n > cutoff) {
+        if ((m | k | n) & 1) {
+            m &= ~1;                     /* Peeled level: no temporaries */
+            k &= ~1;
+            n &= ~1;
+            continue;
+        }
+        int largest = maxInt(m, maxInt(k, n));
+        if (largest >= 2 * minInt(m, minInt(k, n))) {
+            if (m == largest) {
+                m /= 2;                  /* Two row blocks, one after the other */
+            } else if (n == largest) {
+                n /= 2;                  /* Two column blocks */
+            } else {
+                elems += (size_t)m * n;  /* Second half-k product */
+                k /= 2;
+            }
+            continue;
+        }
+        elems += (size_t)(m / 2) * (k / 2) + (size_t)(k / 2) * (n / 2) +
+                 (size_t)(m / 2) * (n / 2);  /* temp1, temp2 and P */
+        m /= 2;
+        k /= 2;
+        n /= 2;
+    }
+
+    /* The blocked leaf packs its panels right after the last level */
+    if (cutoff > 1 && hybridLeaf == LEAF_BLOCKED) {
+        return elems * sizeof(int) + gemmPackSize(m, n, k);
+    }
+    return elems * sizeof(int);
+}
+
+/**
+ * Returns the number of bytes of workspace needed by the Strassen engines
+ * for two side x side matrices
+ *
+ * @param side       Side length of the (square) input matrices
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Strassen),
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @return           Size of the arena in bytes
+ */
+size_t strassenWorkspaceSize(int side, int cutoff) {
+    return strassenWorkspaceSizeRect(side, side, side, cutoff);
+}
+
+/**
+ * Builds a matrix header over a slice of the workspace arena
+ * The returned matrix does not own its memory and must not be freed
+ *
+ * @param data   First element of the slice
+ * @param rows   Number of rows of the matrix
+ * @param cols   Number of columns of the matrix
+ * @return       Matrix struct pointing into the arena
+ */
+static struct Matrix arenaMatrix(int* data, int rows, int cols) {
+    struct Matrix mat;
+    mat.matrix = data;
+    mat.row = rows;
+    mat.col = cols;
+    mat.ld = cols;
+    return mat;
+}
+
+static struct Matrix* strassenRecursive(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                        int cutoff, int* ws);
+
+/* Zero-block detection selected with setZeroBlockSkip */
+static enum ZeroSkip zeroBlockSkip = ZERO_SKIP_OFF;
+
+/**
+ * Selects how the Strassen engines look for known-zero blocks
+ * @param mode   Zero-block detection
+ */
+void setZeroBlockSkip(enum ZeroSkip mode) {
+    zeroBlockSkip = mode;
+}
+
+/**
+ * Returns the zero-block detection used by the Strassen engines
+ * @return       Current mode
+ */
+enum ZeroSkip getZeroBlockSkip(void) {
+    return zeroBlockSkip;
+}
+
+/**
+ * Tells whether every element of a matrix is zero
+ * @param mat    Matrix or view to scan
+ * @return       1 if the matrix is zero, 0 at the first nonzero element
+ */
+int isZeroMatrix(struct Matrix* mat) {
+    for (int i = 0; i < mat->row; i++) {
+        const int* row = &matrixElem(mat->matrix, i, 0, mat->ld);
+        for (int j = 0; j < mat->col; j++) {
+            if (row[j] != 0) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Forms the operand X + Y or X - Y of one of Strassen's products
+ * A summand known to be zero is not read: the other one is used in
+ * place, or negated into temp for 0 - Y
+ *
+ * @param X          First summand (a quadrant)
+ * @param zeroX      1 if X is known to be zero
+ * @param Y          Second summand (a quadrant)
+ * @param zeroY      1 if Y is known to be zero
+ * @param subtract   1 for X - Y, 0 for X + Y
+ * @param temp       Temporary of the level, same shape as X
+ * @return           Operand (temp, X or Y), NULL if both summands are zero
+ */
+static struct Matrix* formOperand(struct Matrix* X, int zeroX, struct Matrix* Y, int zeroY,
+                                  int subtract, struct Matrix* temp) {
+    if (zeroX && zeroY) return NULL;
+    if (zeroY) return X;
+    if (zeroX && !subtract) return Y;
+    if (zeroX) {
+        for (int i = 0; i < Y->row; i++) {
+            const int* y = &matrixElem(Y->matrix, i, 0, Y->ld);
+            int* t = &matrixElem(temp->matrix, i, 0, temp->ld);
+            for (int j = 0; j < Y->col; j++) {
+                t[j] = -y[j];
+            }
+        }
+        return temp;
+    }
+    if (subtract) {
+        subMatrixRect(X, 0, 0, Y, 0, 0, temp, 0, 0, X->row, X->col);
+    } else {
+        sumMatrixRect(X, 0, 0, Y, 0, 0, temp, 0, 0, X->row, X->col);
+    }
+    return temp;
+}
+
+/**
+ * Runs one of Strassen's products, unless an operand is known to be zero
+ * @param L          Left operand, NULL if it is zero
+ * @param R          Right operand, NULL if it is zero
+ * @param D          Destination of the product
+ * @param clear      1 to zero D when the product is skipped (D is a block of C the product assigns)
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param ws         Workspace arena for the levels below
+ * @return           1 if D holds the product, 0 if it was skipped
+ */
+static int strassenProduct(struct Matrix* L, struct Matrix* R, struct Matrix* D,
+                           int clear, int cutoff, int* ws) {
+    if (L == NULL || R == NULL) {
+        if (clear) initMatrixZeros(D);
+        return 0;
+    }
+    strassenRecursive(L, R, D, cutoff, ws);
+    return 1;
+}
+
+/**
+ * One recursion level shared by strassenMul and strassenMul_hybrid
+ * Computes C = A * B (A m x k, B k x n), switching to the leaf kernel
+ * (mul() or, for the hybrid engine, the one chosen with setHybridLeaf)
+ * once a dimension is <= cutoff.
+ * With cutoff == 1 this is the pure Strassen algorithm (the 1x1
+ * product computed by mul() is the scalar base case).
+ * A, B and C may be views with any leading dimension.
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param ws         Workspace arena for this level and the ones below it
+ * @return           Pointer to the result matrix C
+ */
+static struct Matrix* strassenLevel(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                    int cutoff, int* ws) {
+    int m = A->row, k = A->col, n = B->col;
+
+    /* Base case: switch to standard multiplication when a dimension is <= cutoff */
+    if (m <= cutoff || k <= cutoff || n <= cutoff) {
+        COUNTERS_PHASE(PHASE_MULTIPLY);
+        if (cutoff > 1 && hybridLeaf == LEAF_BLOCKED) {
+            return mulBlocked_ws(A, B, C, ws);  /* Packing buffers follow the last level */
+        }
+        return mul(A, B, C);
+    }
+
+    /* Odd dimension: multiply the even leading blocks, then fix up the rest */
+    if ((m | k | n) & 1) {
+        struct Matrix A11 = matrixView(A, 0, 0, m & ~1, k & ~1);
+        struct Matrix B11 = matrixView(B, 0, 0, k & ~1, n & ~1);
+        struct Matrix C11 = matrixView(C, 0, 0, m & ~1, n & ~1);
+        strassenRecursive(&A11, &B11, &C11, cutoff, ws);
+        COUNTERS_PHASE(PHASE_PEEL);
+        peelUpdate(A, B, C);
+        return C;
+    }
+
+    /* Unbalanced shape: halve the largest dimension instead of all three */
+    int largest = maxInt(m, maxInt(k, n));
+    if (largest >= 2 * minInt(m, minInt(k, n))) {
+        /* Halves known to be zero give zero blocks of C or skipped products */
+        int z = zeroBlockSkip != ZERO_SKIP_OFF;
+        if (m == largest) {
+            struct Matrix A1 = matrixView(A, 0, 0, m / 2, k), A2 = matrixView(A, m / 2, 0, m / 2, k);
+            struct Matrix C1 = matrixView(C, 0, 0, m / 2, n), C2 = matrixView(C, m / 2, 0, m / 2, n);
+            strassenProduct(z && isZeroMatrix(&A1) ? NULL : &A1, B, &C1, 1, cutoff, ws);
+            strassenProduct(z && isZeroMatrix(&A2) ? NULL : &A2, B, &C2, 1, cutoff, ws);
+        } else if (n == largest) {
+            struct Matrix B1 = matrixView(B, 0, 0, k, n / 2), B2 = matrixView(B, 0, n / 2, k, n / 2);
+            struct Matrix C1 = matrixView(C, 0, 0, m, n / 2), C2 = matrixView(C, 0, n / 2, m, n / 2);
+            strassenProduct(A, z && isZeroMatrix(&B1) ? NULL : &B1, &C1, 1, cutoff, ws);
+            strassenProduct(A, z && isZeroMatrix(&B2) ? NULL : &B2, &C2, 1, cutoff, ws);
+        } else {
+            /* C = A1 * B1 + A2 * B2, the second product goes through a temporary */
+            struct Matrix A1 = matrixView(A, 0, 0, m, k / 2), A2 = matrixView(A, 0, k / 2, m, k / 2);
+            struct Matrix B1 = matrixView(B, 0, 0, k / 2, n), B2 = matrixView(B, k / 2, 0, k / 2, n);
+            struct Matrix P = arenaMatrix(ws, m, n);
+            int zero1 = z && (isZeroMatrix(&A1) || isZeroMatrix(&B1));
+            int zero2 = z && (isZeroMatrix(&A2) || isZeroMatrix(&B2));
+            strassenProduct(zero1 ? NULL : &A1, &B1, C, 1, cutoff, ws + (size_t)m * n);
+            if (strassenProduct(zero2 ? NULL : &A2, &B2, &P, 0, cutoff, ws + (size_t)m * n)) {
+                COUNTERS_PHASE(PHASE_ACCUMULATE);
+                addSubmatrixRect(&P, C, 0, 0, m, n);
+            }
+        }
         return C;
     }
 
-    /* Calculate new dimension for submatrices */
-    int newSide = A->row / 2;
+    /* Calculate new dimensions for the blocks */
+    int hm = m / 2, hk = k / 2, hn = n / 2;
 
-    /* Allocate temporary matrices for calculations */
-    struct Matrix temp1 = allocMatrix(newSide);
-    struct Matrix temp2 = allocMatrix(newSide);
-    struct Matrix P = allocMatrix(newSide);
+    /* Slice the temporary matrices of this level from the arena */
+    struct Matrix temp1 = arenaMatrix(ws, hm, hk);
+    struct Matrix temp2 = arenaMatrix(ws + (size_t)hm * hk, hk, hn);
+    struct Matrix P = arenaMatrix(ws + (size_t)hm * hk + (size_t)hk * hn, hm, hn);
+    int* next = ws + (size_t)hm * hk + (size_t)hk * hn + (size_t)hm * hn;  /* Arena for the levels below */
 
-    /* Initialize result matrix with zeros */
-    initMatrixZeros(C);
+    /* Views on the quadrants of the operands and of C */
+    struct Matrix A11 = matrixView(A, 0, 0, hm, hk), A12 = matrixView(A, 0, hk, hm, hk);
+    struct Matrix A21 = matrixView(A, hm, 0, hm, hk), A22 = matrixView(A, hm, hk, hm, hk);
+    struct Matrix B11 = matrixView(B, 0, 0, hk, hn), B12 = matrixView(B, 0, hn, hk, hn);
+    struct Matrix B21 = matrixView(B, hk, 0, hk, hn), B22 = matrixView(B, hk, hn, hk, hn);
+    struct Matrix C11 = matrixView(C, 0, 0, hm, hn), C12 = matrixView(C, 0, hn, hm, hn);
+    struct Matrix C21 = matrixView(C, hm, 0, hm, hn), C22 = matrixView(C, hm, hn, hm, hn);
+
+    /* Quadrants known to be zero: their sums are elided and products with a zero operand skipped */
+    int zA11 = 0, zA12 = 0, zA21 = 0, zA22 = 0, zB11 = 0, zB12 = 0, zB21 = 0, zB22 = 0;
+    if (zeroBlockSkip != ZERO_SKIP_OFF) {
+        COUNTERS_PHASE(PHASE_FORM);
+        zA11 = isZeroMatrix(&A11);
+        zA12 = isZeroMatrix(&A12);
+        zA21 = isZeroMatrix(&A21);
+        zA22 = isZeroMatrix(&A22);
+        zB11 = isZeroMatrix(&B11);
+        zB12 = isZeroMatrix(&B12);
+        zB21 = isZeroMatrix(&B21);
+        zB22 = isZeroMatrix(&B22);
+    }
+    struct Matrix* L;
+    struct Matrix* R;
+    int done;
 
     /* 
      * Strassen's 7 recursive multiplications with corresponding additions/subtractions
+     * Every quadrant of C is assigned before being updated, so C needs no zeroing
      */
     
-    /* P1 = (A12 - A22) * (B21 + B22) */
-    subMatrix(A, 0, newSide, A, newSide, newSide, &temp1, 0, 0, newSide);
-    sumMatrix(B, newSide, 0, B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
-
-    /* C11 = P1 */
-    copySubmatrix(&P, 0, 0, C, 0, 0, newSide);
+    /* P1 = (A12 - A22) * (B21 + B22), C11 = P1 */
+    COUNTERS_PHASE(PHASE_FORM);
+    L = formOperand(&A12, zA12, &A22, zA22, 1, &temp1);
+    R = formOperand(&B21, zB21, &B22, zB22, 0, &temp2);
+    TRACE_BEGIN(traceP1);
+    strassenProduct(L, R, &C11, 1, cutoff, next);
+    TRACE_END(traceP1, "P1", hm, hn);
 
     /* P2 = (A11 + A22) * (B11 + B22) */
-    sumMatrix(A, 0, 0, A, newSide, newSide, &temp1, 0, 0, newSide);
-    sumMatrix(B, 0, 0, B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    COUNTERS_PHASE(PHASE_FORM);
+    L = formOperand(&A11, zA11, &A22, zA22, 0, &temp1);
+    R = formOperand(&B11, zB11, &B22, zB22, 0, &temp2);
+    TRACE_BEGIN(traceP2);
+    done = strassenProduct(L, R, &P, 0, cutoff, next);
+    TRACE_END(traceP2, "P2", hm, hn);
 
     /* C11 += P2, C22 = P2 */
-    addSubmatrix(&P, C, 0, 0, newSide);
-    copySubmatrix(&P, 0, 0, C, newSide, newSide, newSide);
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    if (done) {
+        addSubmatrixRect(&P, C, 0, 0, hm, hn);
+        copySubmatrixRect(&P, 0, 0, C, hm, hn, hm, hn);
+    } else {
+        initMatrixZeros(&C22);
+    }
 
     /* P3 = (A11 - A21) * (B11 + B12) */
-    subMatrix(A, 0, 0, A, newSide, 0, &temp1, 0, 0, newSide);
-    sumMatrix(B, 0, 0, B, 0, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    COUNTERS_PHASE(PHASE_FORM);
+    L = formOperand(&A11, zA11, &A21, zA21, 1, &temp1);
+    R = formOperand(&B11, zB11, &B12, zB12, 0, &temp2);
+    TRACE_BEGIN(traceP3);
+    done = strassenProduct(L, R, &P, 0, cutoff, next);
+    TRACE_END(traceP3, "P3", hm, hn);
 
     /* C22 -= P3 */
-    subSubmatrix(&P, C, newSide, newSide, newSide);
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    if (done) subSubmatrixRect(&P, C, hm, hn, hm, hn);
 
-    /* P4 = (A11 + A12) * B22 */
-    sumMatrix(A, 0, 0, A, 0, newSide, &temp1, 0, 0, newSide);
-    copySubmatrix(B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* P4 = (A11 + A12) * B22, C12 = P4 */
+    COUNTERS_PHASE(PHASE_FORM);
+    L = formOperand(&A11, zA11, &A12, zA12, 0, &temp1);
+    TRACE_BEGIN(traceP4);
+    done = strassenProduct(L, zB22 ? NULL : &B22, &C12, 1, cutoff, next);
+    TRACE_END(traceP4, "P4", hm, hn);
 
-    /* C11 -= P4, C12 = P4 */
-    subSubmatrix(&P, C, 0, 0, newSide);
-    copySubmatrix(&P, 0, 0, C, 0, newSide, newSide);
+    /* C11 -= P4 */
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    if (done) subSubmatrixRect(&C12, C, 0, 0, hm, hn);
 
     /* P5 = A11 * (B12 - B22) */
-    copySubmatrix(A, 0, 0, &temp1, 0, 0, newSide);
-    subMatrix(B, 0, newSide, B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    COUNTERS_PHASE(PHASE_FORM);
+    R = formOperand(&B12, zB12, &B22, zB22, 1, &temp2);
+    TRACE_BEGIN(traceP5);
+    done = strassenProduct(zA11 ? NULL : &A11, R, &P, 0, cutoff, next);
+    TRACE_END(traceP5, "P5", hm, hn);
 
     /* C12 += P5, C22 += P5 */
-    addSubmatrix(&P, C, 0, newSide, newSide);
-    addSubmatrix(&P, C, newSide, newSide, newSide);
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    if (done) {
+        addSubmatrixRect(&P, C, 0, hn, hm, hn);
+        addSubmatrixRect(&P, C, hm, hn, hm, hn);
+    }
 
-    /* P6 = A22 * (B21 - B11) */
-    copySubmatrix(A, newSide, newSide, &temp1, 0, 0, newSide);
-    subMatrix(B, newSide, 0, B, 0, 0, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* P6 = A22 * (B21 - B11), C21 = P6 */
+    COUNTERS_PHASE(PHASE_FORM);
+    R = formOperand(&B21, zB21, &B11, zB11, 1, &temp2);
+    TRACE_BEGIN(traceP6);
+    done = strassenProduct(zA22 ? NULL : &A22, R, &C21, 1, cutoff, next);
+    TRACE_END(traceP6, "P6", hm, hn);
 
-    /* C11 += P6, C21 = P6 */
-    addSubmatrix(&P, C, 0, 0, newSide);
-    copySubmatrix(&P, 0, 0, C, newSide, 0, newSide);
+    /* C11 += P6 */
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    if (done) addSubmatrixRect(&C21, C, 0, 0, hm, hn);
 
     /* P7 = (A21 + A22) * B11 */
-    sumMatrix(A, newSide, 0, A, newSide, newSide, &temp1, 0, 0, newSide);
-    copySubmatrix(B, 0, 0, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    COUNTERS_PHASE(PHASE_FORM);
+    L = formOperand(&A21, zA21, &A22, zA22, 0, &temp1);
+    TRACE_BEGIN(traceP7);
+    done = strassenProduct(L, zB11 ? NULL : &B11, &P, 0, cutoff, next);
+    TRACE_END(traceP7, "P7", hm, hn);
 
     /* C21 += P7, C22 -= P7 */
-    addSubmatrix(&P, C, newSide, 0, newSide);
-    subSubmatrix(&P, C, newSide, newSide, newSide);
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    if (done) {
+        addSubmatrixRect(&P, C, hm, 0, hm, hn);
+        subSubmatrixRect(&P, C, hm, hn, hm, hn);
+    }
+
+    return C;
+}
+
+/**
+ * Recursive step shared by strassenMul and strassenMul_hybrid
+ * Runs one level; with -DMATRIX_COUNTERS the level is bracketed by the
+ * hardware counter hooks (see counters.h)
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param ws         Workspace arena for this level and the ones below it
+ * @return           Pointer to the result matrix C
+ */
+static struct Matrix* strassenRecursive(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                        int cutoff, int* ws) {
+    TRACE_BEGIN(traceStart);
+    COUNTERS_ENTER();
+    strassenLevel(A, B, C, cutoff, ws);
+    COUNTERS_LEAVE();
+    TRACE_END(traceStart, "level", A->row, B->col);
+    return C;
+}
+
+/**
+ * Strassen's algorithm on a caller-supplied workspace arena
+ * Performs no heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param workspace  Arena of at least strassenWorkspaceSizeRect(A->row, A->col, B->col, 1) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* strassenMul_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C, void* workspace) {
+    return strassenRecursive(A, B, C, 1, workspace);
+}
+
+/**
+ * Hybrid Strassen's algorithm on a caller-supplied workspace arena
+ * Performs no heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication,
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @param workspace  Arena of at least strassenWorkspaceSizeRect(A->row, A->col, B->col, cutoff) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* strassenMul_hybrid_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                     int cutoff, void* workspace) {
+    if (cutoff == CUTOFF_AUTO) {
+        cutoff = profileCutoff(maxInt(A->row, maxInt(A->col, B->col)));
+    }
+    if (cutoff < 1) cutoff = 1;
+    return strassenRecursive(A, B, C, cutoff, workspace);
+}
 
-    /* Free temporary matrices to avoid memory leaks */
-    freeMatrix(&temp1);
-    freeMatrix(&temp2);
-    freeMatrix(&P);
+/**
+ * Performs Strassen's matrix multiplication algorithm
+ * Computes C = A * B with time complexity O(n^log₂7) ≈ O(n^2.81)
+ * The workspace arena is allocated once for the whole multiplication
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @return       Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMul(struct Matrix* A, struct Matrix* B, struct Matrix* C) {
+    size_t bytes = strassenWorkspaceSizeRect(A->row, A->col, B->col, 1);
+    void* workspace = malloc(bytes > 0 ? bytes : 1);
+    if (workspace == NULL) return NULL;
 
+    strassenMul_ws(A, B, C, workspace);
+
+    free(workspace);
     return C;
 }
 
 /**
  * Hybrid Strassen's algorithm that switches to standard multiplication for small matrices
  * Uses Strassen for large matrices and standard multiplication when size <= cutoff
+ * The workspace arena is allocated once for the whole multiplication
+ * With a runtime set by setHybridRuntime, the products of the top levels
+ * are spawned as stealable tasks
+ *
+ * Note on optimal cutoff value:
+ * For theoretical complexity g(n_0) = (2*n_0 + 5)/(n_0^(log_2(7)-2)))
+ * The minimum is at d(g(n_0))/d(n_0) = 0 -> approximately 10.48
+ * Without padding we choose the first power before 10 or after 10
+ * In this case we choose 8 since g(8) = 3.92 < g(16) = 3.94
+ * With padding we can choose g(10) = 3.89
  * 
  * @param A          First input matrix
  * @param B          Second input matrix
  * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication,
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @return           Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMul_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    /* Trailing zero rows and columns (padding) are left out of the recursion */
+    if (zeroBlockSkip == ZERO_SKIP_TRAILING) {
+        int rowsA, colsA, rowsB, colsB;
+        nonzeroExtent(A, &rowsA, &colsA);
+        nonzeroExtent(B, &rowsB, &colsB);
+        int k = minInt(colsA, rowsB);
+        if (rowsA < A->row || k < A->col || colsB < B->col) {
+            return strassenMul_padded(A, B, C, cutoff, rowsA, k, colsB);
+        }
+    }
+    if (cutoff == CUTOFF_AUTO) {
+        cutoff = profileCutoff(maxInt(A->row, maxInt(A->col, B->col)));
+    }
+
+    /* Spawn the products of the top levels as stealable tasks */
+    if (hybridRuntime != NULL && hybridSpawnDepth > 0) {
+        return strassenMul_runtime(hybridRuntime, A, B, C, cutoff, hybridSpawnDepth);
+    }
+
+    size_t bytes = strassenWorkspaceSizeRect(A->row, A->col, B->col, cutoff);
+    void* workspace = malloc(bytes > 0 ? bytes : 1);
+    if (workspace == NULL) return NULL;
+
+    strassenMul_hybrid_ws(A, B, C, cutoff, workspace);
+
+    free(workspace);
+    return C;
+}
+
+/**
+ * Returns the leading block of a matrix that holds all its nonzero elements
+ * The scan goes backwards and stops at the first nonzero row and, in each
+ * remaining row, at the first nonzero column, so a dense matrix costs
+ * about one read per row
+ *
+ * @param mat    Matrix or view to scan
+ * @param rows   Receives the number of leading rows holding nonzeros
+ * @param cols   Receives the number of leading columns holding nonzeros
+ */
+void nonzeroExtent(struct Matrix* mat, int* rows, int* cols) {
+    int r = mat->row, c = 0;
+
+    while (r > 0) {
+        const int* row = &matrixElem(mat->matrix, r - 1, 0, mat->ld);
+        int j = mat->col;
+        while (j > 0 && row[j - 1] == 0) j--;
+        if (j > 0) break;
+        r--;
+    }
+    for (int i = 0; i < r && c < mat->col; i++) {
+        const int* row = &matrixElem(mat->matrix, i, 0, mat->ld);
+        int j = mat->col;
+        while (j > c && row[j - 1] == 0) j--;
+        c = j;
+    }
+    *rows = r;
+    *cols = c;
+}
+
+/**
+ * Multiplies padded matrices whose data is in their leading blocks
+ * Only the m x k block of A and the k x n block of B are multiplied (by
+ * strassenMul_hybrid); the rest of A and B must be zero, and the rest
+ * of C is set to zero
+ *
+ * @param A          First input matrix, zero outside its leading m x k block
+ * @param B          Second input matrix, zero outside its leading k x n block
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication, or CUTOFF_AUTO
+ * @param m          Rows of A holding data
+ * @param k          Columns of A / rows of B holding data
+ * @param n          Columns of B holding data
+ * @return           Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMul_padded(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                                  int m, int k, int n) {
+    /* Zero the padding of C: the rows below m, then the columns right of n */
+    if (m < C->row) {
+        struct Matrix bottom = matrixView(C, m, 0, C->row - m, C->col);
+        initMatrixZeros(&bottom);
+    }
+    if (n < C->col) {
+        struct Matrix right = matrixView(C, 0, n, m, C->col - n);
+        initMatrixZeros(&right);
+    }
+
+    struct Matrix live = matrixView(C, 0, 0, m, n);
+    if (k == 0) {
+        initMatrixZeros(&live);
+        return C;
+    }
+    if (m == 0 || n == 0) return C;
+
+    struct Matrix liveA = matrixView(A, 0, 0, m, k);
+    struct Matrix liveB = matrixView(B, 0, 0, k, n);
+    return strassenMul_hybrid(&liveA, &liveB, &live, cutoff) != NULL ? C : NULL;
+}
+
+/*********************************************
+ * Squaring and matrix power
+ *
+ * When B == A the operand sums of Strassen's products repeat:
+ *
+ * S1 = A12 - A22    P1 = S1 * S2     P5 = A11 * S1
+ * S2 = A21 + A22    P7 = S2 * A11
+ * S3 = A11 + A22    P2 = S3 * S3     (a square: recursion on this path)
+ * S4 = A11 - A21    P3 = S4 * S5     P6 = -(A22 * S4)
+ * S5 = A11 + A12    P4 = S5 * A22
+ *
+ * so a squaring level forms 5 sums instead of 10 and one of its seven
+ * products is itself a square. The schedule below keeps two sums alive
+ * at a time, so a level still needs only temp1, temp2 and P, and the
+ * arena is the one of strassenMul_hybrid (strassenWorkspaceSize).
+ *
+ * matrixPower computes A^k by left-to-right binary exponentiation: one
+ * squaring per bit of k and one product by A per set bit after the
+ * first. Results alternate between C and one side x side buffer of the
+ * arena; the first buffer is chosen from the number of steps so that
+ * the last one lands in C.
+ *********************************************/
+
+static struct Matrix* squareRecursive(struct Matrix* A, struct Matrix* C, int cutoff, int* ws);
+
+/**
+ * One recursion level of the squaring path
+ * Computes C = A * A for a square A, switching to the leaf kernel once
+ * the side is <= cutoff
+ *
+ * @param A          Input matrix (square)
+ * @param C          Output matrix, must not overlap A
  * @param cutoff     Size threshold to switch to standard multiplication
+ * @param ws         Workspace arena for this level and the ones below it
  * @return           Pointer to the result matrix C
  */
-struct Matrix* strassenMul_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
-    /* Base case: switch to standard multiplication when size <= cutoff */
-    /*
-     * Note on optimal cutoff value:
-     * For theoretical complexity g(n_0) = (2*n_0 + 5)/(n_0^(log_2(7)-2)))
-     * The minimum is at d(g(n_0))/d(n_0) = 0 -> approximately 10.48
-     * Without padding we choose the first power before 10 or after 10
-     * In this case we choose 8 since g(8) = 3.92 < g(16) = 3.94
-     */
-    
-    /*
-    if (A->row <= 8) {
-        return mul(A,B,C);
+static struct Matrix* squareLevel(struct Matrix* A, struct Matrix* C, int cutoff, int* ws) {
+    int n = A->row;
+
+    if (n <= cutoff) {
+        COUNTERS_PHASE(PHASE_MULTIPLY);
+        if (cutoff > 1 && hybridLeaf == LEAF_BLOCKED) {
+            return mulBlocked_ws(A, A, C, ws);
+        }
+        return mul(A, A, C);
     }
-    */
-    
-    /* With padding we can choose g(10) = 3.89 */
-    if (A->row <= cutoff) {
-        return mul(A,B,C);
+
+    /* Odd side: square the even leading block, then fix up the rest */
+    if (n & 1) {
+        struct Matrix A11 = matrixView(A, 0, 0, n - 1, n - 1);
+        struct Matrix C11 = matrixView(C, 0, 0, n - 1, n - 1);
+        squareRecursive(&A11, &C11, cutoff, ws);
+        COUNTERS_PHASE(PHASE_PEEL);
+        peelUpdate(A, A, C);
+        return C;
     }
 
-    /* Calculate new dimension for submatrices */
-    int newSide = A->row / 2;
+    int h = n / 2;
 
-    /* Allocate temporary matrices for calculations */
-    struct Matrix temp1 = allocMatrix(newSide);
-    struct Matrix temp2 = allocMatrix(newSide);
-    struct Matrix P = allocMatrix(newSide);
+    struct Matrix temp1 = arenaMatrix(ws, h, h);
+    struct Matrix temp2 = arenaMatrix(ws + (size_t)h * h, h, h);
+    struct Matrix P = arenaMatrix(ws + 2 * (size_t)h * h, h, h);
+    int* next = ws + 3 * (size_t)h * h;
 
-    /* Initialize result matrix with zeros */
-    initMatrixZeros(C);
+    struct Matrix A11 = matrixView(A, 0, 0, h, h);
+    struct Matrix A22 = matrixView(A, h, h, h, h);
+    struct Matrix C11 = matrixView(C, 0, 0, h, h);
+    struct Matrix C12 = matrixView(C, 0, h, h, h);
+    struct Matrix C21 = matrixView(C, h, 0, h, h);
 
-    /* 
-     * Strassen's 7 recursive multiplications with corresponding additions/subtractions
-     * Same algorithm as strassenMul but using strassenMul_hybrid for recursion
-     */
-    
-    /* P1 = (A12 - A22) * (B21 + B22) */
-    subMatrix(A, 0, newSide, A, newSide, newSide, &temp1, 0, 0, newSide);
-    sumMatrix(B, newSide, 0, B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* temp1 = S1, temp2 = S2; P1 = S1 * S2, C11 = P1 */
+    COUNTERS_PHASE(PHASE_FORM);
+    subMatrixRect(A, 0, h, A, h, h, &temp1, 0, 0, h, h);
+    sumMatrixRect(A, h, 0, A, h, h, &temp2, 0, 0, h, h);
+    TRACE_BEGIN(traceP1);
+    strassenRecursive(&temp1, &temp2, &C11, cutoff, next);
+    TRACE_END(traceP1, "P1", h, h);
 
-    /* C11 = P1 */
-    copySubmatrix(&P, 0, 0, C, 0, 0, newSide);
+    /* P7 = S2 * A11, C21 = P7 */
+    TRACE_BEGIN(traceP7);
+    strassenRecursive(&temp2, &A11, &C21, cutoff, next);
+    TRACE_END(traceP7, "P7", h, h);
 
-    /* P2 = (A11 + A22) * (B11 + B22) */
-    sumMatrix(A, 0, 0, A, newSide, newSide, &temp1, 0, 0, newSide);
-    sumMatrix(B, 0, 0, B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* P5 = A11 * S1, C12 = P5 */
+    TRACE_BEGIN(traceP5);
+    strassenRecursive(&A11, &temp1, &C12, cutoff, next);
+    TRACE_END(traceP5, "P5", h, h);
 
-    /* C11 += P2, C22 = P2 */
-    addSubmatrix(&P, C, 0, 0, newSide);
-    copySubmatrix(&P, 0, 0, C, newSide, newSide, newSide);
+    /* C22 = P5 - P7 */
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    subMatrixRect(C, 0, h, C, h, 0, C, h, h, h, h);
 
-    /* P3 = (A11 - A21) * (B11 + B12) */
-    subMatrix(A, 0, 0, A, newSide, 0, &temp1, 0, 0, newSide);
-    sumMatrix(B, 0, 0, B, 0, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* temp1 = S3; P2 = S3 * S3 */
+    COUNTERS_PHASE(PHASE_FORM);
+    sumMatrixRect(A, 0, 0, A, h, h, &temp1, 0, 0, h, h);
+    TRACE_BEGIN(traceP2);
+    squareRecursive(&temp1, &P, cutoff, next);
+    TRACE_END(traceP2, "P2", h, h);
+
+    /* C11 += P2, C22 += P2 */
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    addSubmatrixRect(&P, C, 0, 0, h, h);
+    addSubmatrixRect(&P, C, h, h, h, h);
+
+    /* temp1 = S4, temp2 = S5; P3 = S4 * S5 */
+    COUNTERS_PHASE(PHASE_FORM);
+    subMatrixRect(A, 0, 0, A, h, 0, &temp1, 0, 0, h, h);
+    sumMatrixRect(A, 0, 0, A, 0, h, &temp2, 0, 0, h, h);
+    TRACE_BEGIN(traceP3);
+    strassenRecursive(&temp1, &temp2, &P, cutoff, next);
+    TRACE_END(traceP3, "P3", h, h);
 
     /* C22 -= P3 */
-    subSubmatrix(&P, C, newSide, newSide, newSide);
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    subSubmatrixRect(&P, C, h, h, h, h);
 
-    /* P4 = (A11 + A12) * B22 */
-    sumMatrix(A, 0, 0, A, 0, newSide, &temp1, 0, 0, newSide);
-    copySubmatrix(B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* P4 = S5 * A22 */
+    TRACE_BEGIN(traceP4);
+    strassenRecursive(&temp2, &A22, &P, cutoff, next);
+    TRACE_END(traceP4, "P4", h, h);
 
-    /* C11 -= P4, C12 = P4 */
-    subSubmatrix(&P, C, 0, 0, newSide);
-    copySubmatrix(&P, 0, 0, C, 0, newSide, newSide);
+    /* C12 += P4, C11 -= P4 */
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    addSubmatrixRect(&P, C, 0, h, h, h);
+    subSubmatrixRect(&P, C, 0, 0, h, h);
 
-    /* P5 = A11 * (B12 - B22) */
-    copySubmatrix(A, 0, 0, &temp1, 0, 0, newSide);
-    subMatrix(B, 0, newSide, B, newSide, newSide, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    /* P = A22 * S4 = -P6 */
+    TRACE_BEGIN(traceP6);
+    strassenRecursive(&A22, &temp1, &P, cutoff, next);
+    TRACE_END(traceP6, "P6", h, h);
 
-    /* C12 += P5, C22 += P5 */
-    addSubmatrix(&P, C, 0, newSide, newSide);
-    addSubmatrix(&P, C, newSide, newSide, newSide);
+    /* C21 += P6, C11 += P6 */
+    COUNTERS_PHASE(PHASE_ACCUMULATE);
+    subSubmatrixRect(&P, C, h, 0, h, h);
+    subSubmatrixRect(&P, C, 0, 0, h, h);
+
+    return C;
+}
+
+/**
+ * Recursive step of the squaring path
+ * Runs one level bracketed by the counter and trace hooks
+ *
+ * @param A          Input matrix (square)
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param ws         Workspace arena for this level and the ones below it
+ * @return           Pointer to the result matrix C
+ */
+static struct Matrix* squareRecursive(struct Matrix* A, struct Matrix* C, int cutoff, int* ws) {
+    TRACE_BEGIN(traceStart);
+    COUNTERS_ENTER();
+    squareLevel(A, C, cutoff, ws);
+    COUNTERS_LEAVE();
+    TRACE_END(traceStart, "square", A->row, A->col);
+    return C;
+}
 
-    /* P6 = A22 * (B21 - B11) */
-    copySubmatrix(A, newSide, newSide, &temp1, 0, 0, newSide);
-    subMatrix(B, newSide, 0, B, 0, 0, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+/**
+ * Computes C = A * A with the squaring path on a caller-supplied arena
+ * Performs no heap allocation
+ *
+ * @param A          Input matrix (square)
+ * @param C          Output matrix, must not overlap A
+ * @param cutoff     Size threshold to switch to standard multiplication (1 for pure Strassen),
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @param workspace  Arena of at least strassenWorkspaceSize(A->row, cutoff) bytes
+ * @return           Pointer to the result matrix C, NULL if A is not square
+ */
+struct Matrix* strassenSquare_ws(struct Matrix* A, struct Matrix* C, int cutoff, void* workspace) {
+    if (A->row != A->col) return NULL;
+    if (cutoff == CUTOFF_AUTO) cutoff = profileCutoff(A->row);
+    if (cutoff < 1) cutoff = 1;
+    return squareRecursive(A, C, cutoff, workspace);
+}
+
+/**
+ * Computes C = A * A with the squaring path
+ * The workspace arena is allocated once for the whole multiplication
+ *
+ * @param A          Input matrix (square)
+ * @param C          Output matrix, must not overlap A
+ * @param cutoff     Size threshold to switch to standard multiplication,
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @return           Pointer to the result matrix C, NULL if A is not square
+ *                   or the arena cannot be allocated
+ */
+struct Matrix* strassenSquare(struct Matrix* A, struct Matrix* C, int cutoff) {
+    if (cutoff == CUTOFF_AUTO) cutoff = profileCutoff(A->row);
+    if (cutoff < 1) cutoff = 1;
 
-    /* C11 += P6, C21 = P6 */
-    addSubmatrix(&P, C, 0, 0, newSide);
-    copySubmatrix(&P, 0, 0, C, newSide, 0, newSide);
+    size_t bytes = strassenWorkspaceSize(A->row, cutoff);
+    void* workspace = malloc(bytes > 0 ? bytes : 1);
+    if (workspace == NULL) return NULL;
 
-    /* P7 = (A21 + A22) * B11 */
-    sumMatrix(A, newSide, 0, A, newSide, newSide, &temp1, 0, 0, newSide);
-    copySubmatrix(B, 0, 0, &temp2, 0, 0, newSide);
-    strassenMul(&temp1, &temp2, &P);
+    struct Matrix* result = strassenSquare_ws(A, C, cutoff, workspace);
 
-    /* C21 += P7, C22 -= P7 */
-    addSubmatrix(&P, C, newSide, 0, newSide);
-    subSubmatrix(&P, C, newSide, newSide, newSide);
+    free(workspace);
+    return result;
+}
 
-    /* Free temporary matrices to avoid memory leaks */
-    freeMatrix(&temp1);
-    freeMatrix(&temp2);
-    freeMatrix(&P);
+/**
+ * Returns the number of bytes of workspace needed by matrixPower_ws
+ * One side x side buffer for the ping-pong plus the squaring arena
+ *
+ * @param side       Side length of A
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return           Size of the arena in bytes
+ */
+size_t matrixPowerWorkspaceSize(int side, int cutoff) {
+    return (size_t)side * side * sizeof(int) + strassenWorkspaceSize(side, cutoff);
+}
+
+/**
+ * Computes C = A^k on a caller-supplied arena
+ * Performs no heap allocation
+ *
+ * @param A          Input matrix (square)
+ * @param k          Exponent (A^0 is the identity)
+ * @param C          Output matrix, must not overlap A
+ * @param cutoff     Size threshold to switch to standard multiplication,
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @param workspace  Arena of at least matrixPowerWorkspaceSize(A->row, cutoff) bytes
+ * @return           Pointer to the result matrix C, NULL if A is not square or k < 0
+ */
+struct Matrix* matrixPower_ws(struct Matrix* A, int k, struct Matrix* C, int cutoff, void* workspace) {
+    int n = A->row;
+
+    if (n != A->col || k < 0) return NULL;
+    if (cutoff == CUTOFF_AUTO) cutoff = profileCutoff(n);
+    if (cutoff < 1) cutoff = 1;
+
+    if (k == 0) {
+        initMatrixZeros(C);
+        for (int i = 0; i < n; i++) {
+            matrixElem(C->matrix, i, i, C->ld) = 1;
+        }
+        return C;
+    }
+
+    struct Matrix scratch = arenaMatrix(workspace, n, n);
+    int* ws = (int*)workspace + (size_t)n * n;
+
+    /* One squaring per bit below the top one, one product per set bit below it */
+    int top = 30;
+    while (!(k >> top & 1)) top--;
+    int steps = top;
+    for (int bit = top - 1; bit >= 0; bit--) {
+        steps += k >> bit & 1;
+    }
+
+    /* Start in the buffer that makes the last step write C */
+    struct Matrix* cur = steps % 2 == 0 ? C : &scratch;
+    struct Matrix* other = steps % 2 == 0 ? &scratch : C;
+    copySubmatrixRect(A, 0, 0, cur, 0, 0, n, n);
+
+    for (int bit = top - 1; bit >= 0; bit--) {
+        struct Matrix* swap;
+
+        squareRecursive(cur, other, cutoff, ws);
+        swap = cur; cur = other; other = swap;
+
+        if (k >> bit & 1) {
+            strassenRecursive(cur, A, other, cutoff, ws);
+            swap = cur; cur = other; other = swap;
+        }
+    }
 
     return C;
 }
+
+/**
+ * Computes C = A^k by binary exponentiation with the squaring path
+ * The workspace (ping-pong buffer and arena) is allocated once for all steps
+ *
+ * @param A          Input matrix (square)
+ * @param k          Exponent (A^0 is the identity)
+ * @param C          Output matrix, must not overlap A
+ * @param cutoff     Size threshold to switch to standard multiplication,
+ *                   CUTOFF_AUTO to take it from the tuned profile
+ * @return           Pointer to the result matrix C, NULL if A is not square,
+ *                   k < 0 or the workspace cannot be allocated
+ */
+struct Matrix* matrixPower(struct Matrix* A, int k, struct Matrix* C, int cutoff) {
+    if (cutoff == CUTOFF_AUTO) cutoff = profileCutoff(A->row);
+    if (cutoff < 1) cutoff = 1;
+
+    void* workspace = malloc(matrixPowerWorkspaceSize(A->row, cutoff));
+    if (workspace == NULL) return NULL;
+
+    struct Matrix* result = matrixPower_ws(A, k, C, cutoff, workspace);
+
+    free(workspace);
+    return result;
+}
@@ -1,6 +1,10 @@
 #ifndef matrix_H_
 #define matrix_H_ 
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
 /**
  * Helper macro to access elements in a matrix
  * Matrix elements are stored in row-major order (C standard)
@@ -18,11 +22,18 @@
 /**
  * Matrix structure definition
  * Contains the matrix data as a 1D array and dimensions information
+ *
+ * A Matrix is also used as a view: a block of a larger matrix is described
+ * by a pointer to its first element, its dimensions and the leading
+ * dimension (row stride) of the matrix it belongs to. Element (i, j) is
+ * always matrixElem(m.matrix, i, j, m.ld). A view does not own its data
+ * and must not be passed to freeMatrix.
  */
 struct Matrix {
     int* matrix;   /* 1D array to store matrix elements in row-major order */
     int row;       /* Number of rows in the matrix */
     int col;       /* Number of columns in the matrix */
+    int ld;        /* Leading dimension: distance in elements between two rows */
 };
 /**
  * Allocates memory for a square matrix
@@ -33,6 +44,15 @@ struct Matrix {
  */
 struct Matrix allocMatrix(int side);
 
+/**
+ * Allocates memory for a rectangular matrix
+ *
+ * @param rows  Number of rows
+ * @param cols  Number of columns
+ * @return      A newly allocated Matrix struct (ld = cols)
+ */
+struct Matrix allocMatrixRect(int rows, int cols);
+
 
 /** 
  * Frees the memory allocated for a matrix
@@ -42,6 +62,19 @@ struct Matrix allocMatrix(int side);
  */
 void freeMatrix(struct Matrix* mat);
 
+/**
+ * Creates a view on a block of a matrix without copying it
+ * The view shares the data of mat and has the same leading dimension
+ *
+ * @param mat   Matrix (or view) containing the block
+ * @param row   Starting row of the block in mat
+ * @param col   Starting column of the block in mat
+ * @param rows  Number of rows of the block
+ * @param cols  Number of columns of the block
+ * @return      A Matrix struct describing the block
+ */
+struct Matrix matrixView(struct Matrix* mat, int row, int col, int rows, int cols);
+
 /******************************************
  * Matrix allocation, initialization and utility functions
  *******************************************/
@@ -85,6 +118,9 @@ int nextPowerOfTwo(int n);
  * Helper functions for matrix operations
  * These functions typically operate on submatrices (blocks)
  * of larger matrices to support divide-and-conquer algorithms
+ *
+ * Every matrix argument is addressed through its leading dimension,
+ * so any of them may be a view created with matrixView
  **********************************************/
 
 /**
@@ -192,9 +228,91 @@ int copySubmatrix(struct Matrix* A, int rowA, int colA,
                   int blockSize);
 
 
+/**
+ * Rectangular versions of the helpers above
+ * Same operations on rows x cols blocks; the square helpers call them
+ * with rows = cols = blockSize
+ */
+int sumMatrixRect(struct Matrix* A, int rowA, int colA,
+                  struct Matrix* B, int rowB, int colB,
+                  struct Matrix* C, int rowC, int colC,
+                  int rows, int cols);
+int subMatrixRect(struct Matrix* A, int rowA, int colA,
+                  struct Matrix* B, int rowB, int colB,
+                  struct Matrix* C, int rowC, int colC,
+                  int rows, int cols);
+int addSubmatrixRect(struct Matrix* A, struct Matrix* B, int rowB, int colB, int rows, int cols);
+int subSubmatrixRect(struct Matrix* A, struct Matrix* B, int rowB, int colB, int rows, int cols);
+int copySubmatrixRect(struct Matrix* A, int rowA, int colA,
+                      struct Matrix* C, int rowC, int colC,
+                      int rows, int cols);
+
+/**
+ * Completes C = A * B after peeling the odd dimensions (dynamic peeling)
+ * With A m x k and B k x n, let m', k', n' be m, k, n rounded down to
+ * even. C[0:m'][0:n'] must already hold A[0:m'][0:k'] * B[0:k'][0:n'].
+ * The function adds the rank-1 update of the last column of A and the
+ * last row of B when k is odd, and computes the last column of C when n
+ * is odd and the last row when m is odd, in O(mn + mk + kn) operations.
+ *
+ * Used by the Strassen engines so that any shape can be multiplied
+ * without padding to a power of two
+ *
+ * @param A          First source matrix (m x k)
+ * @param B          Second source matrix (k x n)
+ * @param C          Destination matrix (m x n)
+ * @return           0 on success
+ */
+int peelUpdate(struct Matrix* A, struct Matrix* B, struct Matrix* C);
+
+/**********************************************
+ * SIMD dispatch for the helper functions
+ *
+ * sumMatrix, subMatrix, addSubmatrix, subSubmatrix, copySubmatrix and
+ * initMatrixZeros process their blocks one row at a time with SSE2,
+ * AVX2 or AVX-512 kernels. The widest instruction set supported by the
+ * CPU is chosen once at startup; the environment variable MATRIX_SIMD
+ * (scalar, sse2, avx2, avx512) caps it. Results are identical at
+ * every level.
+ **********************************************/
+
+/**
+ * Instruction sets available to the helper functions
+ */
+enum SimdLevel {
+    SIMD_SCALAR,   /* Portable C loops */
+    SIMD_SSE2,     /* 128-bit vectors */
+    SIMD_AVX2,     /* 256-bit vectors */
+    SIMD_AVX512    /* 512-bit vectors with masked tails */
+};
+
+/**
+ * Selects the instruction set used by the helper functions
+ *
+ * @param level  Requested SIMD level
+ * @return       0 on success, -1 if the CPU does not support it
+ */
+int setSimdLevel(enum SimdLevel level);
+
+/**
+ * Returns the instruction set currently used by the helper functions
+ *
+ * @return       Current SIMD level
+ */
+enum SimdLevel getSimdLevel(void);
+
+/**
+ * Returns a printable name for a SIMD level
+ *
+ * @param level  SIMD level
+ * @return       "scalar", "sse2", "avx2" or "avx512"
+ */
+const char* simdLevelName(enum SimdLevel level);
+
 /**
  * Performs conventional matrix multiplication
  * Computes C = A * B using the standard O(n³) algorithm
+ * A, B and C may be views with any leading dimension
  *
  * @param A      First input matrix
  * @param B      Second input matrix
@@ -203,6 +321,90 @@ int copySubmatrix(struct Matrix* A, int rowA, int colA,
  */
 struct Matrix* mul(struct Matrix* A, struct Matrix* B, struct Matrix* C);
 
+/*********************************************
+ * Cache-blocked, packed matrix multiplication
+ *
+ * Panels of A (MC x KC) and B (KC x NC) are packed into contiguous
+ * buffers sized for the L2 and L3 caches, and an MR x NR micro-kernel
+ * keeps its tile of C in registers while streaming a KC-deep sliver of
+ * packed B that stays in L1. The tile sizes can be overridden at
+ * compile time (e.g. -DGEMM_KC=512).
+ *********************************************/
+
+#ifndef GEMM_MR
+#define GEMM_MR 4      /* Rows of the register tile */
+#endif
+#ifndef GEMM_NR
+#define GEMM_NR 8      /* Columns of the register tile */
+#endif
+#ifndef GEMM_KC
+#define GEMM_KC 256    /* Depth of a packed sliver (L1 blocking) */
+#endif
+#ifndef GEMM_MC
+#define GEMM_MC 128    /* Rows of a packed A panel (L2 blocking) */
+#endif
+#ifndef GEMM_NC
+#define GEMM_NC 2048   /* Columns of a packed B panel (L3 blocking) */
+#endif
+
+/**
+ * Returns the number of bytes of packing buffers needed by mulBlocked_ws
+ *
+ * @param m      Rows of A and C
+ * @param n      Columns of B and C
+ * @param k      Columns of A / rows of B
+ * @return       Size of the packing buffers in bytes
+ */
+size_t gemmPackSize(int m, int n, int k);
+
+/**
+ * Performs blocked, packed matrix multiplication on caller-supplied buffers
+ * Computes C = A * B without any heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param workspace  Buffer of at least gemmPackSize(A->row, B->col, A->col) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* mulBlocked_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C, void* workspace);
+
+/**
+ * Performs blocked, packed matrix multiplication
+ * Computes C = A * B, same result as mul()
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix (must be pre-allocated)
+ * @return       Pointer to the result matrix C, NULL if the packing
+ *               buffers cannot be allocated
+ */
+struct Matrix* mulBlocked(struct Matrix* A, struct Matrix* B, struct Matrix* C);
+
+/**
+ * Leaf kernels available to the hybrid Strassen engine
+ */
+enum LeafKernel {
+    LEAF_NAIVE,    /* mul(): i-j-k triple loop */
+    LEAF_BLOCKED   /* mulBlocked(): packed, cache-blocked kernel */
+};
+
+/**
+ * Selects the kernel used by strassenMul_hybrid below the cutoff
+ * The selection also changes strassenWorkspaceSize for cutoff > 1, so
+ * arenas must be sized after the leaf has been chosen
+ *
+ * @param leaf   Leaf kernel (LEAF_NAIVE by default)
+ */
+void setHybridLeaf(enum LeafKernel leaf);
+
+/**
+ * Returns the kernel currently used by strassenMul_hybrid below the cutoff
+ *
+ * @return       Current leaf kernel
+ */
+enum LeafKernel getHybridLeaf(void);
+
 /*********************************************
  * Strassen algorithm with 3 temporary matrices
  *
@@ -225,21 +427,31 @@ struct Matrix* mul(struct Matrix* A, struct Matrix* B, struct Matrix* C);
  * C21 = P6 + P7
  * C22 = P2 − P3 + P5 − P7
  *
- * This algorithm works with squared matrices of size 2^n
- * For other sizes, padding is required
+ * This algorithm works with rectangular matrices of any size (A m x k,
+ * B k x n): when a dimension of a level is odd, the leading even blocks
+ * are multiplied recursively and the last row, column or rank-1 term is
+ * fixed up with peelUpdate (dynamic peeling), so no padding is required.
+ * When the largest dimension is at least twice the smallest, the level
+ * only halves that dimension (e.g. a tall-skinny A is cut into row
+ * blocks) until the shape is balanced enough for Strassen's formulas.
+ *
+ * A, B and C may be views: the quadrants of the inputs that appear
+ * alone in a product (A11, A22, B11, B22) are passed to the recursion
+ * as views instead of being copied
  *********************************************/
 
 /**
  * Performs Strassen's matrix multiplication algorithm
  * Computes C = A * B using the recursive divide-and-conquer approach
  *
- * Note: For optimal performance, matrices should have dimensions that are
- * powers of 2. If not, they are internally padded to the next power of 2.
+ * A is m x k and B is k x n with any m, k, n: odd dimensions are peeled
+ * at each level instead of being padded to the next power of 2.
  *
  * @param A      First input matrix
  * @param B      Second input matrix
  * @param C      Output matrix (must be pre-allocated)
- * @return       Pointer to the result matrix C
+ * @return       Pointer to the result matrix C, NULL if the workspace
+ *               arena cannot be allocated
  */
 struct Matrix* strassenMul(struct Matrix* A, struct Matrix* B, struct Matrix* C);
 
@@ -251,13 +463,670 @@ struct Matrix* strassenMul(struct Matrix* A, struct Matrix* B, struct Matrix* C)
  * This often provides better performance as the overhead of 
  * Strassen's algorithm is not beneficial for small matrices
  *
+ * When a runtime is installed with setHybridRuntime, the products of the
+ * top levels are spawned as stealable tasks (see strassenMul_runtime)
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication,
+ *                   or CUTOFF_AUTO to use the tuned profile (see profileCutoff)
+ * @return           Pointer to the result matrix C, NULL if the workspace
+ *                   arena cannot be allocated
+ */
+struct Matrix* strassenMul_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff);
+
+/**
+ * Zero-block detection in the Strassen engines
+ */
+enum ZeroSkip {
+    ZERO_SKIP_OFF,       /* Multiply every block (default) */
+    ZERO_SKIP_BLOCKS,    /* Each Strassen level skips the products of zero quadrants */
+    ZERO_SKIP_TRAILING   /* Also crop trailing zero rows and columns before the recursion */
+};
+
+/**
+ * Selects how the Strassen engines look for known-zero blocks
+ * With ZERO_SKIP_BLOCKS every level scans its eight quadrants (stopping
+ * at the first nonzero element) and drops the products that have a zero
+ * factor, the sums with a zero summand and the accumulation of skipped
+ * products. ZERO_SKIP_TRAILING also makes strassenMul_hybrid crop the
+ * trailing zero rows and columns of A and B (see nonzeroExtent), so
+ * matrices padded to a power of two run at their original size
+ *
+ * @param mode   Zero-block detection (ZERO_SKIP_OFF by default)
+ */
+void setZeroBlockSkip(enum ZeroSkip mode);
+
+/**
+ * Returns the zero-block detection used by the Strassen engines
+ * @return       Current mode
+ */
+enum ZeroSkip getZeroBlockSkip(void);
+
+/**
+ * Checks whether every element of a matrix is zero
+ * @param mat    Matrix or view to scan
+ * @return       1 if all elements are zero, 0 otherwise
+ */
+int isZeroMatrix(struct Matrix* mat);
+
+/**
+ * Returns the leading block of a matrix that holds all its nonzero elements
+ * @param mat    Matrix or view to scan
+ * @param rows   Receives the number of leading rows holding nonzeros
+ * @param cols   Receives the number of leading columns holding nonzeros
+ */
+void nonzeroExtent(struct Matrix* mat, int* rows, int* cols);
+
+/**
+ * Multiplies padded matrices whose data is in their leading blocks
+ * For drivers that pad to a power of two and know the original shape;
+ * no scan is needed. The rest of A and B must be zero, the rest of C
+ * is set to zero
+ *
+ * @param A          First input matrix, zero outside its leading m x k block
+ * @param B          Second input matrix, zero outside its leading k x n block
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication, or CUTOFF_AUTO
+ * @param m          Rows of A holding data
+ * @param k          Columns of A / rows of B holding data
+ * @param n          Columns of B holding data
+ * @return           Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMul_padded(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                                  int m, int k, int n);
+
+/*********************************************
+ * Workspace arena
+ *
+ * strassenMul and strassenMul_hybrid need three newSide x newSide
+ * temporaries (temp1, temp2, P) at every recursion level. Instead of
+ * allocating them on every call, all temporaries are sliced by depth
+ * from one arena. strassenMul / strassenMul_hybrid allocate the arena
+ * once per multiplication; the _ws entry points take a caller-supplied
+ * arena and perform no heap allocation at all.
+ *********************************************/
+
+/**
+ * Returns the exact number of bytes of workspace needed to multiply
+ * two side x side matrices with the given cutoff
+ * Use cutoff = 1 for the pure Strassen engine (strassenMul_ws)
+ * With the blocked leaf selected, the packing buffers of the leaf
+ * multiplication are included
+ *
+ * @param side       Side length of the input matrices
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return           Size of the workspace arena in bytes (0 if no recursion happens)
+ */
+size_t strassenWorkspaceSize(int side, int cutoff);
+
+/**
+ * Returns the exact number of bytes of workspace needed to multiply an
+ * m x k matrix by a k x n matrix with the given cutoff
+ * strassenWorkspaceSize(side, cutoff) is the m = k = n case
+ *
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Strassen),
+ *                   or CUTOFF_AUTO to use the tuned profile
+ * @return           Size of the workspace arena in bytes
+ */
+size_t strassenWorkspaceSizeRect(int m, int k, int n, int cutoff);
+
+/**
+ * Performs Strassen's matrix multiplication on a caller-supplied arena
+ * Same result as strassenMul, without any heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param workspace  Arena of at least strassenWorkspaceSizeRect(A->row, A->col, B->col, 1) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* strassenMul_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C, void* workspace);
+
+/**
+ * Performs hybrid Strassen multiplication on a caller-supplied arena
+ * Same result as strassenMul_hybrid, without any heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication,
+ *                   or CUTOFF_AUTO to use the tuned profile
+ * @param workspace  Arena of at least strassenWorkspaceSizeRect(A->row, A->col, B->col, cutoff) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* strassenMul_hybrid_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                     int cutoff, void* workspace);
+
+/*********************************************
+ * Squaring and matrix power
+ *
+ * With B == A the operand sums of Strassen's products repeat
+ * (A11 + A22 is both operands of P2, A12 - A22 is shared by P1 and P5,
+ * and so on), so a squaring level forms 5 sums instead of 10 and
+ * recurses on P2 as a square. It uses the same arena as the hybrid
+ * engine (strassenWorkspaceSize).
+ *
+ * matrixPower computes A^k by binary exponentiation on the squaring
+ * path, ping-ponging between C and one buffer of its workspace: no
+ * allocation per step. Intended for repeated products such as graph
+ * reachability or Markov chains.
+ *********************************************/
+
+/**
+ * Computes C = A * A with the squaring path
+ *
+ * @param A          Input matrix (square)
+ * @param C          Output matrix (must be pre-allocated, must not overlap A)
+ * @param cutoff     Size threshold below which to use conventional multiplication,
+ *                   or CUTOFF_AUTO to use the tuned profile
+ * @return           Pointer to the result matrix C, NULL if A is not square
+ *                   or the workspace arena cannot be allocated
+ */
+struct Matrix* strassenSquare(struct Matrix* A, struct Matrix* C, int cutoff);
+
+/**
+ * Computes C = A * A with the squaring path on a caller-supplied arena
+ *
+ * @param A          Input matrix (square)
+ * @param C          Output matrix (must be pre-allocated, must not overlap A)
+ * @param cutoff     Size threshold below which to use conventional multiplication,
+ *                   or CUTOFF_AUTO to use the tuned profile
+ * @param workspace  Arena of at least strassenWorkspaceSize(A->row, cutoff) bytes
+ * @return           Pointer to the result matrix C, NULL if A is not square
+ */
+struct Matrix* strassenSquare_ws(struct Matrix* A, struct Matrix* C, int cutoff, void* workspace);
+
+/**
+ * Returns the number of bytes of workspace needed by matrixPower_ws
+ *
+ * @param side       Side length of A
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return           Size of the workspace in bytes
+ */
+size_t matrixPowerWorkspaceSize(int side, int cutoff);
+
+/**
+ * Computes C = A^k by binary exponentiation
+ * Performs ceil(log2(k + 1)) - 1 squarings and one product by A per
+ * further set bit of k
+ *
+ * @param A          Input matrix (square)
+ * @param k          Exponent, A^0 is the identity
+ * @param C          Output matrix (must be pre-allocated, must not overlap A)
+ * @param cutoff     Size threshold below which to use conventional multiplication,
+ *                   or CUTOFF_AUTO to use the tuned profile
+ * @return           Pointer to the result matrix C, NULL if A is not square,
+ *                   k < 0 or the workspace cannot be allocated
+ */
+struct Matrix* matrixPower(struct Matrix* A, int k, struct Matrix* C, int cutoff);
+
+/**
+ * Computes C = A^k on a caller-supplied workspace
+ * Performs no heap allocation
+ *
+ * @param A          Input matrix (square)
+ * @param k          Exponent, A^0 is the identity
+ * @param C          Output matrix (must be pre-allocated, must not overlap A)
+ * @param cutoff     Size threshold below which to use conventional multiplication,
+ *                   or CUTOFF_AUTO to use the tuned profile
+ * @param workspace  Buffer of at least matrixPowerWorkspaceSize(A->row, cutoff) bytes
+ * @return           Pointer to the result matrix C, NULL if A is not square or k < 0
+ */
+struct Matrix* matrixPower_ws(struct Matrix* A, int k, struct Matrix* C, int cutoff, void* workspace);
+
+/*********************************************
+ * Matrix-chain multiplication
+ *
+ * chainMul multiplies M1 * M2 * ... * Mn in the order that minimises a
+ * cost model of the hybrid engine (strassenCost) rather than m*k*n,
+ * found by dynamic programming over the split points. Intermediate
+ * products live in a pool of recycled buffers, sized together with the
+ * Strassen arena before the first product: one allocation per chain.
+ *********************************************/
+
+/**
+ * Model costs of a chain, filled by chainMul
+ */
+struct ChainReport {
+    double plannedCost;         /* Cost of the order chosen by chainPlan */
+    double leftToRightCost;     /* Cost of ((M1 * M2) * M3) * ... */
+    size_t bufferBytes;         /* Intermediate buffers plus Strassen arena */
+};
+
+/**
+ * Returns the model cost of an m x k by k x n product with the hybrid engine
+ * Follows the recursion of strassenMul_hybrid (peeled, halved and Strassen
+ * levels) and counts the scalar additions and multiplications, so it
+ * grows as n^2.807 above the cutoff and as n^3 below it
+ *
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine
+ * @return           Number of scalar operations
+ */
+double strassenCost(int m, int k, int n, int cutoff);
+
+/**
+ * Chooses the cheapest parenthesisation of a chain under strassenCost
+ *
+ * @param dims       count + 1 dimensions, matrix i is dims[i] x dims[i + 1]
+ * @param count      Number of matrices
+ * @param cutoff     Size threshold of the hybrid engine
+ * @param split      Receives count * count entries (may be NULL): the product
+ *                   of matrices i..j is (i..s) * (s+1..j) with s = split[i * count + j]
+ * @return           Model cost of the plan, -1 if a buffer cannot be allocated
+ */
+double chainPlan(const int* dims, int count, int cutoff, int* split);
+
+/**
+ * Multiplies a chain of matrices in the order chosen by chainPlan
+ *
+ * @param mats       Array of count matrices, mats[i]->col == mats[i + 1]->row
+ * @param count      Number of matrices
+ * @param C          Output matrix, mats[0]->row x mats[count - 1]->col
+ *                   (must be pre-allocated, must not overlap the inputs)
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ *                   to use the tuned profile
+ * @param report     Receives the planned and left-to-right costs (may be NULL)
+ * @return           Pointer to the result matrix C, NULL if the shapes do not
+ *                   chain or the buffers cannot be allocated
+ */
+struct Matrix* chainMul(struct Matrix** mats, int count, struct Matrix* C, int cutoff,
+                        struct ChainReport* report);
+
+/*********************************************
+ * Strassen-Winograd algorithm with 2 temporary matrices
+ *
+ * Same 7 recursive products as Strassen's algorithm, but the sums are
+ * shared so that a level needs 15 block additions instead of 18:
+ *
+ * S1 = A21 + A22     T1 = B12 - B11
+ * S2 = S1 - A11      T2 = B22 - T1
+ * S3 = A11 - A21     T3 = B22 - B12
+ * S4 = A12 - S2      T4 = T2 - B21
+ *
+ * P1 = A11 * B11     P5 = S1 * T1
+ * P2 = A12 * B21     P6 = S2 * T2
+ * P3 = S4 * B22      P7 = S3 * T3
+ * P4 = A22 * T4
+ *
+ * C11 = P1 + P2              C12 = P1 + P6 + P5 + P3
+ * C21 = P1 + P6 + P7 - P4    C22 = P1 + P6 + P7 + P5
+ *
+ * The schedule keeps intermediate results in the quadrants of C, so a
+ * level only needs two temporaries (one for A, one for B) instead of
+ * three. Odd sides are peeled as in strassenMul, and results are
+ * identical to strassenMul. C must not overlap A or B.
+ *********************************************/
+
+/**
+ * Returns the exact number of bytes of workspace needed by the
+ * Winograd engines for two side x side matrices
+ * Use cutoff = 1 for the pure engine (winogradMul_ws)
+ *
+ * @param side       Side length of the input matrices
+ * @param cutoff     Size threshold of the hybrid engine
+ * @return           Size of the workspace arena in bytes (0 if no recursion happens)
+ */
+size_t winogradWorkspaceSize(int side, int cutoff);
+
+/**
+ * Returns the exact number of bytes of workspace needed by the Winograd
+ * engines for an m x k by k x n product
+ *
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Winograd)
+ * @return           Size of the workspace arena in bytes
+ */
+size_t winogradWorkspaceSizeRect(int m, int k, int n, int cutoff);
+
+/**
+ * Performs Strassen-Winograd multiplication
+ * Computes C = A * B for matrices of any shape (A m x k, B k x n)
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix (must be pre-allocated)
+ * @return       Pointer to the result matrix C, NULL if the workspace
+ *               arena cannot be allocated
+ */
+struct Matrix* winogradMul(struct Matrix* A, struct Matrix* B, struct Matrix* C);
+
+/**
+ * Hybrid Strassen-Winograd multiplication
+ * Switches to the leaf kernel selected with setHybridLeaf below the cutoff
+ *
  * @param A          First input matrix
  * @param B          Second input matrix
  * @param C          Output matrix (must be pre-allocated)
  * @param cutoff     Size threshold below which to use conventional multiplication
+ * @return           Pointer to the result matrix C, NULL if the workspace
+ *                   arena cannot be allocated
+ */
+struct Matrix* winogradMul_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff);
+
+/**
+ * Performs Strassen-Winograd multiplication on a caller-supplied arena
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param workspace  Arena of at least winogradWorkspaceSizeRect(A->row, A->col, B->col, 1) bytes
  * @return           Pointer to the result matrix C
  */
-struct Matrix* strassenMul_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff);
+struct Matrix* winogradMul_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C, void* workspace);
+
+/**
+ * Performs hybrid Strassen-Winograd multiplication on a caller-supplied arena
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication
+ * @param workspace  Arena of at least winogradWorkspaceSizeRect(A->row, A->col, B->col, cutoff) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* winogradMul_hybrid_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                     int cutoff, void* workspace);
+
+/*********************************************
+ * Task-parallel Strassen engine
+ *
+ * The seven products of the top `depth` recursion levels are spawned
+ * as stealable tasks on the work-stealing runtime (workstealing.h);
+ * every task has its own operands, result and workspace. Products that
+ * need more than one accumulation into C are combined after all seven
+ * have finished, in the serial order, so the result equals
+ * strassenMul_hybrid's. Below `depth` every task runs
+ * strassenMul_hybrid_ws; non-square products are not split in parallel.
+ *********************************************/
+
+struct TaskRuntime;
+
+/**
+ * Returns the exact number of bytes of workspace needed by
+ * strassenMul_parallel_ws for square inputs
+ * A non-square product runs serially and needs strassenWorkspaceSizeRect
+ *
+ * @param side       Side length of the input matrices
+ * @param cutoff     Size threshold of the hybrid engine
+ * @param depth      Number of recursion levels run in parallel
+ * @return           Size of the workspace arena in bytes
+ */
+size_t strassenParallelWorkspaceSize(int side, int cutoff, int depth);
+
+/**
+ * Performs task-parallel hybrid Strassen multiplication on a caller-supplied arena
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication
+ * @param threads    Number of worker threads started for the call; the
+ *                   calling thread only waits for the result
+ * @param depth      Number of recursion levels whose products run in parallel
+ * @param workspace  Arena of at least strassenParallelWorkspaceSize(A->row, cutoff, depth) bytes
+ * @return           Pointer to the result matrix C, NULL if the pool cannot be created
+ */
+struct Matrix* strassenMul_parallel_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                       int cutoff, int threads, int depth, void* workspace);
+
+/**
+ * Performs task-parallel hybrid Strassen multiplication
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication
+ * @param threads    Number of worker threads started for the call; the
+ *                   calling thread only waits for the result
+ * @param depth      Number of recursion levels whose products run in parallel
+ * @return           Pointer to the result matrix C, NULL on allocation failure
+ */
+struct Matrix* strassenMul_parallel(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                    int cutoff, int threads, int depth);
+
+/**
+ * Performs task-parallel hybrid Strassen multiplication on an existing
+ * runtime and a caller-supplied arena
+ *
+ * @param rt         Work-stealing runtime (see runtimeCreate)
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication
+ * @param depth      Number of recursion levels whose products are spawned as tasks
+ * @param workspace  Arena of at least strassenParallelWorkspaceSize(A->row, cutoff, depth) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* strassenMul_runtime_ws(struct TaskRuntime* rt, struct Matrix* A, struct Matrix* B,
+                                      struct Matrix* C, int cutoff, int depth, void* workspace);
+
+/**
+ * Performs task-parallel hybrid Strassen multiplication on an existing runtime
+ *
+ * @param rt         Work-stealing runtime (see runtimeCreate)
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which to use conventional multiplication
+ * @param depth      Number of recursion levels whose products are spawned as tasks
+ * @return           Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMul_runtime(struct TaskRuntime* rt, struct Matrix* A, struct Matrix* B,
+                                   struct Matrix* C, int cutoff, int depth);
+
+/**
+ * Makes strassenMul_hybrid spawn the products of its top `depth` levels
+ * as stealable tasks on a runtime
+ * Pass rt = NULL (or depth = 0) to go back to serial execution.
+ * The runtime must outlive every call to strassenMul_hybrid made with it.
+ *
+ * @param rt         Work-stealing runtime, or NULL
+ * @param depth      Number of recursion levels whose products are spawned as tasks
+ */
+void setHybridRuntime(struct TaskRuntime* rt, int depth);
+
+/*********************************************
+ * Batched multiplication
+ *
+ * Many independent products C[i] = A[i] * B[i] in one call. The batch
+ * is cut into chunks spawned as tasks on a work-stealing runtime (or run
+ * serially with rt = NULL); every chunk reuses one slot of a single
+ * workspace arena for all its items. Each item runs
+ * strassenMul_hybrid_ws, so items with a dimension <= cutoff go straight
+ * to the leaf kernel and larger ones run hybrid Strassen.
+ *********************************************/
+
+/**
+ * Returns the number of bytes of workspace needed by strassenMulBatch_ws
+ *
+ * @param rt         Work-stealing runtime, NULL for serial execution
+ * @param A          Array of count left operands
+ * @param B          Array of count right operands
+ * @param count      Number of products
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return           Size of the workspace arena in bytes
+ */
+size_t strassenBatchWorkspaceSize(struct TaskRuntime* rt, struct Matrix** A, struct Matrix** B,
+                                  int count, int cutoff);
+
+/**
+ * Multiplies a batch of independent products on a caller-supplied arena
+ *
+ * @param rt         Work-stealing runtime, NULL for serial execution
+ * @param A          Array of count left operands (any shapes)
+ * @param B          Array of count right operands
+ * @param C          Array of count results (must be pre-allocated)
+ * @param count      Number of products
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @param workspace  Arena of at least strassenBatchWorkspaceSize(rt, A, B, count, cutoff) bytes
+ * @return           0 on success
+ */
+int strassenMulBatch_ws(struct TaskRuntime* rt, struct Matrix** A, struct Matrix** B, struct Matrix** C,
+                        int count, int cutoff, void* workspace);
+
+/**
+ * Multiplies a batch of independent products
+ *
+ * @param rt         Work-stealing runtime, NULL for serial execution
+ * @param A          Array of count left operands (any shapes)
+ * @param B          Array of count right operands
+ * @param C          Array of count results (must be pre-allocated)
+ * @param count      Number of products
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return           0 on success, -1 if the arena cannot be allocated
+ */
+int strassenMulBatch(struct TaskRuntime* rt, struct Matrix** A, struct Matrix** B, struct Matrix** C,
+                     int count, int cutoff);
+
+/**
+ * Multiplies a batch of same-shape products stored back to back
+ * Item i is the m x k matrix at A + i*m*k, the k x n matrix at B + i*k*n
+ * and the m x n result at C + i*m*n, all row-major without padding
+ *
+ * @param rt         Work-stealing runtime, NULL for serial execution
+ * @param A          Buffer of count left operands
+ * @param B          Buffer of count right operands
+ * @param C          Buffer of count results
+ * @param m          Rows of every A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of every B and C
+ * @param count      Number of products
+ * @param cutoff     Size threshold of the hybrid engine, or CUTOFF_AUTO
+ * @return           0 on success, -1 if the arena cannot be allocated
+ */
+int strassenMulBatchStrided(struct TaskRuntime* rt, int* A, int* B, int* C,
+                            int m, int k, int n, int count, int cutoff);
+
+/*********************************************
+ * Z-order (Morton) layout
+ *
+ * A MortonMatrix stores its four quadrants one after the other
+ * (Q11, Q12, Q21, Q22), recursively, down to tile x tile blocks kept in
+ * row-major order. Every block of a Strassen recursion is then a single
+ * contiguous range, found by pointer arithmetic, and every addition is
+ * one kernel call over the whole block. The padded side is
+ * tile * 2^levels; the padding is zero.
+ *********************************************/
+
+struct MortonMatrix {
+    int* data;   /* side * side elements in Morton order */
+    int n;       /* Logical side length */
+    int side;    /* Padded side length, tile * 2^levels */
+    int tile;    /* Side of the row-major leaf blocks */
+};
+
+/**
+ * Returns the tile side used to store a side x side matrix in Morton order
+ *
+ * @param side       Side length of the matrix
+ * @param maxTile    Largest allowed tile side (usually the hybrid cutoff)
+ * @return           Tile side, at most maxTile
+ */
+int mortonTileSize(int side, int maxTile);
+
+/**
+ * Allocates a matrix in Morton layout
+ *
+ * @param side       Side length of the matrix
+ * @param maxTile    Largest allowed tile side (usually the hybrid cutoff)
+ * @return           Morton matrix (data is NULL on allocation failure)
+ */
+struct MortonMatrix allocMorton(int side, int maxTile);
+
+/**
+ * Frees a matrix in Morton layout
+ *
+ * @param mat   Matrix to free
+ */
+void freeMorton(struct MortonMatrix* mat);
+
+/**
+ * Converts a row-major matrix (or view) of side dst->n to Morton layout
+ *
+ * @param src   Row-major source matrix
+ * @param dst   Morton destination matrix
+ * @return      0 on success
+ */
+int toMorton(struct Matrix* src, struct MortonMatrix* dst);
+
+/**
+ * Converts a Morton matrix back to a row-major matrix (or view) of side src->n
+ *
+ * @param src   Morton source matrix
+ * @param dst   Row-major destination matrix
+ * @return      0 on success
+ */
+int fromMorton(struct MortonMatrix* src, struct Matrix* dst);
+
+/**
+ * Returns the number of bytes of workspace needed by strassenMul_morton_ws
+ *
+ * @param side       Padded side of the Morton matrices
+ * @param tile       Tile side
+ * @return           Size of the workspace arena in bytes
+ */
+size_t strassenMortonWorkspaceSize(int side, int tile);
+
+/**
+ * Performs hybrid Strassen multiplication on Morton matrices and a
+ * caller-supplied arena; the tiles are multiplied by the hybrid leaf
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix, same side and tile as A and B
+ * @param workspace  Arena of at least strassenMortonWorkspaceSize(A->side, A->tile) bytes
+ * @return           Pointer to the result matrix C, NULL if the shapes do not match
+ */
+struct MortonMatrix* strassenMul_morton_ws(struct MortonMatrix* A, struct MortonMatrix* B,
+                                           struct MortonMatrix* C, void* workspace);
+
+/**
+ * Performs hybrid Strassen multiplication on Morton matrices
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix, same side and tile as A and B
+ * @return       Pointer to the result matrix C, NULL if the shapes do not match
+ *               or the arena cannot be allocated
+ */
+struct MortonMatrix* strassenMul_morton(struct MortonMatrix* A, struct MortonMatrix* B,
+                                        struct MortonMatrix* C);
+
+/**
+ * Multiplies square row-major matrices through the Morton engine
+ * Converts A and B, multiplies, and converts the result back into C
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Largest tile side
+ * @return           Pointer to the result matrix C, NULL if A, B and C are not
+ *                   square of the same side or on allocation failure
+ */
+struct Matrix* strassenMul_viaMorton(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff);
+
+/*********************************************
+ * Cutoff tuning
+ *
+ * findOptimalCutoff times the hybrid engine in-process (pinned to one
+ * core, warm-up runs, fastest of several trials). tuneCutoffProfile
+ * stores the best cutoff per size band in a profile file, which
+ * strassenMul_hybrid uses when called with cutoff CUTOFF_AUTO.
+ *********************************************/
+
+#define CUTOFF_AUTO 0                           /* Take the cutoff from the loaded profile */
+#define CUTOFF_DEFAULT 64                       /* Cutoff used by CUTOFF_AUTO without a profile */
+#define CUTOFF_PROFILE_ENV "STRASSEN_CUTOFF_PROFILE" /* Profile loaded on first use of CUTOFF_AUTO */
 
 /**
  * Function to find the optimal cutoff value for hybrid Strassen algorithm
@@ -267,9 +1136,211 @@ struct Matrix* strassenMul_hybrid(struct Matrix* A, struct Matrix* B, struct Mat
  * @param maxCutoff       Maximum cutoff value to test
  * @param step            Step size between cutoff values
  * @param originalSide    Original matrix size
- * @param paddedSide      Padded matrix size (power of 2)
- * @return                The cutoff value that produced the fastest execution time
+ * @param paddedSide      Allocated matrix size (originalSide when not padding)
+ * @return                The cutoff value that produced the fastest execution time,
+ *                        -1 on allocation failure, -2 if no cutoff >= 1 lies in
+ *                        [minCutoff, maxCutoff]
  */
 int findOptimalCutoff(int minCutoff, int maxCutoff, int step, int originalSide, int paddedSide);
 
+/**
+ * Tunes the cutoff for each size with findOptimalCutoff and writes a profile
+ * Each side is the upper bound of a band; sides above the last band use
+ * its cutoff. The profile is tuned for the leaf selected with setHybridLeaf.
+ *
+ * @param path        Profile file to write
+ * @param sides       Sides to tune, in increasing order
+ * @param count       Number of sides (at most 32)
+ * @param minCutoff   Minimum cutoff value to test
+ * @param maxCutoff   Maximum cutoff value to test
+ * @param step        Step size between cutoff values
+ * @return            0 on success, -1 on allocation failure or if the file cannot
+ *                    be written, -2 for invalid sides or an empty cutoff range
+ */
+int tuneCutoffProfile(const char* path, const int* sides, int count,
+                      int minCutoff, int maxCutoff, int step);
+
+/**
+ * Loads a profile written by tuneCutoffProfile
+ * Call it before any multiplication runs concurrently.
+ *
+ * @param path   Profile file to read
+ * @return       0 on success, -1 if the file cannot be read or is malformed
+ */
+int loadCutoffProfile(const char* path);
+
+/**
+ * Returns the cutoff of the loaded profile for a size
+ * The first call loads the file named by $STRASSEN_CUTOFF_PROFILE when no
+ * profile has been loaded yet.
+ *
+ * @param side   Largest dimension of the product
+ * @return       Cutoff of the band containing side, CUTOFF_DEFAULT without a profile
+ */
+int profileCutoff(int side);
+
+/*********************************************
+ * Probabilistic verification (Freivalds)
+ *
+ * Checks a product in O(mk + kn + mn) per round instead of recomputing
+ * it: A (B x) is compared with C x for random 0/1 vectors x, modulo 2^32
+ * like the engines. A wrong product passes a round with probability at
+ * most 1/2, so the number of rounds follows from the accepted
+ * false-positive rate. A failed round is a proof that C is wrong.
+ * The drivers run it after the product with --verify[=<bound>].
+ *********************************************/
+
+#define VERIFY_DEFAULT_BOUND 1e-9   /* False-positive bound of --verify, 30 rounds */
+
+/**
+ * Returns the number of rounds needed for a false-positive bound
+ *
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @return               Rounds r with 2^-r <= falsePositive, -1 unless 0 < falsePositive < 1
+ */
+int freivaldsRounds(double falsePositive);
+
+/**
+ * Checks C = A * B with Freivalds' algorithm
+ * A, B and C may be views with any leading dimension
+ *
+ * @param A              First operand (m x k)
+ * @param B              Second operand (k x n)
+ * @param C              Product to check (m x n)
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is certainly wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int verifyProduct(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                  double falsePositive, unsigned long long seed);
+
+/**
+ * Checks C = M1 * M2 * ... * Mcount with Freivalds' algorithm
+ * The vectors go through the factors from right to left, so a round
+ * costs one matrix-vector product per factor and one with C
+ *
+ * @param mats           Factors of the chain
+ * @param count          Number of factors (at least 1)
+ * @param C              Product to check
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is certainly wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int verifyChainProduct(struct Matrix** mats, int count, struct Matrix* C,
+                       double falsePositive, unsigned long long seed);
+
+/**
+ * Checks C = A * B with a seed taken from the clock and the process id
+ * and prints one line with the outcome, the rounds, the seed and the time
+ *
+ * @param out            Output stream of the report line
+ * @param A              First operand (m x k)
+ * @param B              Second operand (k x n)
+ * @param C              Product to check (m x n)
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @return               0 if C passed, -1 if it failed or could not be checked
+ */
+int verifyProductReport(FILE* out, struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                        double falsePositive);
+
+/**
+ * Extracts --verify or --verify=<bound> from the arguments of a driver
+ * The option is removed from argv and argc is updated, like parseMatrixFileArgs
+ *
+ * @param argc           Number of arguments, updated
+ * @param argv           Arguments, compacted in place
+ * @param falsePositive  Receives the bound: VERIFY_DEFAULT_BOUND for --verify, 0 without the option
+ * @return               0 on success, -1 if the bound is not in (0, 1)
+ */
+int parseVerifyArg(int* argc, char* argv[], double* falsePositive);
+
+/*********************************************
+ * Arithmetic modulo a prime
+ *
+ * Products over the field of integers modulo an odd prime p < 2^31,
+ * chosen at run time. Matrices hold residues (0 <= x < p) in their int
+ * elements. Strassen operands are reduced only when their bound could
+ * overflow the leaf accumulators, and the leaf reduces its 64-bit sums
+ * with Montgomery's method (see modular.c).
+ *********************************************/
+
+/**
+ * Constants of the reductions modulo p, prepared by modFieldInit
+ */
+struct ModField {
+    uint32_t p;           /* Odd prime, 3 <= p < 2^31 */
+    uint32_t pinv;        /* -p^-1 mod 2^32, for Montgomery reductions */
+    uint32_t r3;          /* 2^96 mod p, removes the Montgomery factors of the leaf */
+    uint32_t barrett;     /* floor(2^32 / p), for Barrett reductions */
+    uint32_t lazyLimit;   /* Largest operand bound, in multiples of p, kept without reduction */
+};
+
+/**
+ * Prepares the constants of the reductions modulo a prime
+ * @param field  Field to initialize
+ * @param p      Odd prime, 3 <= p < 2^31
+ * @return       0 on success, -1 if p is not an odd prime below 2^31
+ */
+int modFieldInit(struct ModField* field, uint32_t p);
+
+/**
+ * Sets every element of a matrix to its residue modulo p
+ * @param mat    Matrix or view, any int values
+ * @param field  Prime field
+ */
+void reduceMatrixMod(struct Matrix* mat, const struct ModField* field);
+
+/**
+ * Fills a matrix with uniformly distributed residues modulo p
+ * @param mat    Matrix or view
+ * @param field  Prime field
+ * @param seed   Seed of the generator
+ */
+void fillMatrixRandMod(struct Matrix* mat, const struct ModField* field, unsigned long long seed);
+
+/**
+ * Conventional multiplication modulo p with the vectorized leaf kernel
+ * The 64-bit sums are reduced only when they could overflow
+ *
+ * @param A      First input matrix (m x k), residues
+ * @param B      Second input matrix (k x n), residues
+ * @param C      Output matrix (m x n), may be a view
+ * @param field  Prime field
+ * @return       Pointer to the result matrix C
+ */
+struct Matrix* mulMod(struct Matrix* A, struct Matrix* B, struct Matrix* C, const struct ModField* field);
+
+/**
+ * Hybrid Strassen multiplication modulo p
+ * Any shape: odd dimensions are peeled as in strassenMul_hybrid
+ *
+ * @param A      First input matrix (m x k), residues
+ * @param B      Second input matrix (k x n), residues
+ * @param C      Output matrix (m x n), may be a view
+ * @param cutoff Size threshold below which mulMod's kernel is used
+ * @param field  Prime field
+ * @return       Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMulMod_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                                     const struct ModField* field);
+
+/**
+ * Checks C = A * B mod p with Freivalds' algorithm over the field
+ * Each round uses a vector of uniform residues and passes a wrong
+ * product with probability at most 1/p
+ *
+ * @param A              First operand (m x k), residues
+ * @param B              Second operand (k x n), residues
+ * @param C              Product to check (m x n)
+ * @param field          Prime field
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is certainly wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int verifyProductMod(struct Matrix* A, struct Matrix* B, struct Matrix* C, const struct ModField* field,
+                     double falsePositive, unsigned long long seed);
+
 #endif /* matrix_H_ */
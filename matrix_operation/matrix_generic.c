@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <float.h>
+#include "matrix_generic.h"
+
+/******************************************
+ * Typed matrix families
+ *
+ * Instantiates matrix_template.inc for int64_t, float and double.
+ * The int32 family is the hand-written engine of matrix.c.
+ *******************************************/
+
+/* Maximum random value, same as MaxRandVal in matrix.c */
+#define GENERIC_MAX_RAND 9
+
+/**
+ * Returns the larger of two ints
+ * @param a      First value
+ * @param b      Second value
+ * @return       max(a, b)
+ */
+static int genericMax(int a, int b) {
+    return a > b ? a : b;
+}
+
+/**
+ * Returns the smaller of two ints
+ * @param a      First value
+ * @param b      Second value
+ * @return       min(a, b)
+ */
+static int genericMin(int a, int b) {
+    return a < b ? a : b;
+}
+
+/**
+ * Returns the next value of a splitmix64 generator
+ * @param state  Generator state, updated
+ * @return       64 random bits
+ */
+static uint64_t genericRandom(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+#define MATRIX_TYPE int64_t
+#define MATRIX_NAME MatrixI64
+#define MATRIX_SUFFIX _i64
+#define MATRIX_FORMAT "%6" PRId64
+#define MATRIX_EPSILON 0
+#include "matrix_template.inc"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_SUFFIX
+#undef MATRIX_FORMAT
+#undef MATRIX_EPSILON
+
+#define MATRIX_TYPE float
+#define MATRIX_NAME MatrixF32
+#define MATRIX_SUFFIX _f32
+#define MATRIX_FORMAT "%8.3f"
+#define MATRIX_EPSILON FLT_EPSILON
+#include "matrix_template.inc"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_SUFFIX
+#undef MATRIX_FORMAT
+#undef MATRIX_EPSILON
+
+#define MATRIX_TYPE double
+#define MATRIX_NAME MatrixF64
+#define MATRIX_SUFFIX _f64
+#define MATRIX_FORMAT "%8.3f"
+#define MATRIX_EPSILON DBL_EPSILON
+#include "matrix_template.inc"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_SUFFIX
+#undef MATRIX_FORMAT
+#undef MATRIX_EPSILON
@@ -0,0 +1,106 @@
+#ifndef matrix_generic_H_
+#define matrix_generic_H_
+
+#include <stdint.h>
+#include "matrix.h"
+
+/*********************************************
+ * Type-generic matrices
+ *
+ * The int engines of matrix.h (struct Matrix) are the int32 family.
+ * matrix_template.h is instantiated here for three more element types,
+ * each with its own struct and _suffixed functions:
+ *
+ *   int64_t   struct MatrixI64   allocMatrix_i64, strassenMul_i64, ...
+ *   float     struct MatrixF32   allocMatrix_f32, strassenMul_f32, ...
+ *   double    struct MatrixF64   allocMatrix_f64, strassenMul_f64, ...
+ *
+ * The macros at the end of this file pick the right function from the
+ * type of their first argument (_Generic), e.g. matStrassenMulHybrid(&A,
+ * &B, &C, 64) works for a struct Matrix as well as for a struct MatrixF64.
+ *
+ * The typed engines use a leaf written for auto-vectorization rather
+ * than the packed int kernel, and no runtime SIMD dispatch: build with
+ * -O3 (and -march=native to get the widest vectors).
+ *********************************************/
+
+#ifndef GENERIC_LEAF_KC
+#define GENERIC_LEAF_KC 256    /* Rows of the panel of B reused by the leaf */
+#endif
+#ifndef GENERIC_LEAF_NC
+#define GENERIC_LEAF_NC 512    /* Columns of the panel of B reused by the leaf */
+#endif
+#ifndef GENERIC_VERIFY_SLACK
+#define GENERIC_VERIFY_SLACK 1   /* Rounding slack of verifyProduct for floating-point families */
+#endif
+
+#define MATRIX_CAT_(a, b) a##b
+#define MATRIX_CAT(a, b) MATRIX_CAT_(a, b)
+#define MATRIX_FN(name) MATRIX_CAT(name, MATRIX_SUFFIX)
+
+#define MATRIX_TYPE int64_t
+#define MATRIX_NAME MatrixI64
+#define MATRIX_SUFFIX _i64
+#include "matrix_template.h"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_SUFFIX
+
+#define MATRIX_TYPE float
+#define MATRIX_NAME MatrixF32
+#define MATRIX_SUFFIX _f32
+#include "matrix_template.h"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_SUFFIX
+
+#define MATRIX_TYPE double
+#define MATRIX_NAME MatrixF64
+#define MATRIX_SUFFIX _f64
+#include "matrix_template.h"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_SUFFIX
+
+/**
+ * Selects the function of the family of a matrix pointer
+ * fn32 takes a struct Matrix*, the others the typed structs
+ */
+#define MATRIX_GENERIC(mat, fn32, fn64, fnF32, fnF64) \
+    _Generic((mat),                                   \
+             struct Matrix*: fn32,                    \
+             struct MatrixI64*: fn64,                 \
+             struct MatrixF32*: fnF32,                \
+             struct MatrixF64*: fnF64)
+
+/* Conventional multiplication C = A * B */
+#define matMul(A, B, C) \
+    MATRIX_GENERIC(A, mul, mul_i64, mul_f32, mul_f64)(A, B, C)
+
+/* Pure Strassen C = A * B */
+#define matStrassenMul(A, B, C) \
+    MATRIX_GENERIC(A, strassenMul, strassenMul_i64, strassenMul_f32, strassenMul_f64)(A, B, C)
+
+/* Hybrid Strassen C = A * B with a cutoff */
+#define matStrassenMulHybrid(A, B, C, cutoff) \
+    MATRIX_GENERIC(A, strassenMul_hybrid, strassenMul_hybrid_i64, \
+                   strassenMul_hybrid_f32, strassenMul_hybrid_f64)(A, B, C, cutoff)
+
+/* Freivalds check of C = A * B, 1 passed, 0 wrong, -1 not checked */
+#define matVerifyProduct(A, B, C, falsePositive, seed) \
+    MATRIX_GENERIC(A, verifyProduct, verifyProduct_i64, verifyProduct_f32, \
+                   verifyProduct_f64)(A, B, C, falsePositive, seed)
+
+/* Releases a matrix of any family */
+#define matFree(mat) \
+    MATRIX_GENERIC(mat, freeMatrix, freeMatrix_i64, freeMatrix_f32, freeMatrix_f64)(mat)
+
+/* Fills a matrix of any family with random values between 0 and 9 */
+#define matFillRand(mat) \
+    MATRIX_GENERIC(mat, fillMatrixRand, fillMatrixRand_i64, fillMatrixRand_f32, fillMatrixRand_f64)(mat)
+
+/* Prints a matrix of any family */
+#define matPrint(mat) \
+    MATRIX_GENERIC(mat, printMatrix, printMatrix_i64, printMatrix_f32, printMatrix_f64)(mat)
+
+#endif /* matrix_generic_H_ */
@@ -0,0 +1,192 @@
+/*********************************************
+ * Declaration template of a typed matrix family
+ *
+ * No include guard: matrix_generic.h includes this file once per element
+ * type, with these macros defined:
+ *
+ *   MATRIX_TYPE     Element type (e.g. double)
+ *   MATRIX_NAME     Name of the matrix struct (e.g. MatrixF64)
+ *   MATRIX_SUFFIX   Suffix of every function (e.g. _f64)
+ *
+ * MATRIX_FN(name) pastes the suffix, so MATRIX_FN(strassenMul) declares
+ * strassenMul_f64. The functions behave like their int counterparts in
+ * matrix.h (views, rectangular shapes, peeling, workspace arena).
+ *********************************************/
+
+/**
+ * Matrix of MATRIX_TYPE elements, same layout as struct Matrix
+ * Element (i, j) is matrixElem(m.matrix, i, j, m.ld)
+ */
+struct MATRIX_NAME {
+    MATRIX_TYPE* matrix;   /* 1D array of elements in row-major order */
+    int row;               /* Number of rows */
+    int col;               /* Number of columns */
+    int ld;                /* Leading dimension: distance in elements between two rows */
+};
+
+/**
+ * Allocates memory for a square matrix
+ *
+ * @param side  Side length of the square matrix
+ * @return      A newly allocated matrix
+ */
+struct MATRIX_NAME MATRIX_FN(allocMatrix)(int side);
+
+/**
+ * Allocates memory for a rectangular matrix
+ *
+ * @param rows  Number of rows
+ * @param cols  Number of columns
+ * @return      A newly allocated matrix (ld = cols)
+ */
+struct MATRIX_NAME MATRIX_FN(allocMatrixRect)(int rows, int cols);
+
+/**
+ * Frees the memory allocated for a matrix (never a view)
+ *
+ * @param mat   Matrix to free
+ */
+void MATRIX_FN(freeMatrix)(struct MATRIX_NAME* mat);
+
+/**
+ * Creates a view on a block of a matrix without copying it
+ *
+ * @param mat   Matrix (or view) containing the block
+ * @param row   Starting row of the block in mat
+ * @param col   Starting column of the block in mat
+ * @param rows  Number of rows of the block
+ * @param cols  Number of columns of the block
+ * @return      A matrix struct describing the block
+ */
+struct MATRIX_NAME MATRIX_FN(matrixView)(struct MATRIX_NAME* mat, int row, int col, int rows, int cols);
+
+/**
+ * Fills a matrix with random integral values between 0 and 9
+ *
+ * @param mat   Matrix to fill
+ */
+void MATRIX_FN(fillMatrixRand)(struct MATRIX_NAME* mat);
+
+/**
+ * Initializes a matrix with zeros
+ *
+ * @param mat   Matrix to initialize
+ */
+void MATRIX_FN(initMatrixZeros)(struct MATRIX_NAME* mat);
+
+/**
+ * Prints a matrix to standard output
+ *
+ * @param mat   Matrix to print
+ */
+void MATRIX_FN(printMatrix)(struct MATRIX_NAME* mat);
+
+/**
+ * Block helpers, same semantics as sumMatrixRect, subMatrixRect,
+ * addSubmatrixRect, subSubmatrixRect and copySubmatrixRect in matrix.h
+ * Every row is processed by a contiguous loop the compiler vectorizes
+ */
+int MATRIX_FN(sumMatrixRect)(struct MATRIX_NAME* A, int rowA, int colA,
+                             struct MATRIX_NAME* B, int rowB, int colB,
+                             struct MATRIX_NAME* C, int rowC, int colC,
+                             int rows, int cols);
+int MATRIX_FN(subMatrixRect)(struct MATRIX_NAME* A, int rowA, int colA,
+                             struct MATRIX_NAME* B, int rowB, int colB,
+                             struct MATRIX_NAME* C, int rowC, int colC,
+                             int rows, int cols);
+int MATRIX_FN(addSubmatrixRect)(struct MATRIX_NAME* A, struct MATRIX_NAME* B,
+                                int rowB, int colB, int rows, int cols);
+int MATRIX_FN(subSubmatrixRect)(struct MATRIX_NAME* A, struct MATRIX_NAME* B,
+                                int rowB, int colB, int rows, int cols);
+int MATRIX_FN(copySubmatrixRect)(struct MATRIX_NAME* A, int rowA, int colA,
+                                 struct MATRIX_NAME* C, int rowC, int colC,
+                                 int rows, int cols);
+
+/**
+ * Completes C = A * B after peeling the odd dimensions (see peelUpdate)
+ *
+ * @param A          First source matrix (m x k)
+ * @param B          Second source matrix (k x n)
+ * @param C          Destination matrix (m x n)
+ * @return           0 on success
+ */
+int MATRIX_FN(peelUpdate)(struct MATRIX_NAME* A, struct MATRIX_NAME* B, struct MATRIX_NAME* C);
+
+/**
+ * Conventional multiplication, also the leaf of the Strassen engines
+ * Computes C = A * B in i-k-j order over GENERIC_LEAF_KC x GENERIC_LEAF_NC
+ * panels of B, so the inner loop is a contiguous multiply-add the
+ * compiler turns into vector instructions. C must not overlap A or B.
+ *
+ * @param A      First input matrix (m x k)
+ * @param B      Second input matrix (k x n)
+ * @param C      Output matrix (m x n, must be pre-allocated)
+ * @return       Pointer to the result matrix C
+ */
+struct MATRIX_NAME* MATRIX_FN(mul)(struct MATRIX_NAME* A, struct MATRIX_NAME* B, struct MATRIX_NAME* C);
+
+/**
+ * Returns the exact number of bytes of workspace needed by the typed
+ * Strassen engines for an m x k by k x n product
+ *
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Strassen)
+ * @return           Size of the workspace arena in bytes
+ */
+size_t MATRIX_FN(strassenWorkspaceSizeRect)(int m, int k, int n, int cutoff);
+
+/**
+ * Performs hybrid Strassen multiplication on a caller-supplied arena
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which the leaf kernel is used
+ * @param workspace  Arena of at least strassenWorkspaceSizeRect(A->row, A->col, B->col, cutoff) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct MATRIX_NAME* MATRIX_FN(strassenMul_hybrid_ws)(struct MATRIX_NAME* A, struct MATRIX_NAME* B,
+                                                     struct MATRIX_NAME* C, int cutoff, void* workspace);
+
+/**
+ * Performs Strassen's matrix multiplication algorithm
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix (must be pre-allocated)
+ * @return       Pointer to the result matrix C, NULL if the workspace
+ *               arena cannot be allocated
+ */
+struct MATRIX_NAME* MATRIX_FN(strassenMul)(struct MATRIX_NAME* A, struct MATRIX_NAME* B, struct MATRIX_NAME* C);
+
+/**
+ * Hybrid Strassen multiplication, leaf kernel below the cutoff
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Size threshold below which the leaf kernel is used
+ * @return           Pointer to the result matrix C, NULL if the workspace
+ *                   arena cannot be allocated
+ */
+struct MATRIX_NAME* MATRIX_FN(strassenMul_hybrid)(struct MATRIX_NAME* A, struct MATRIX_NAME* B,
+                                                  struct MATRIX_NAME* C, int cutoff);
+
+/**
+ * Checks C = A * B with Freivalds' algorithm, like verifyProduct in matrix.h
+ * Integer families must match exactly. Floating-point families pass when
+ * max |A B x - C x| <= GENERIC_VERIFY_SLACK * (k + 1) * eps * max |A| |B| x,
+ * a normwise bound on the rounding error of the engines
+ *
+ * @param A              First operand (m x k)
+ * @param B              Second operand (k x n)
+ * @param C              Product to check (m x n)
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int MATRIX_FN(verifyProduct)(struct MATRIX_NAME* A, struct MATRIX_NAME* B, struct MATRIX_NAME* C,
+                             double falsePositive, unsigned long long seed);
@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "matrixfile.h"
+
+/******************************************
+ * Binary matrix files
+ *
+ * The header is written and read as the in-memory struct, which matches
+ * the documented little-endian layout on the x86-64 and AArch64 hosts
+ * the library targets.
+ *******************************************/
+
+/**
+ * Fills the header of an int32 row-major matrix file
+ * @param header     Header to fill
+ * @param rows       Number of rows
+ * @param cols       Number of columns
+ */
+static void fillHeader(struct MatrixFileHeader* header, int rows, int cols) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC));
+    header->version = MATRIX_FILE_VERSION;
+    header->elemType = MATRIX_ELEM_INT32;
+    header->elemSize = sizeof(int);
+    header->layout = MATRIX_LAYOUT_ROW_MAJOR;
+    header->alignment = MATRIX_FILE_ALIGN;
+    header->rows = rows;
+    header->cols = cols;
+    header->ld = cols;
+    header->dataOffset = MATRIX_FILE_ALIGN;
+}
+
+/**
+ * Writes a whole buffer to a file descriptor
+ * @param fd     File descriptor
+ * @param data   Buffer
+ * @param bytes  Number of bytes
+ * @return       0 on success, -1 on failure
+ */
+static int writeAll(int fd, const void* data, size_t bytes) {
+    const char* p = data;
+    while (bytes > 0) {
+        ssize_t done = write(fd, p, bytes);
+        if (done <= 0) return -1;
+        p += done;
+        bytes -= (size_t)done;
+    }
+    return 0;
+}
+
+/**
+ * Maps an int32 row-major matrix file into a struct Matrix without copying
+ * @param path       File to map
+ * @param writable   0 for a private read-only mapping, 1 for a shared writable one
+ * @param out        Receives the mapped matrix
+ * @return           0 on success, -1 on failure
+ */
+int mapMatrixFile(const char* path, int writable, struct MappedMatrix* out) {
+    struct MatrixFileHeader header;
+    struct stat st;
+
+    int fd = open(path, writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) return -1;
+
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        close(fd);
+        return -1;
+    }
+
+    /* Only int32 row-major data fits a struct Matrix */
+    if (memcmp(header.magic, MATRIX_FILE_MAGIC, sizeof(MATRIX_FILE_MAGIC)) != 0 ||
+        header.version != MATRIX_FILE_VERSION || header.elemType != MATRIX_ELEM_INT32 ||
+        header.elemSize != sizeof(int) || header.layout != MATRIX_LAYOUT_ROW_MAJOR ||
+        header.alignment != MATRIX_FILE_ALIGN ||
+        header.rows > 0x7fffffff || header.cols > 0x7fffffff || header.ld > 0x7fffffff ||
+        header.ld < header.cols || header.dataOffset % MATRIX_FILE_ALIGN != 0) {
+        close(fd);
+        return -1;
+    }
+
+    /* The data must lie inside the file; both checks are written so that nothing wraps */
+    uint64_t fileBytes = (uint64_t)st.st_size;
+    if (header.rows != 0 && header.ld > UINT64_MAX / sizeof(int) / header.rows) {
+        close(fd);
+        return -1;
+    }
+    uint64_t dataBytes = header.rows * header.ld * sizeof(int);
+    if (header.dataOffset > fileBytes || dataBytes > fileBytes - header.dataOffset) {
+        close(fd);
+        return -1;
+    }
+
+    size_t length = (size_t)(header.dataOffset + dataBytes);
+    void* base = mmap(NULL, length > 0 ? length : 1, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      writable ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    out->base = base;
+    out->length = length > 0 ? length : 1;
+    out->mat.matrix = (int*)((char*)base + header.dataOffset);
+    out->mat.row = (int)header.rows;
+    out->mat.col = (int)header.cols;
+    out->mat.ld = (int)header.ld;
+    return 0;
+}
+
+/**
+ * Creates a rows x cols int32 matrix file and maps it shared and writable
+ * @param path   File to create
+ * @param rows   Number of rows
+ * @param cols   Number of columns
+ * @param out    Receives the mapped matrix
+ * @return       0 on success, -1 on failure
+ */
+int createMatrixFile(const char* path, int rows, int cols, struct MappedMatrix* out) {
+    struct MatrixFileHeader header;
+
+    if (rows < 0 || cols < 0) return -1;
+    fillHeader(&header, rows, cols);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    /* The file gets its final size at once, the data pages stay sparse until written */
+    off_t size = (off_t)(header.dataOffset + (uint64_t)rows * cols * sizeof(int));
+    if (writeAll(fd, &header, sizeof(header)) != 0 || ftruncate(fd, size) != 0) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    return mapMatrixFile(path, 1, out);
+}
+
+/**
+ * Releases a mapped matrix: unmaps a file mapping, frees a heap matrix
+ * @param mapped     Matrix to release
+ * @return           0 on success, -1 if munmap fails
+ */
+int unmapMatrixFile(struct MappedMatrix* mapped) {
+    int status = 0;
+
+    if (mapped->base != NULL) {
+        status = munmap(mapped->base, mapped->length);
+        mapped->base = NULL;
+        mapped->length = 0;
+        mapped->mat.matrix = NULL;
+        mapped->mat.row = 0;
+        mapped->mat.col = 0;
+        mapped->mat.ld = 0;
+    } else {
+        freeMatrix(&mapped->mat);
+    }
+    return status;
+}
+
+/**
+ * Writes a matrix (or a view) to a matrix file with write(2)
+ * @param path   File to write
+ * @param mat    Matrix to save
+ * @return       0 on success, -1 on failure
+ */
+int saveMatrixFile(const char* path, struct Matrix* mat) {
+    struct MatrixFileHeader header;
+    char pad[MATRIX_FILE_ALIGN - sizeof(struct MatrixFileHeader)];
+
+    fillHeader(&header, mat->row, mat->col);
+    memset(pad, 0, sizeof(pad));
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    int status = writeAll(fd, &header, sizeof(header)) | writeAll(fd, pad, sizeof(pad));
+    for (int i = 0; i < mat->row && status == 0; i++) {
+        status = writeAll(fd, &matrixElem(mat->matrix, i, 0, mat->ld), sizeof(int) * mat->col);
+    }
+
+    if (close(fd) != 0) status = -1;
+    return status;
+}
+
+/**
+ * Extracts --in A.bin B.bin and --out C.bin from the arguments of a driver
+ * @param argc   Number of arguments, updated
+ * @param argv   Arguments, compacted in place
+ * @param files  Receives the paths
+ * @return       0 on success, -1 if an option misses its files
+ */
+int parseMatrixFileArgs(int* argc, char* argv[], struct MatrixFileArgs* files) {
+    int kept = 1;
+
+    files->inA = NULL;
+    files->inB = NULL;
+    files->out = NULL;
+
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--in") == 0) {
+            if (i + 2 >= *argc) return -1;
+            files->inA = argv[i + 1];
+            files->inB = argv[i + 2];
+            i += 2;
+        } else if (strcmp(argv[i], "--out") == 0) {
+            if (i + 1 >= *argc) return -1;
+            files->out = argv[i + 1];
+            i += 1;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+
+    *argc = kept;
+    argv[kept] = NULL;
+    return 0;
+}
+
+/**
+ * Maps one operand file and checks its shape
+ * @param path   File to map
+ * @param rows   Expected rows
+ * @param cols   Expected columns
+ * @param out    Receives the mapped matrix
+ * @return       0 on success, -1 on failure
+ */
+static int mapOperand(const char* path, int rows, int cols, struct MappedMatrix* out) {
+    if (mapMatrixFile(path, 0, out) != 0) {
+        fprintf(stderr, "Cannot map %s as an int32 matrix file\n", path);
+        return -1;
+    }
+    if (out->mat.row != rows || out->mat.col != cols) {
+        fprintf(stderr, "%s is %d x %d, expected %d x %d\n", path, out->mat.row, out->mat.col, rows, cols);
+        unmapMatrixFile(out);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Allocates a heap operand
+ * @param rows   Number of rows
+ * @param cols   Number of columns
+ * @param out    Receives the matrix (base NULL)
+ * @return       0 on success, -1 on failure
+ */
+static int allocOperand(int rows, int cols, struct MappedMatrix* out) {
+    out->mat = allocMatrixRect(rows, cols);
+    out->base = NULL;
+    out->length = 0;
+    return out->mat.matrix != NULL ? 0 : -1;
+}
+
+/**
+ * Sets up the operands of an m x k by k x n product for a driver
+ * @param files  Paths parsed by parseMatrixFileArgs
+ * @param m      Rows of A and C
+ * @param k      Columns of A / rows of B
+ * @param n      Columns of B and C
+ * @param A      Receives the first operand
+ * @param B      Receives the second operand
+ * @param C      Receives the result
+ * @return       0 on success, -1 on failure
+ */
+int openMatrixOperands(struct MatrixFileArgs* files, int m, int k, int n,
+                       struct MappedMatrix* A, struct MappedMatrix* B, struct MappedMatrix* C) {
+    int status;
+
+    if (files->inA != NULL) {
+        status = mapOperand(files->inA, m, k, A);
+        if (status == 0 && mapOperand(files->inB, k, n, B) != 0) {
+            unmapMatrixFile(A);
+            status = -1;
+        }
+    } else {
+        status = allocOperand(m, k, A);
+        if (status == 0 && allocOperand(k, n, B) != 0) {
+            unmapMatrixFile(A);
+            status = -1;
+        }
+    }
+    if (status != 0) return -1;
+
+    if (files->out != NULL) {
+        status = createMatrixFile(files->out, m, n, C);
+        if (status != 0) fprintf(stderr, "Cannot create %s\n", files->out);
+    } else {
+        status = allocOperand(m, n, C);
+    }
+    if (status != 0) {
+        unmapMatrixFile(A);
+        unmapMatrixFile(B);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,217 @@
+#ifndef matrixfile_H_
+#define matrixfile_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "matrix.h"
+
+/*********************************************
+ * Binary matrix files
+ *
+ * A matrix file is a 64-byte header followed, at dataOffset, by the raw
+ * elements in row-major order with ld elements between rows:
+ *
+ *   offset  size  field
+ *        0     8  magic "STRSMAT\0"
+ *        8     4  version (MATRIX_FILE_VERSION)
+ *       12     4  element type (enum MatrixElemType)
+ *       16     4  element size in bytes
+ *       20     4  layout (enum MatrixFileLayout)
+ *       24     4  alignment of dataOffset in bytes
+ *       28     4  reserved, 0
+ *       32     8  rows
+ *       40     8  cols
+ *       48     8  ld (>= cols)
+ *       56     8  dataOffset
+ *
+ * All fields are little-endian. The data starts on a page boundary
+ * (MATRIX_FILE_ALIGN), so an int32 row-major file is mapped with mmap
+ * straight into a struct Matrix: loading copies nothing, and pages are
+ * read on first touch. A result file is created at its final size and
+ * mapped shared and writable, so an engine writes C directly into it.
+ *********************************************/
+
+#define MATRIX_FILE_MAGIC "STRSMAT"        /* 8 bytes with the terminating NUL */
+#define MATRIX_FILE_VERSION 1
+#define MATRIX_FILE_ALIGN 4096             /* Alignment of the data (one page) */
+
+/**
+ * Element types of a matrix file
+ */
+enum MatrixElemType {
+    MATRIX_ELEM_INT32 = 1,
+    MATRIX_ELEM_INT64 = 2,
+    MATRIX_ELEM_FLOAT = 3,
+    MATRIX_ELEM_DOUBLE = 4
+};
+
+/**
+ * Element layouts of a matrix file
+ */
+enum MatrixFileLayout {
+    MATRIX_LAYOUT_ROW_MAJOR = 0
+};
+
+/**
+ * On-disk header, 64 bytes
+ */
+struct MatrixFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t elemType;
+    uint32_t elemSize;
+    uint32_t layout;
+    uint32_t alignment;
+    uint32_t reserved;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t ld;
+    uint64_t dataOffset;
+};
+
+/**
+ * A matrix backed by a file mapping, or by the heap when base is NULL
+ */
+struct MappedMatrix {
+    struct Matrix mat;      /* Points into the mapping */
+    void* base;             /* Start of the mapping, NULL for a heap matrix */
+    size_t length;          /* Length of the mapping in bytes */
+};
+
+/**
+ * Paths given to a driver with --in A.bin B.bin and --out C.bin
+ */
+struct MatrixFileArgs {
+    const char* inA;        /* NULL without --in */
+    const char* inB;
+    const char* out;        /* NULL without --out */
+};
+
+/**
+ * Maps an int32 row-major matrix file into a struct Matrix without copying
+ *
+ * @param path       File to map
+ * @param writable   0 for a private read-only mapping, 1 for a shared writable one
+ * @param out        Receives the mapped matrix
+ * @return           0 on success, -1 if the file cannot be opened or mapped,
+ *                   or is not a valid int32 row-major matrix file
+ */
+int mapMatrixFile(const char* path, int writable, struct MappedMatrix* out);
+
+/**
+ * Creates a rows x cols int32 matrix file and maps it shared and writable
+ * The elements start as zeros; they reach the file when the mapping is
+ * written back (at the latest by unmapMatrixFile)
+ *
+ * @param path   File to create (truncated if it exists)
+ * @param rows   Number of rows
+ * @param cols   Number of columns
+ * @param out    Receives the mapped matrix
+ * @return       0 on success, -1 on failure
+ */
+int createMatrixFile(const char* path, int rows, int cols, struct MappedMatrix* out);
+
+/**
+ * Releases a mapped matrix: unmaps a file mapping, frees a heap matrix
+ *
+ * @param mapped     Matrix returned by mapMatrixFile, createMatrixFile or openMatrixOperands
+ * @return           0 on success, -1 if munmap fails
+ */
+int unmapMatrixFile(struct MappedMatrix* mapped);
+
+/**
+ * Writes a matrix (or a view) to a matrix file with write(2)
+ *
+ * @param path   File to write (truncated if it exists)
+ * @param mat    Matrix to save
+ * @return       0 on success, -1 on failure
+ */
+int saveMatrixFile(const char* path, struct Matrix* mat);
+
+/**
+ * Extracts --in A.bin B.bin and --out C.bin from the arguments of a driver
+ * The options are removed from argv and argc is updated, so the driver
+ * parses its positional arguments as before
+ *
+ * @param argc   Number of arguments, updated
+ * @param argv   Arguments, compacted in place
+ * @param files  Receives the paths (NULL when an option is absent)
+ * @return       0 on success, -1 if --in or --out misses its files
+ */
+int parseMatrixFileArgs(int* argc, char* argv[], struct MatrixFileArgs* files);
+
+/**
+ * Sets up the operands of an m x k by k x n product for a driver
+ * A and B are mapped from files->inA / files->inB (their shape must be
+ * m x k and k x n) or allocated on the heap; C is created as files->out
+ * or allocated on the heap. Heap matrices are left uninitialised
+ *
+ * @param files  Paths parsed by parseMatrixFileArgs
+ * @param m      Rows of A and C
+ * @param k      Columns of A / rows of B
+ * @param n      Columns of B and C
+ * @param A      Receives the first operand
+ * @param B      Receives the second operand
+ * @param C      Receives the result
+ * @return       0 on success, -1 on failure (a message is printed on stderr)
+ */
+int openMatrixOperands(struct MatrixFileArgs* files, int m, int k, int n,
+                       struct MappedMatrix* A, struct MappedMatrix* B, struct MappedMatrix* C);
+
+/*********************************************
+ * Out-of-core multiplication
+ *
+ * For products larger than RAM: A, B and C live in mapped matrix files
+ * and the top recursion levels work on their disk-backed quadrants, with
+ * temporaries in an unlinked scratch file (about m*n ints for square
+ * products). Block operations of these levels stream their operands in
+ * strips, prefetching the next strip with MADV_WILLNEED and dropping the
+ * finished one with MADV_DONTNEED. Once a subproblem (operands, result
+ * and arena) fits the memory budget it is copied into RAM and handed to
+ * strassenMul_hybrid_ws. Results are identical to strassenMul_hybrid.
+ *********************************************/
+
+/**
+ * Statistics of an out-of-core run
+ */
+struct OutOfCoreReport {
+    int levels;                 /* Out-of-core recursion levels above the in-memory products */
+    long leaves;                /* Subproblems multiplied in RAM */
+    size_t ramBytes;            /* In-memory buffer of the largest subproblem */
+    size_t scratchBytes;        /* Scratch file for the temporaries */
+    long long peakRssBytes;     /* Peak resident set (VmHWM) during the run, -1 if unknown */
+    long long readBytes;        /* Bytes read from storage (/proc/self/io), -1 if unknown */
+    long long writeBytes;       /* Bytes written to storage, including the final msync of C */
+    size_t bytesIn;             /* Operand bytes copied into RAM for the subproblems */
+    size_t bytesOut;            /* Result bytes copied back from RAM */
+};
+
+/**
+ * Multiplies matrices that do not fit in memory
+ * A, B and C are usually mapped with mapMatrixFile / createMatrixFile;
+ * heap matrices (base NULL) are accepted but never dropped from memory.
+ * C is synced to its file before returning
+ *
+ * @param A          First operand (m x k)
+ * @param B          Second operand (k x n)
+ * @param C          Result (m x n), must not overlap A or B
+ * @param cutoff     Size threshold of the in-memory engine, or CUTOFF_AUTO
+ * @param budget     Memory budget in bytes for the in-memory subproblems and the strips
+ * @param scratchDir Directory of the scratch file, NULL for the current directory
+ * @param report     Receives the statistics of the run (may be NULL)
+ * @return           Pointer to the result matrix C->mat, NULL if the scratch
+ *                   file or the in-memory buffer cannot be allocated
+ */
+struct Matrix* strassenMul_outOfCore(struct MappedMatrix* A, struct MappedMatrix* B, struct MappedMatrix* C,
+                                     int cutoff, size_t budget, const char* scratchDir,
+                                     struct OutOfCoreReport* report);
+
+/**
+ * Prints the statistics of an out-of-core run as a CSV header and one line
+ *
+ * @param out        Output stream
+ * @param report     Statistics returned by strassenMul_outOfCore
+ */
+void printOutOfCoreReport(FILE* out, const struct OutOfCoreReport* report);
+
+#endif /* matrixfile_H_ */
@@ -0,0 +1,638 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "matrix.h"
+
+/******************************************
+ * Matrix multiplication over a prime field
+ *
+ * Elements are residues modulo an odd prime p < 2^31 chosen at run
+ * time, stored in the int data of struct Matrix (so they are also valid
+ * non-negative ints). Intermediate values are handled as uint32_t and
+ * uint64_t.
+ *
+ * Lazy reduction: an operand of a Strassen product is bounded by e * p
+ * (e = 1 for the inputs). A sum X + Y, or a difference X - Y + e * p,
+ * is bounded by 2e * p and is only reduced (Barrett, one multiply) when
+ * 2e would exceed field->lazyLimit. The limit keeps the operands within
+ * 32 bits and lets the leaf add at least MOD_MIN_TERMS products between
+ * reductions.
+ *
+ * Leaf: i-k-j over panels of C. The products of a chunk of k are added
+ * into 64-bit accumulators with no reduction at all, the chunk being as
+ * long as the bounds of the operands allow (acc < 2^63). Each chunk is
+ * folded with one Montgomery reduction (two 32 x 32 -> 64 multiplies),
+ * and at the end of the row a second reduction and a multiplication by
+ * 2^96 mod p undo the Montgomery factors. Every step is a plain loop over
+ * 64-bit lanes that the compiler vectorizes; the leaf is compiled for
+ * the default target and for AVX2, picked with getSimdLevel.
+ *******************************************/
+
+/* Columns of C per panel of the leaf (two 64-bit accumulators each) */
+#define MOD_LEAF_COLS 128
+
+/* Rows of A sharing each panel row of B in the leaf */
+#define MOD_LEAF_ROWS 4
+
+/* Products the leaf should be able to add between two reductions */
+#define MOD_MIN_TERMS 64
+
+/**
+ * Returns the next value of a splitmix64 generator
+ * @param state  Generator state, updated
+ * @return       64 random bits
+ */
+static uint64_t modRandom(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Checks whether a number is prime, by trial division
+ * @param p      Number to check
+ * @return       1 if p is prime, 0 otherwise
+ */
+static int isPrime(uint32_t p) {
+    if (p < 2) return 0;
+    if (p % 2 == 0) return p == 2;
+    for (uint32_t d = 3; (uint64_t)d * d <= p; d += 2) {
+        if (p % d == 0) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Prepares the constants of the reductions modulo a prime
+ * @param field  Field to initialize
+ * @param p      Odd prime, 3 <= p < 2^31
+ * @return       0 on success, -1 if p is not an odd prime below 2^31
+ */
+int modFieldInit(struct ModField* field, uint32_t p) {
+    if (p < 3 || p >= (1u << 31) || !isPrime(p)) return -1;
+
+    field->p = p;
+    /* Newton's iteration doubles the correct low bits of p^-1 mod 2^32 */
+    uint32_t inverse = p;
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - p * inverse;
+    }
+    field->pinv = -inverse;
+    field->barrett = (uint32_t)((1ull << 32) / p);
+    uint64_t r = (1ull << 32) % p;                 /* 2^32 mod p */
+    field->r3 = (uint32_t)(r * r % p * r % p);     /* 2^96 mod p */
+
+    /* Largest power of two e with e * p <= 2^31 and enough leaf terms at that bound */
+    uint32_t limit = 1;
+    while ((uint64_t)2 * limit * p <= (1ull << 31)) {
+        uint64_t bound = (uint64_t)2 * limit * p;
+        if (((1ull << 63) - 1) / (bound * bound) < MOD_MIN_TERMS) break;
+        limit *= 2;
+    }
+    field->lazyLimit = limit;
+    return 0;
+}
+
+/**
+ * Montgomery reduction of a 64-bit value
+ * @param t      Value, below 2^63
+ * @param p      Modulus
+ * @param pinv   -p^-1 mod 2^32
+ * @return       A value congruent to t * 2^-32, below 2^31 + p
+ */
+static inline uint64_t montgomeryReduce(uint64_t t, uint32_t p, uint32_t pinv) {
+    uint32_t q = (uint32_t)t * pinv;
+    return (t + (uint64_t)q * p) >> 32;
+}
+
+/**
+ * Barrett reduction of a 32-bit value
+ * @param x      Value
+ * @param p      Modulus
+ * @param mu     floor(2^32 / p)
+ * @return       x mod p
+ */
+static inline uint32_t barrettReduce(uint32_t x, uint32_t p, uint32_t mu) {
+    uint32_t q = (uint32_t)(((uint64_t)x * mu) >> 32);
+    uint32_t r = x - q * p;     /* Below 2p */
+    return r >= p ? r - p : r;
+}
+
+/*********************************************
+ * Leaf kernel
+ *********************************************/
+
+/**
+ * C = A * B mod p (or C += A * B mod p) for a block of at most
+ * MOD_LEAF_ROWS rows and MOD_LEAF_COLS columns
+ * Inlined in the leaf of every instruction set
+ *
+ * @param A          First row of the block of A
+ * @param lda        Leading dimension of A
+ * @param B          First column of the panel of B
+ * @param ldb        Leading dimension of B
+ * @param C          First element of the block of C
+ * @param ldc        Leading dimension of C
+ * @param rows       Rows of the block
+ * @param k          Inner dimension
+ * @param cols       Columns of the block
+ * @param terms      Products added between two reductions
+ * @param field      Prime field
+ * @param accumulate 1 to add the product to C, 0 to overwrite C
+ */
+static inline __attribute__((always_inline))
+void modLeafBlock(const uint32_t* A, size_t lda, const uint32_t* B, size_t ldb,
+                  uint32_t* C, size_t ldc, int rows, int k, int cols, int terms,
+                  const struct ModField* field, int accumulate) {
+    uint64_t acc[MOD_LEAF_ROWS][MOD_LEAF_COLS];
+    uint64_t total[MOD_LEAF_ROWS][MOD_LEAF_COLS];
+    const uint32_t p = field->p, pinv = field->pinv, r3 = field->r3;
+
+    for (int r = 0; r < rows; r++) {
+        memset(total[r], 0, sizeof(uint64_t) * cols);
+    }
+    for (int k0 = 0; k0 < k; k0 += terms) {
+        int kEnd = k - k0 < terms ? k : k0 + terms;
+        for (int r = 0; r < rows; r++) {
+            memset(acc[r], 0, sizeof(uint64_t) * cols);
+        }
+        /* No reduction inside a chunk: acc stays below 2^63 */
+        for (int kk = k0; kk < kEnd; kk++) {
+            const uint32_t* b = B + (size_t)kk * ldb;
+            for (int r = 0; r < rows; r++) {
+                uint32_t a = A[(size_t)r * lda + kk];
+                uint64_t* accRow = acc[r];
+                for (int j = 0; j < cols; j++) {
+                    accRow[j] += (uint64_t)a * b[j];
+                }
+            }
+        }
+        for (int r = 0; r < rows; r++) {
+            for (int j = 0; j < cols; j++) {
+                total[r][j] += montgomeryReduce(acc[r][j], p, pinv);
+            }
+        }
+    }
+    /* total = sum * 2^-32; reduce again to sum * 2^-64, multiply by 2^96 to get sum * 2^0 */
+    for (int r = 0; r < rows; r++) {
+        uint32_t* c = C + (size_t)r * ldc;
+        for (int j = 0; j < cols; j++) {
+            uint64_t t = montgomeryReduce(total[r][j], p, pinv);
+            uint32_t v = (uint32_t)montgomeryReduce(t * r3, p, pinv);
+            v = v >= p ? v - p : v;
+            if (accumulate) {
+                v += c[j];
+                v = v >= p ? v - p : v;
+            }
+            c[j] = v;
+        }
+    }
+}
+
+/**
+ * Runs modLeafBlock over a whole product
+ * @param A          Operand A (m x k), elements below eA * p
+ * @param lda        Leading dimension of A
+ * @param B          Operand B (k x n), elements below eB * p
+ * @param ldb        Leading dimension of B
+ * @param C          Result (m x n), residues
+ * @param ldc        Leading dimension of C
+ * @param m          Rows of A and C
+ * @param k          Columns of A, rows of B
+ * @param n          Columns of B and C
+ * @param terms      Products added between two reductions
+ * @param field      Prime field
+ * @param accumulate 1 to add the product to C, 0 to overwrite C
+ */
+static inline __attribute__((always_inline))
+void modLeafBody(const uint32_t* A, size_t lda, const uint32_t* B, size_t ldb,
+                 uint32_t* C, size_t ldc, int m, int k, int n, int terms,
+                 const struct ModField* field, int accumulate) {
+    for (int j0 = 0; j0 < n; j0 += MOD_LEAF_COLS) {
+        int cols = n - j0 < MOD_LEAF_COLS ? n - j0 : MOD_LEAF_COLS;
+        for (int i0 = 0; i0 < m; i0 += MOD_LEAF_ROWS) {
+            int rows = m - i0 < MOD_LEAF_ROWS ? m - i0 : MOD_LEAF_ROWS;
+            modLeafBlock(A + (size_t)i0 * lda, lda, B + j0, ldb, C + (size_t)i0 * ldc + j0, ldc,
+                         rows, k, cols, terms, field, accumulate);
+        }
+    }
+}
+
+/* Signature shared by the leaf of every instruction set */
+typedef void (*ModLeafKernel)(const uint32_t* A, size_t lda, const uint32_t* B, size_t ldb,
+                              uint32_t* C, size_t ldc, int m, int k, int n, int terms,
+                              const struct ModField* field, int accumulate);
+
+static void modLeafDefault(const uint32_t* A, size_t lda, const uint32_t* B, size_t ldb,
+                           uint32_t* C, size_t ldc, int m, int k, int n, int terms,
+                           const struct ModField* field, int accumulate) {
+    modLeafBody(A, lda, B, ldb, C, ldc, m, k, n, terms, field, accumulate);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+static void modLeafAVX2(const uint32_t* A, size_t lda, const uint32_t* B, size_t ldb,
+                        uint32_t* C, size_t ldc, int m, int k, int n, int terms,
+                        const struct ModField* field, int accumulate) {
+    modLeafBody(A, lda, B, ldb, C, ldc, m, k, n, terms, field, accumulate);
+}
+#endif
+
+/**
+ * Computes C = A * B mod p (or C += A * B mod p) with the leaf kernel
+ * of the current SIMD level
+ *
+ * @param A          Operand A (m x k), elements below eA * p
+ * @param eA         Bound factor of A
+ * @param B          Operand B (k x n), elements below eB * p
+ * @param eB         Bound factor of B
+ * @param C          Result (m x n), residues
+ * @param accumulate 1 to add the product to C, 0 to overwrite C
+ * @param field      Prime field
+ */
+static void modLeaf(struct Matrix* A, uint32_t eA, struct Matrix* B, uint32_t eB,
+                    struct Matrix* C, int accumulate, const struct ModField* field) {
+    ModLeafKernel kernel = modLeafDefault;
+#if defined(__x86_64__) || defined(__i386__)
+    /* Also at SIMD_AVX512: the 512-bit widening multiplies were slower than the 256-bit ones */
+    if (getSimdLevel() >= SIMD_AVX2) {
+        kernel = modLeafAVX2;
+    }
+#endif
+    if (C->row == 0 || C->col == 0) return;
+    if (A->col == 0) {
+        if (!accumulate) initMatrixZeros(C);
+        return;
+    }
+
+    /* Longest chunk whose sum of products stays below 2^63 */
+    uint64_t largest = ((uint64_t)eA * field->p - 1) * ((uint64_t)eB * field->p - 1);
+    uint64_t terms = largest > 0 ? ((1ull << 63) - 1) / largest : (uint64_t)A->col;
+    if (terms > (uint64_t)A->col) terms = A->col;
+
+    kernel((const uint32_t*)A->matrix, A->ld, (const uint32_t*)B->matrix, B->ld,
+           (uint32_t*)C->matrix, C->ld, A->row, A->col, B->col, (int)terms, field, accumulate);
+}
+
+/*********************************************
+ * Element-wise helpers modulo p
+ *********************************************/
+
+/**
+ * Forms the operand X + Y or X - Y of a Strassen product, lazily reduced
+ * @param X          First summand, elements below e * p
+ * @param Y          Second summand, elements below e * p
+ * @param e          Bound factor of X and Y
+ * @param subtract   1 for X - Y, 0 for X + Y
+ * @param T          Destination, same shape as X
+ * @param field      Prime field
+ * @return           Bound factor of T: 2e, or 1 if T had to be reduced
+ */
+static uint32_t modFormOperand(struct Matrix* X, struct Matrix* Y, uint32_t e, int subtract,
+                               struct Matrix* T, const struct ModField* field) {
+    int reduce = 2 * e > field->lazyLimit;
+    /* X - Y + e * p is non-negative and congruent to X - Y */
+    uint32_t offset = subtract ? e * field->p : 0;
+    uint32_t sign = subtract ? (uint32_t)-1 : 1;
+    const uint32_t p = field->p, mu = field->barrett;
+
+    for (int i = 0; i < X->row; i++) {
+        const uint32_t* x = (const uint32_t*)&matrixElem(X->matrix, i, 0, X->ld);
+        const uint32_t* y = (const uint32_t*)&matrixElem(Y->matrix, i, 0, Y->ld);
+        uint32_t* t = (uint32_t*)&matrixElem(T->matrix, i, 0, T->ld);
+        if (reduce) {
+            for (int j = 0; j < X->col; j++) {
+                t[j] = barrettReduce(x[j] + sign * y[j] + offset, p, mu);
+            }
+        } else {
+            for (int j = 0; j < X->col; j++) {
+                t[j] = x[j] + sign * y[j] + offset;
+            }
+        }
+    }
+    return reduce ? 1 : 2 * e;
+}
+
+/**
+ * Adds (or subtracts) a matrix of residues to a block of C, modulo p
+ * @param P          Residues to add
+ * @param C          Matrix holding the block, residues
+ * @param row        First row of the block in C
+ * @param col        First column of the block in C
+ * @param subtract   1 for C -= P, 0 for C += P
+ * @param field      Prime field
+ */
+static void modAccumulate(struct Matrix* P, struct Matrix* C, int row, int col, int subtract,
+                          const struct ModField* field) {
+    const uint32_t p = field->p;
+
+    for (int i = 0; i < P->row; i++) {
+        const uint32_t* src = (const uint32_t*)&matrixElem(P->matrix, i, 0, P->ld);
+        uint32_t* dst = (uint32_t*)&matrixElem(C->matrix, row + i, col, C->ld);
+        if (subtract) {
+            for (int j = 0; j < P->col; j++) {
+                uint32_t v = dst[j] - src[j] + p;
+                dst[j] = v >= p ? v - p : v;
+            }
+        } else {
+            for (int j = 0; j < P->col; j++) {
+                uint32_t v = dst[j] + src[j];
+                dst[j] = v >= p ? v - p : v;
+            }
+        }
+    }
+}
+
+/**
+ * Sets every element of a matrix to its residue modulo p
+ * @param mat    Matrix or view, any int values
+ * @param field  Prime field
+ */
+void reduceMatrixMod(struct Matrix* mat, const struct ModField* field) {
+    int p = (int)field->p;
+
+    for (int i = 0; i < mat->row; i++) {
+        int* row = &matrixElem(mat->matrix, i, 0, mat->ld);
+        for (int j = 0; j < mat->col; j++) {
+            int v = row[j] % p;
+            row[j] = v < 0 ? v + p : v;
+        }
+    }
+}
+
+/**
+ * Fills a matrix with uniformly distributed residues modulo p
+ * @param mat    Matrix or view
+ * @param field  Prime field
+ * @param seed   Seed of the generator
+ */
+void fillMatrixRandMod(struct Matrix* mat, const struct ModField* field, unsigned long long seed) {
+    uint64_t state = seed;
+
+    for (int i = 0; i < mat->row; i++) {
+        int* row = &matrixElem(mat->matrix, i, 0, mat->ld);
+        for (int j = 0; j < mat->col; j++) {
+            row[j] = (int)(modRandom(&state) % field->p);
+        }
+    }
+}
+
+/*********************************************
+ * Conventional and Strassen products modulo p
+ *********************************************/
+
+/**
+ * Conventional multiplication modulo p
+ * @param A      First input matrix (m x k), residues
+ * @param B      Second input matrix (k x n), residues
+ * @param C      Output matrix (m x n)
+ * @param field  Prime field
+ * @return       Pointer to the result matrix C
+ */
+struct Matrix* mulMod(struct Matrix* A, struct Matrix* B, struct Matrix* C, const struct ModField* field) {
+    modLeaf(A, 1, B, 1, C, 0, field);
+    return C;
+}
+
+/**
+ * Returns the size of the arena used by strassenMulMod_hybrid, in elements
+ * Each level needs its two operand temporaries and the product temporary;
+ * peeled dimensions lose one row or column, which only shrinks the levels
+ *
+ * @param m      Rows of A
+ * @param k      Columns of A / rows of B
+ * @param n      Columns of B
+ * @param cutoff Size threshold of the leaf
+ * @return       Number of uint32_t elements
+ */
+static size_t modWorkspaceSize(int m, int k, int n, int cutoff) {
+    size_t total = 0;
+
+    while (m > cutoff && k > cutoff && n > cutoff) {
+        m /= 2;
+        k /= 2;
+        n /= 2;
+        total += (size_t)m * k + (size_t)k * n + (size_t)m * n;
+    }
+    return total;
+}
+
+/**
+ * Wraps a block of the arena as a matrix
+ * @param data   First element of the block
+ * @param rows   Number of rows
+ * @param cols   Number of columns (also the leading dimension)
+ * @return       Matrix struct on the block
+ */
+static struct Matrix modArenaMatrix(uint32_t* data, int rows, int cols) {
+    struct Matrix mat;
+    mat.matrix = (int*)data;
+    mat.row = rows;
+    mat.col = cols;
+    mat.ld = cols;
+    return mat;
+}
+
+static void strassenRecursiveMod(struct Matrix* A, uint32_t eA, struct Matrix* B, uint32_t eB,
+                                 struct Matrix* C, int cutoff, const struct ModField* field, uint32_t* ws);
+
+/**
+ * One Strassen level modulo p on even dimensions
+ * Same schedule as strassenLevel: C11 = P1, C12 = P4 and C21 = P6 are
+ * written in place and the other products go through one temporary
+ *
+ * @param A      First operand (m x k, m and k even), elements below eA * p
+ * @param eA     Bound factor of A
+ * @param B      Second operand (k x n, n even), elements below eB * p
+ * @param eB     Bound factor of B
+ * @param C      Result (m x n), residues
+ * @param cutoff Size threshold of the leaf
+ * @param field  Prime field
+ * @param ws     Arena of this level and the levels below
+ */
+static void strassenLevelMod(struct Matrix* A, uint32_t eA, struct Matrix* B, uint32_t eB,
+                             struct Matrix* C, int cutoff, const struct ModField* field, uint32_t* ws) {
+    int hm = A->row / 2, hk = A->col / 2, hn = B->col / 2;
+
+    struct Matrix temp1 = modArenaMatrix(ws, hm, hk);
+    struct Matrix temp2 = modArenaMatrix(ws + (size_t)hm * hk, hk, hn);
+    struct Matrix P = modArenaMatrix(ws + (size_t)hm * hk + (size_t)hk * hn, hm, hn);
+    uint32_t* next = ws + (size_t)hm * hk + (size_t)hk * hn + (size_t)hm * hn;
+
+    struct Matrix A11 = matrixView(A, 0, 0, hm, hk), A12 = matrixView(A, 0, hk, hm, hk);
+    struct Matrix A21 = matrixView(A, hm, 0, hm, hk), A22 = matrixView(A, hm, hk, hm, hk);
+    struct Matrix B11 = matrixView(B, 0, 0, hk, hn), B12 = matrixView(B, 0, hn, hk, hn);
+    struct Matrix B21 = matrixView(B, hk, 0, hk, hn), B22 = matrixView(B, hk, hn, hk, hn);
+    struct Matrix C11 = matrixView(C, 0, 0, hm, hn), C12 = matrixView(C, 0, hn, hm, hn);
+    struct Matrix C21 = matrixView(C, hm, 0, hm, hn);
+    uint32_t eL, eR;
+
+    /* P1 = (A12 - A22) * (B21 + B22), C11 = P1 */
+    eL = modFormOperand(&A12, &A22, eA, 1, &temp1, field);
+    eR = modFormOperand(&B21, &B22, eB, 0, &temp2, field);
+    strassenRecursiveMod(&temp1, eL, &temp2, eR, &C11, cutoff, field, next);
+
+    /* P2 = (A11 + A22) * (B11 + B22), C11 += P2, C22 = P2 */
+    eL = modFormOperand(&A11, &A22, eA, 0, &temp1, field);
+    eR = modFormOperand(&B11, &B22, eB, 0, &temp2, field);
+    strassenRecursiveMod(&temp1, eL, &temp2, eR, &P, cutoff, field, next);
+    modAccumulate(&P, C, 0, 0, 0, field);
+    copySubmatrixRect(&P, 0, 0, C, hm, hn, hm, hn);
+
+    /* P3 = (A11 - A21) * (B11 + B12), C22 -= P3 */
+    eL = modFormOperand(&A11, &A21, eA, 1, &temp1, field);
+    eR = modFormOperand(&B11, &B12, eB, 0, &temp2, field);
+    strassenRecursiveMod(&temp1, eL, &temp2, eR, &P, cutoff, field, next);
+    modAccumulate(&P, C, hm, hn, 1, field);
+
+    /* P4 = (A11 + A12) * B22, C12 = P4, C11 -= P4 */
+    eL = modFormOperand(&A11, &A12, eA, 0, &temp1, field);
+    strassenRecursiveMod(&temp1, eL, &B22, eB, &C12, cutoff, field, next);
+    modAccumulate(&C12, C, 0, 0, 1, field);
+
+    /* P5 = A11 * (B12 - B22), C12 += P5, C22 += P5 */
+    eR = modFormOperand(&B12, &B22, eB, 1, &temp2, field);
+    strassenRecursiveMod(&A11, eA, &temp2, eR, &P, cutoff, field, next);
+    modAccumulate(&P, C, 0, hn, 0, field);
+    modAccumulate(&P, C, hm, hn, 0, field);
+
+    /* P6 = A22 * (B21 - B11), C21 = P6, C11 += P6 */
+    eR = modFormOperand(&B21, &B11, eB, 1, &temp2, field);
+    strassenRecursiveMod(&A22, eA, &temp2, eR, &C21, cutoff, field, next);
+    modAccumulate(&C21, C, 0, 0, 0, field);
+
+    /* P7 = (A21 + A22) * B11, C21 += P7, C22 -= P7 */
+    eL = modFormOperand(&A21, &A22, eA, 0, &temp1, field);
+    strassenRecursiveMod(&temp1, eL, &B11, eB, &P, cutoff, field, next);
+    modAccumulate(&P, C, hm, 0, 0, field);
+    modAccumulate(&P, C, hm, hn, 1, field);
+}
+
+/**
+ * Recursive step of strassenMulMod_hybrid
+ * Odd dimensions are peeled: the even part runs a Strassen level and the
+ * last row, column and inner index are completed with the leaf kernel
+ *
+ * @param A      First operand (m x k), elements below eA * p
+ * @param eA     Bound factor of A
+ * @param B      Second operand (k x n), elements below eB * p
+ * @param eB     Bound factor of B
+ * @param C      Result (m x n), residues
+ * @param cutoff Size threshold of the leaf
+ * @param field  Prime field
+ * @param ws     Arena of this level and the levels below
+ */
+static void strassenRecursiveMod(struct Matrix* A, uint32_t eA, struct Matrix* B, uint32_t eB,
+                                 struct Matrix* C, int cutoff, const struct ModField* field, uint32_t* ws) {
+    int m = A->row, k = A->col, n = B->col;
+
+    if (m <= cutoff || k <= cutoff || n <= cutoff) {
+        modLeaf(A, eA, B, eB, C, 0, field);
+        return;
+    }
+
+    int me = m & ~1, ke = k & ~1, ne = n & ~1;
+    if (me == m && ke == k && ne == n) {
+        strassenLevelMod(A, eA, B, eB, C, cutoff, field, ws);
+        return;
+    }
+
+    struct Matrix evenA = matrixView(A, 0, 0, me, ke);
+    struct Matrix evenB = matrixView(B, 0, 0, ke, ne);
+    struct Matrix evenC = matrixView(C, 0, 0, me, ne);
+    strassenLevelMod(&evenA, eA, &evenB, eB, &evenC, cutoff, field, ws);
+    if (ke < k) {
+        /* evenC += A[0:me, k-1] * B[k-1, 0:ne] */
+        struct Matrix colA = matrixView(A, 0, ke, me, 1);
+        struct Matrix rowB = matrixView(B, ke, 0, 1, ne);
+        modLeaf(&colA, eA, &rowB, eB, &evenC, 1, field);
+    }
+    if (ne < n) {
+        struct Matrix rowsA = matrixView(A, 0, 0, me, k);
+        struct Matrix colB = matrixView(B, 0, ne, k, 1);
+        struct Matrix colC = matrixView(C, 0, ne, me, 1);
+        modLeaf(&rowsA, eA, &colB, eB, &colC, 0, field);
+    }
+    if (me < m) {
+        struct Matrix rowA = matrixView(A, me, 0, 1, k);
+        struct Matrix rowC = matrixView(C, me, 0, 1, n);
+        modLeaf(&rowA, eA, B, eB, &rowC, 0, field);
+    }
+}
+
+/**
+ * Hybrid Strassen multiplication modulo p
+ * @param A      First input matrix (m x k), residues
+ * @param B      Second input matrix (k x n), residues
+ * @param C      Output matrix (m x n)
+ * @param cutoff Size threshold below which the leaf kernel is used
+ * @param field  Prime field
+ * @return       Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMulMod_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff,
+                                     const struct ModField* field) {
+    if (cutoff < 1) cutoff = 1;
+
+    size_t size = modWorkspaceSize(A->row, A->col, B->col, cutoff);
+    uint32_t* ws = malloc(sizeof(uint32_t) * (size > 0 ? size : 1));
+    if (ws == NULL) return NULL;
+
+    strassenRecursiveMod(A, 1, B, 1, C, cutoff, field, ws);
+    free(ws);
+    return C;
+}
+
+/*********************************************
+ * Verification modulo p
+ *********************************************/
+
+/**
+ * Checks C = A * B mod p with Freivalds' algorithm
+ * @param A              First operand (m x k), residues
+ * @param B              Second operand (k x n), residues
+ * @param C              Product to check (m x n)
+ * @param field          Prime field
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is certainly wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int verifyProductMod(struct Matrix* A, struct Matrix* B, struct Matrix* C, const struct ModField* field,
+                     double falsePositive, unsigned long long seed) {
+    if (!(falsePositive > 0.0 && falsePositive < 1.0)) return -1;
+    if (A->col != B->row || C->row != A->row || C->col != B->col) return -1;
+
+    /* A product modulo p holds residues only; this also keeps the leaf bounds valid for C */
+    for (int i = 0; i < C->row; i++) {
+        const int* row = &matrixElem(C->matrix, i, 0, C->ld);
+        for (int j = 0; j < C->col; j++) {
+            if (row[j] < 0 || (uint32_t)row[j] >= field->p) return 0;
+        }
+    }
+
+    /* A round with a uniform vector passes a wrong product with probability 1/p */
+    int rounds = (int)ceil(log(falsePositive) / -log((double)field->p));
+    if (rounds < 1) rounds = 1;
+
+    int m = C->row, k = A->col, n = C->col;
+    struct Matrix X = allocMatrixRect(n, rounds);
+    struct Matrix BX = allocMatrixRect(k, rounds);
+    struct Matrix ABX = allocMatrixRect(m, rounds);
+    struct Matrix CX = allocMatrixRect(m, rounds);
+    int result = -1;
+    if (X.matrix != NULL && BX.matrix != NULL && ABX.matrix != NULL && CX.matrix != NULL) {
+        /* Every column of X is one round */
+        fillMatrixRandMod(&X, field, seed);
+        mulMod(B, &X, &BX, field);
+        mulMod(A, &BX, &ABX, field);
+        mulMod(C, &X, &CX, field);
+        result = memcmp(ABX.matrix, CX.matrix, sizeof(int) * (size_t)m * rounds) == 0;
+    }
+    freeMatrix(&X);
+    freeMatrix(&BX);
+    freeMatrix(&ABX);
+    freeMatrix(&CX);
+    return result;
+}
@@ -0,0 +1,342 @@
+#include <limits.h>
+#include <stdlib.h>
+#include "matrix.h"
+#include "simd.h"
+
+/******************************************
+ * Z-order (Morton) block layout
+ *
+ * A side x side matrix with side = tile * 2^levels is stored as its four
+ * quadrants one after the other, [Q11 | Q12 | Q21 | Q22], each quadrant
+ * laid out the same way, down to tile x tile blocks stored row-major.
+ * Every block of the recursion is therefore one contiguous range: at a
+ * level of side s, quadrant i of a block starting at p starts at
+ * p + i * (s/2)^2.
+ *
+ * Tile t of the matrix (t-th tile in memory) sits at tile row/column
+ * given by de-interleaving the bits of t: odd bits give the row, even
+ * bits the column.
+ *******************************************/
+
+/**
+ * Keeps the even bits of x and packs them into the low half
+ * @param x      Interleaved value
+ * @return       Compacted even bits
+ */
+static unsigned compactBits(unsigned x) {
+    x &= 0x55555555u;
+    x = (x | (x >> 1)) & 0x33333333u;
+    x = (x | (x >> 2)) & 0x0F0F0F0Fu;
+    x = (x | (x >> 4)) & 0x00FF00FFu;
+    x = (x | (x >> 8)) & 0x0000FFFFu;
+    return x;
+}
+
+/**
+ * Returns the tile side used to store a side x side matrix in Morton order
+ * The smallest number of levels is chosen such that the tile, the side
+ * divided by 2^levels rounded up, does not exceed maxTile
+ *
+ * @param side       Side length of the matrix
+ * @param maxTile    Largest allowed tile side
+ * @return           Tile side
+ */
+int mortonTileSize(int side, int maxTile) {
+    int levels = 0;
+
+    if (maxTile < 1) maxTile = 1;
+    while (((side + (1 << levels) - 1) >> levels) > maxTile) {
+        levels++;
+    }
+    return (side + (1 << levels) - 1) >> levels;
+}
+
+/**
+ * Allocates a matrix in Morton layout
+ * @param side       Side length of the matrix
+ * @param maxTile    Largest allowed tile side
+ * @return           Morton matrix (data is NULL on allocation failure)
+ */
+struct MortonMatrix allocMorton(int side, int maxTile) {
+    struct MortonMatrix mat;
+    mat.tile = mortonTileSize(side, maxTile);
+    mat.side = mat.tile;
+    while (mat.side < side) {
+        mat.side *= 2;
+    }
+    mat.n = side;
+    mat.data = malloc(sizeof(int) * (size_t)mat.side * mat.side);
+    return mat;
+}
+
+/**
+ * Frees a matrix in Morton layout
+ * @param mat    Matrix to free
+ */
+void freeMorton(struct MortonMatrix* mat) {
+    free(mat->data);
+    mat->data = NULL;
+    mat->n = 0;
+    mat->side = 0;
+    mat->tile = 0;
+}
+
+/**
+ * Converts a row-major matrix to Morton layout
+ * Each tile is copied row by row; the padding beyond n is zeroed
+ * @param src    Row-major matrix (or view) of side dst->n
+ * @param dst    Morton matrix
+ * @return       0 on success
+ */
+int toMorton(struct Matrix* src, struct MortonMatrix* dst) {
+    int tile = dst->tile;
+    size_t tileElems = (size_t)tile * tile;
+    unsigned tiles = (unsigned)(dst->side / tile) * (unsigned)(dst->side / tile);
+
+    for (unsigned t = 0; t < tiles; t++) {
+        int row = (int)compactBits(t >> 1) * tile;
+        int col = (int)compactBits(t) * tile;
+        int* out = dst->data + t * tileElems;
+
+        /* Part of the tile inside the logical matrix */
+        int rows = dst->n - row < tile ? dst->n - row : tile;
+        int cols = dst->n - col < tile ? dst->n - col : tile;
+        if (rows < 0) rows = 0;
+        if (cols < 0) cols = 0;
+
+        for (int i = 0; i < rows; i++) {
+            rowKernels.copy(out + (size_t)i * tile, &matrixElem(src->matrix, row + i, col, src->ld), cols);
+            rowKernels.zero(out + (size_t)i * tile + cols, tile - cols);
+        }
+        rowKernels.zero(out + (size_t)rows * tile, (tile - rows) * tile);
+    }
+    return 0;
+}
+
+/**
+ * Converts a Morton matrix back to row-major layout
+ * Only the logical n x n part is written
+ * @param src    Morton matrix
+ * @param dst    Row-major matrix (or view) of side src->n
+ * @return       0 on success
+ */
+int fromMorton(struct MortonMatrix* src, struct Matrix* dst) {
+    int tile = src->tile;
+    size_t tileElems = (size_t)tile * tile;
+    unsigned tiles = (unsigned)(src->side / tile) * (unsigned)(src->side / tile);
+
+    for (unsigned t = 0; t < tiles; t++) {
+        int row = (int)compactBits(t >> 1) * tile;
+        int col = (int)compactBits(t) * tile;
+        const int* in = src->data + t * tileElems;
+
+        int rows = src->n - row < tile ? src->n - row : tile;
+        int cols = src->n - col < tile ? src->n - col : tile;
+
+        for (int i = 0; i < rows; i++) {
+            rowKernels.copy(&matrixElem(dst->matrix, row + i, col, dst->ld), in + (size_t)i * tile, cols);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Returns the number of bytes of workspace needed by strassenMul_morton_ws
+ * Three (s/2)^2 temporaries per level down to the tile, plus the packing
+ * buffers of the blocked leaf when it is selected
+ *
+ * @param side       Padded side of the Morton matrices
+ * @param tile       Tile side
+ * @return           Size of the arena in bytes
+ */
+size_t strassenMortonWorkspaceSize(int side, int tile) {
+    size_t elems = 0;
+
+    while (side > tile) {
+        size_t half = side / 2;
+        elems += 3 * half * half;
+        side = (int)half;
+    }
+    if (getHybridLeaf() == LEAF_BLOCKED) {
+        return elems * sizeof(int) + gemmPackSize(tile, tile, tile);
+    }
+    return elems * sizeof(int);
+}
+
+/**
+ * Builds a row-major header over one tile
+ * @param data   First element of the tile
+ * @param tile   Tile side
+ * @return       Matrix struct pointing to the tile
+ */
+static struct Matrix tileMatrix(int* data, int tile) {
+    struct Matrix mat;
+    mat.matrix = data;
+    mat.row = tile;
+    mat.col = tile;
+    mat.ld = tile;
+    return mat;
+}
+
+/**
+ * Recursive step of the Morton engine
+ * Every block is contiguous, so each addition is one kernel call over
+ * (side/2)^2 elements and quadrants are found by pointer arithmetic
+ *
+ * @param A      First input block
+ * @param B      Second input block
+ * @param C      Output block
+ * @param side   Side of the blocks
+ * @param tile   Tile side (leaf size)
+ * @param ws     Workspace arena for this level and the ones below it
+ */
+static void mortonRecursive(int* A, int* B, int* C, int side, int tile, int* ws) {
+    if (side <= tile) {
+        struct Matrix a = tileMatrix(A, tile), b = tileMatrix(B, tile), c = tileMatrix(C, tile);
+        if (getHybridLeaf() == LEAF_BLOCKED) {
+            mulBlocked_ws(&a, &b, &c, ws);
+        } else {
+            mul(&a, &b, &c);
+        }
+        return;
+    }
+
+    int h = side / 2;
+    size_t q = (size_t)h * h;
+    int *A11 = A, *A12 = A + q, *A21 = A + 2 * q, *A22 = A + 3 * q;
+    int *B11 = B, *B12 = B + q, *B21 = B + 2 * q, *B22 = B + 3 * q;
+    int *C11 = C, *C12 = C + q, *C21 = C + 2 * q, *C22 = C + 3 * q;
+    int *temp1 = ws, *temp2 = ws + q, *P = ws + 2 * q;
+    int* next = ws + 3 * q;
+
+    /* P1 = (A12 - A22) * (B21 + B22), C11 = P1 */
+    rowKernels.sub(temp1, A12, A22, q);
+    rowKernels.add(temp2, B21, B22, q);
+    mortonRecursive(temp1, temp2, C11, h, tile, next);
+
+    /* P2 = (A11 + A22) * (B11 + B22); C11 += P2, C22 = P2 */
+    rowKernels.add(temp1, A11, A22, q);
+    rowKernels.add(temp2, B11, B22, q);
+    mortonRecursive(temp1, temp2, P, h, tile, next);
+    rowKernels.addInPlace(C11, P, q);
+    rowKernels.copy(C22, P, q);
+
+    /* P3 = (A11 - A21) * (B11 + B12); C22 -= P3 */
+    rowKernels.sub(temp1, A11, A21, q);
+    rowKernels.add(temp2, B11, B12, q);
+    mortonRecursive(temp1, temp2, P, h, tile, next);
+    rowKernels.subInPlace(C22, P, q);
+
+    /* P4 = (A11 + A12) * B22, C12 = P4; C11 -= P4 */
+    rowKernels.add(temp1, A11, A12, q);
+    mortonRecursive(temp1, B22, C12, h, tile, next);
+    rowKernels.subInPlace(C11, C12, q);
+
+    /* P5 = A11 * (B12 - B22); C12 += P5, C22 += P5 */
+    rowKernels.sub(temp2, B12, B22, q);
+    mortonRecursive(A11, temp2, P, h, tile, next);
+    rowKernels.addInPlace(C12, P, q);
+    rowKernels.addInPlace(C22, P, q);
+
+    /* P6 = A22 * (B21 - B11), C21 = P6; C11 += P6 */
+    rowKernels.sub(temp2, B21, B11, q);
+    mortonRecursive(A22, temp2, C21, h, tile, next);
+    rowKernels.addInPlace(C11, C21, q);
+
+    /* P7 = (A21 + A22) * B11; C21 += P7, C22 -= P7 */
+    rowKernels.add(temp1, A21, A22, q);
+    mortonRecursive(temp1, B11, P, h, tile, next);
+    rowKernels.addInPlace(C21, P, q);
+    rowKernels.subInPlace(C22, P, q);
+}
+
+/**
+ * Checks that three Morton matrices can be multiplied together
+ * They must share side and tile, the side must be the tile times a power
+ * of two, and a quadrant must fit the int length of the row kernels
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @return       1 if the shapes match, 0 otherwise
+ */
+static int mortonShapesMatch(struct MortonMatrix* A, struct MortonMatrix* B, struct MortonMatrix* C) {
+    if (A->tile < 1 || A->side < A->tile || A->side % A->tile != 0) return 0;
+    if (B->side != A->side || C->side != A->side || B->tile != A->tile || C->tile != A->tile) return 0;
+
+    int tiles = A->side / A->tile;
+    if ((tiles & (tiles - 1)) != 0) return 0;
+    return (size_t)(A->side / 2) * (A->side / 2) <= INT_MAX;
+}
+
+/**
+ * Hybrid Strassen on Morton matrices and a caller-supplied arena
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix, same side and tile as A and B
+ * @param workspace  Arena of at least strassenMortonWorkspaceSize(A->side, A->tile) bytes
+ * @return           Pointer to the result matrix C, NULL if the shapes do not match
+ */
+struct MortonMatrix* strassenMul_morton_ws(struct MortonMatrix* A, struct MortonMatrix* B,
+                                           struct MortonMatrix* C, void* workspace) {
+    if (!mortonShapesMatch(A, B, C)) return NULL;
+
+    mortonRecursive(A->data, B->data, C->data, A->side, A->tile, workspace);
+    return C;
+}
+
+/**
+ * Hybrid Strassen on Morton matrices
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix, same side and tile as A and B
+ * @return       Pointer to the result matrix C, NULL if the shapes do not match
+ *               or the arena cannot be allocated
+ */
+struct MortonMatrix* strassenMul_morton(struct MortonMatrix* A, struct MortonMatrix* B,
+                                        struct MortonMatrix* C) {
+    if (!mortonShapesMatch(A, B, C)) return NULL;
+
+    void* workspace = malloc(strassenMortonWorkspaceSize(A->side, A->tile) + 1);
+    if (workspace == NULL) return NULL;
+
+    strassenMul_morton_ws(A, B, C, workspace);
+
+    free(workspace);
+    return C;
+}
+
+/**
+ * Multiplies square row-major matrices through the Morton engine
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix (must be pre-allocated)
+ * @param cutoff     Largest tile side
+ * @return           Pointer to the result matrix C, NULL if A, B and C are not
+ *                   square of the same side or on allocation failure
+ */
+struct Matrix* strassenMul_viaMorton(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    int side = A->row;
+    if (A->col != side || B->row != side || B->col != side || C->row != side || C->col != side) {
+        return NULL;
+    }
+
+    struct Matrix* result = NULL;
+    struct MortonMatrix a = allocMorton(side, cutoff);
+    struct MortonMatrix b = allocMorton(side, cutoff);
+    struct MortonMatrix c = allocMorton(side, cutoff);
+
+    if (a.data != NULL && b.data != NULL && c.data != NULL) {
+        toMorton(A, &a);
+        toMorton(B, &b);
+        if (strassenMul_morton(&a, &b, &c) != NULL) {
+            fromMorton(&c, C);
+            result = C;
+        }
+    }
+
+    freeMorton(&a);
+    freeMorton(&b);
+    freeMorton(&c);
+    return result;
+}
@@ -0,0 +1,560 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "matrixfile.h"
+
+/******************************************
+ * Out-of-core Strassen
+ *
+ * The top levels run on the memory-mapped quadrants of A, B and C.
+ * Their temporaries (temp1, temp2, P, as in strassenLevel) are sliced
+ * from a scratch file mapped the same way. Every block operation of these
+ * levels walks its operands in horizontal strips sized from the memory
+ * budget: before a strip is processed the next one is prefetched with
+ * MADV_WILLNEED, and once it is done its pages are dropped from the
+ * process with MADV_DONTNEED. The data stays in the page cache and in
+ * the files, so the resident set stays around the budget.
+ *
+ * A subproblem whose operands, result and Strassen arena fit the
+ * budget is copied into RAM, multiplied by strassenMul_hybrid_ws and
+ * copied back. Above the budget a level halves the largest dimension
+ * when the shape is unbalanced or a dimension is <= cutoff (no
+ * temporaries, or one m x n temporary when k is halved), peels odd
+ * dimensions, and otherwise applies Strassen's formulas.
+ *******************************************/
+
+#define OOC_MAX_RANGES 4
+
+/**
+ * Block operations of the out-of-core levels
+ */
+enum OocOp {
+    OOC_SUM,            /* Z = X + Y */
+    OOC_DIFF,           /* Z = X - Y */
+    OOC_ADD,            /* Z += X */
+    OOC_SUBTRACT,       /* Z -= X */
+    OOC_COPY            /* Z = X */
+};
+
+/**
+ * State of one out-of-core multiplication
+ */
+struct OocRun {
+    int cutoff;
+    size_t budget;
+    size_t pageSize;
+    char* rangeStart[OOC_MAX_RANGES];   /* File-backed mappings: pages may be dropped */
+    char* rangeEnd[OOC_MAX_RANGES];
+    int rangeCount;
+    char* ram;                          /* In-memory operands, result and arena of a leaf */
+    struct OutOfCoreReport* report;
+};
+
+/**
+ * Returns the bytes needed to multiply an m x k by k x n product in RAM
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine
+ * @return           Operands, result and Strassen arena in bytes
+ */
+static size_t leafBytes(int m, int k, int n, int cutoff) {
+    size_t elems = (size_t)m * k + (size_t)k * n + (size_t)m * n;
+    return elems * sizeof(int) + 3 * 64 + strassenWorkspaceSizeRect(m, k, n, cutoff);
+}
+
+/**
+ * Returns 1 if a level halves its largest dimension instead of applying Strassen
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine
+ * @return           1 for a halving level, 0 otherwise
+ */
+static int halvingLevel(int m, int k, int n, int cutoff) {
+    int largest = m > k ? (m > n ? m : n) : (k > n ? k : n);
+    int smallest = m < k ? (m < n ? m : n) : (k < n ? k : n);
+    return smallest <= cutoff || largest >= 2 * smallest;
+}
+
+/**
+ * Walks the out-of-core levels of a product exactly as oocLevel does
+ * Both halves of a halving level are followed, since halves of an odd
+ * dimension may take different paths
+ *
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine
+ * @param budget     Memory budget in bytes
+ * @param leafMax    Updated with the largest in-memory subproblem in bytes
+ * @param levels     Updated with the deepest out-of-core level
+ * @param depth      Depth of this level
+ * @return           Scratch file size in ints for this level and the ones below it
+ */
+static size_t oocPlan(int m, int k, int n, int cutoff, size_t budget,
+                      size_t* leafMax, int* levels, int depth) {
+    size_t bytes = leafBytes(m, k, n, cutoff);
+    if (bytes <= budget || m == 0 || n == 0 || (m <= 1 && k <= 1 && n <= 1)) {
+        if (bytes > *leafMax) *leafMax = bytes;
+        if (depth > *levels) *levels = depth;
+        return 0;
+    }
+
+    if (halvingLevel(m, k, n, cutoff)) {
+        size_t first, second;
+        if (m >= k && m >= n) {
+            first = oocPlan(m / 2, k, n, cutoff, budget, leafMax, levels, depth + 1);
+            second = m & 1 ? oocPlan(m - m / 2, k, n, cutoff, budget, leafMax, levels, depth + 1) : first;
+            return first > second ? first : second;
+        }
+        if (n >= k) {
+            first = oocPlan(m, k, n / 2, cutoff, budget, leafMax, levels, depth + 1);
+            second = n & 1 ? oocPlan(m, k, n - n / 2, cutoff, budget, leafMax, levels, depth + 1) : first;
+            return first > second ? first : second;
+        }
+        first = oocPlan(m, k / 2, n, cutoff, budget, leafMax, levels, depth + 1);
+        second = k & 1 ? oocPlan(m, k - k / 2, n, cutoff, budget, leafMax, levels, depth + 1) : first;
+        return (size_t)m * n + (first > second ? first : second);
+    }
+
+    if ((m | k | n) & 1) {
+        return oocPlan(m & ~1, k & ~1, n & ~1, cutoff, budget, leafMax, levels, depth + 1);
+    }
+
+    return (size_t)(m / 2) * (k / 2) + (size_t)(k / 2) * (n / 2) + (size_t)(m / 2) * (n / 2) +
+           oocPlan(m / 2, k / 2, n / 2, cutoff, budget, leafMax, levels, depth + 1);
+}
+
+/**
+ * Applies madvise to the pages holding rows of a block
+ * Only blocks of file-backed mappings are advised: dropping the pages of
+ * heap memory would lose its contents
+ *
+ * @param run    Out-of-core state
+ * @param X      Block
+ * @param advice MADV_WILLNEED or MADV_DONTNEED
+ */
+static void adviseBlock(struct OocRun* run, struct Matrix* X, int advice) {
+    if (X == NULL || X->row == 0 || X->col == 0) return;
+
+    char* first = (char*)X->matrix;
+    char* last = (char*)(X->matrix + (size_t)(X->row - 1) * X->ld + X->col);
+    for (int r = 0; r < run->rangeCount; r++) {
+        if (first >= run->rangeStart[r] && first < run->rangeEnd[r]) {
+            char* start = (char*)((size_t)first & ~(run->pageSize - 1));
+            char* end = (char*)(((size_t)last + run->pageSize - 1) & ~(run->pageSize - 1));
+            if (end > run->rangeEnd[r]) end = run->rangeEnd[r];
+            madvise(start, (size_t)(end - start), advice);
+            return;
+        }
+    }
+}
+
+/**
+ * Returns the number of rows of the strips of a block operation
+ * Six strips (three operands, three prefetched) take about 3/4 of the budget
+ *
+ * @param run    Out-of-core state
+ * @param cols   Columns of the operands
+ * @return       Rows per strip, even and at least 2
+ */
+static int stripRows(struct OocRun* run, int cols) {
+    size_t rows = run->budget / 8 / ((size_t)(cols > 0 ? cols : 1) * sizeof(int));
+    if (rows > 0x7ffffffe) rows = 0x7ffffffe;
+    return rows < 2 ? 2 : (int)rows & ~1;
+}
+
+/**
+ * Returns a strip of a block, NULL for a NULL block
+ * @param X      Block
+ * @param row    First row of the strip
+ * @param rows   Rows of the strip
+ * @param strip  Storage for the view
+ * @return       Pointer to the view
+ */
+static struct Matrix* stripOf(struct Matrix* X, int row, int rows, struct Matrix* strip) {
+    if (X == NULL) return NULL;
+    *strip = matrixView(X, row, 0, rows, X->col);
+    return strip;
+}
+
+/**
+ * Runs a block operation strip by strip, prefetching the next strip and
+ * dropping the current one
+ * @param run    Out-of-core state
+ * @param op     Operation
+ * @param X      First operand
+ * @param Y      Second operand (OOC_SUM and OOC_DIFF only, NULL otherwise)
+ * @param Z      Destination, same shape as X
+ */
+static void oocStrips(struct OocRun* run, enum OocOp op, struct Matrix* X, struct Matrix* Y, struct Matrix* Z) {
+    int rows = X->row, cols = X->col;
+    int step = stripRows(run, cols);
+    int readsZ = op == OOC_ADD || op == OOC_SUBTRACT;
+
+    for (int r = 0; r < rows; r += step) {
+        int h = rows - r < step ? rows - r : step;
+        struct Matrix xs, ys, zs, next;
+
+        /* Start reading the next strip while this one is processed */
+        if (r + h < rows) {
+            int nh = rows - r - h < step ? rows - r - h : step;
+            adviseBlock(run, stripOf(X, r + h, nh, &next), MADV_WILLNEED);
+            adviseBlock(run, stripOf(Y, r + h, nh, &next), MADV_WILLNEED);
+            if (readsZ) adviseBlock(run, stripOf(Z, r + h, nh, &next), MADV_WILLNEED);
+        }
+
+        stripOf(X, r, h, &xs);
+        stripOf(Z, r, h, &zs);
+        switch (op) {
+            case OOC_SUM:      sumMatrixRect(&xs, 0, 0, stripOf(Y, r, h, &ys), 0, 0, &zs, 0, 0, h, cols); break;
+            case OOC_DIFF:     subMatrixRect(&xs, 0, 0, stripOf(Y, r, h, &ys), 0, 0, &zs, 0, 0, h, cols); break;
+            case OOC_ADD:      addSubmatrixRect(&xs, &zs, 0, 0, h, cols); break;
+            case OOC_SUBTRACT: subSubmatrixRect(&xs, &zs, 0, 0, h, cols); break;
+            case OOC_COPY:     copySubmatrixRect(&xs, 0, 0, &zs, 0, 0, h, cols); break;
+        }
+
+        adviseBlock(run, &xs, MADV_DONTNEED);
+        adviseBlock(run, stripOf(Y, r, h, &ys), MADV_DONTNEED);
+        adviseBlock(run, &zs, MADV_DONTNEED);
+    }
+}
+
+/**
+ * Multiplies a subproblem that fits the budget in RAM
+ * @param run    Out-of-core state
+ * @param A      First operand (view on a mapping)
+ * @param B      Second operand
+ * @param C      Result
+ */
+static void oocLeaf(struct OocRun* run, struct Matrix* A, struct Matrix* B, struct Matrix* C) {
+    int m = A->row, k = A->col, n = B->col;
+    int* a = (int*)run->ram;
+    int* b = a + (((size_t)m * k + 15) & ~(size_t)15);
+    int* c = b + (((size_t)k * n + 15) & ~(size_t)15);
+    void* ws = c + (((size_t)m * n + 15) & ~(size_t)15);
+
+    struct Matrix ramA = { a, m, k, k };
+    struct Matrix ramB = { b, k, n, n };
+    struct Matrix ramC = { c, m, n, n };
+
+    oocStrips(run, OOC_COPY, A, NULL, &ramA);
+    oocStrips(run, OOC_COPY, B, NULL, &ramB);
+    strassenMul_hybrid_ws(&ramA, &ramB, &ramC, run->cutoff, ws);
+    oocStrips(run, OOC_COPY, &ramC, NULL, C);
+
+    run->report->leaves++;
+    run->report->bytesIn += ((size_t)m * k + (size_t)k * n) * sizeof(int);
+    run->report->bytesOut += (size_t)m * n * sizeof(int);
+}
+
+/**
+ * Fixes up the odd rows and columns of a peeled out-of-core level
+ * Runs peelUpdate on strips of A and C with an even number of rows, so
+ * that only the last strip carries the odd row
+ *
+ * @param run    Out-of-core state
+ * @param A      First operand
+ * @param B      Second operand
+ * @param C      Result, leading even block already computed
+ */
+static void oocPeel(struct OocRun* run, struct Matrix* A, struct Matrix* B, struct Matrix* C) {
+    int rows = A->row;
+    int step = stripRows(run, B->col > A->col ? B->col : A->col);
+
+    for (int r = 0; r < rows; ) {
+        int h = rows - r < step ? rows - r : step;
+        if (rows - r - h == 1) h++;   /* Keep the odd row in the last strip */
+
+        struct Matrix as = matrixView(A, r, 0, h, A->col);
+        struct Matrix cs = matrixView(C, r, 0, h, C->col);
+        peelUpdate(&as, B, &cs);
+
+        adviseBlock(run, &as, MADV_DONTNEED);
+        adviseBlock(run, B, MADV_DONTNEED);
+        adviseBlock(run, &cs, MADV_DONTNEED);
+        r += h;
+    }
+}
+
+/**
+ * One out-of-core recursion level
+ * @param run    Out-of-core state
+ * @param A      First operand
+ * @param B      Second operand
+ * @param C      Result
+ * @param ws     Scratch file arena for this level and the ones below it
+ */
+static void oocLevel(struct OocRun* run, struct Matrix* A, struct Matrix* B, struct Matrix* C, int* ws) {
+    int m = A->row, k = A->col, n = B->col;
+
+    if (leafBytes(m, k, n, run->cutoff) <= run->budget || m == 0 || n == 0 || (m <= 1 && k <= 1 && n <= 1)) {
+        oocLeaf(run, A, B, C);
+        return;
+    }
+
+    /* Halve the largest dimension; halves may differ by one */
+    if (halvingLevel(m, k, n, run->cutoff)) {
+        if (m >= k && m >= n) {
+            int h = m / 2;
+            struct Matrix A1 = matrixView(A, 0, 0, h, k), A2 = matrixView(A, h, 0, m - h, k);
+            struct Matrix C1 = matrixView(C, 0, 0, h, n), C2 = matrixView(C, h, 0, m - h, n);
+            oocLevel(run, &A1, B, &C1, ws);
+            oocLevel(run, &A2, B, &C2, ws);
+        } else if (n >= k) {
+            int h = n / 2;
+            struct Matrix B1 = matrixView(B, 0, 0, k, h), B2 = matrixView(B, 0, h, k, n - h);
+            struct Matrix C1 = matrixView(C, 0, 0, m, h), C2 = matrixView(C, 0, h, m, n - h);
+            oocLevel(run, A, &B1, &C1, ws);
+            oocLevel(run, A, &B2, &C2, ws);
+        } else {
+            int h = k / 2;
+            struct Matrix A1 = matrixView(A, 0, 0, m, h), A2 = matrixView(A, 0, h, m, k - h);
+            struct Matrix B1 = matrixView(B, 0, 0, h, n), B2 = matrixView(B, h, 0, k - h, n);
+            struct Matrix P = { ws, m, n, n };
+            oocLevel(run, &A1, &B1, C, ws + (size_t)m * n);
+            oocLevel(run, &A2, &B2, &P, ws + (size_t)m * n);
+            oocStrips(run, OOC_ADD, &P, NULL, C);
+        }
+        return;
+    }
+
+    /* Odd dimension: even leading product, then the strip-wise fix-up */
+    if ((m | k | n) & 1) {
+        struct Matrix A11 = matrixView(A, 0, 0, m & ~1, k & ~1);
+        struct Matrix B11 = matrixView(B, 0, 0, k & ~1, n & ~1);
+        struct Matrix C11 = matrixView(C, 0, 0, m & ~1, n & ~1);
+        oocLevel(run, &A11, &B11, &C11, ws);
+        oocPeel(run, A, B, C);
+        return;
+    }
+
+    int hm = m / 2, hk = k / 2, hn = n / 2;
+    struct Matrix temp1 = { ws, hm, hk, hk };
+    struct Matrix temp2 = { ws + (size_t)hm * hk, hk, hn, hn };
+    struct Matrix P = { ws + (size_t)hm * hk + (size_t)hk * hn, hm, hn, hn };
+    int* next = ws + (size_t)hm * hk + (size_t)hk * hn + (size_t)hm * hn;
+
+    struct Matrix A11 = matrixView(A, 0, 0, hm, hk), A12 = matrixView(A, 0, hk, hm, hk);
+    struct Matrix A21 = matrixView(A, hm, 0, hm, hk), A22 = matrixView(A, hm, hk, hm, hk);
+    struct Matrix B11 = matrixView(B, 0, 0, hk, hn), B12 = matrixView(B, 0, hn, hk, hn);
+    struct Matrix B21 = matrixView(B, hk, 0, hk, hn), B22 = matrixView(B, hk, hn, hk, hn);
+    struct Matrix C11 = matrixView(C, 0, 0, hm, hn), C12 = matrixView(C, 0, hn, hm, hn);
+    struct Matrix C21 = matrixView(C, hm, 0, hm, hn), C22 = matrixView(C, hm, hn, hm, hn);
+
+    /* Same schedule as strassenLevel */
+
+    /* P1 = (A12 - A22) * (B21 + B22), C11 = P1 */
+    oocStrips(run, OOC_DIFF, &A12, &A22, &temp1);
+    oocStrips(run, OOC_SUM, &B21, &B22, &temp2);
+    oocLevel(run, &temp1, &temp2, &C11, next);
+
+    /* P2 = (A11 + A22) * (B11 + B22), C11 += P2, C22 = P2 */
+    oocStrips(run, OOC_SUM, &A11, &A22, &temp1);
+    oocStrips(run, OOC_SUM, &B11, &B22, &temp2);
+    oocLevel(run, &temp1, &temp2, &P, next);
+    oocStrips(run, OOC_ADD, &P, NULL, &C11);
+    oocStrips(run, OOC_COPY, &P, NULL, &C22);
+
+    /* P3 = (A11 - A21) * (B11 + B12), C22 -= P3 */
+    oocStrips(run, OOC_DIFF, &A11, &A21, &temp1);
+    oocStrips(run, OOC_SUM, &B11, &B12, &temp2);
+    oocLevel(run, &temp1, &temp2, &P, next);
+    oocStrips(run, OOC_SUBTRACT, &P, NULL, &C22);
+
+    /* P4 = (A11 + A12) * B22, C12 = P4, C11 -= P4 */
+    oocStrips(run, OOC_SUM, &A11, &A12, &temp1);
+    oocLevel(run, &temp1, &B22, &C12, next);
+    oocStrips(run, OOC_SUBTRACT, &C12, NULL, &C11);
+
+    /* P5 = A11 * (B12 - B22), C12 += P5, C22 += P5 */
+    oocStrips(run, OOC_DIFF, &B12, &B22, &temp2);
+    oocLevel(run, &A11, &temp2, &P, next);
+    oocStrips(run, OOC_ADD, &P, NULL, &C12);
+    oocStrips(run, OOC_ADD, &P, NULL, &C22);
+
+    /* P6 = A22 * (B21 - B11), C21 = P6, C11 += P6 */
+    oocStrips(run, OOC_DIFF, &B21, &B11, &temp2);
+    oocLevel(run, &A22, &temp2, &C21, next);
+    oocStrips(run, OOC_ADD, &C21, NULL, &C11);
+
+    /* P7 = (A21 + A22) * B11, C21 += P7, C22 -= P7 */
+    oocStrips(run, OOC_SUM, &A21, &A22, &temp1);
+    oocLevel(run, &temp1, &B11, &P, next);
+    oocStrips(run, OOC_ADD, &P, NULL, &C21);
+    oocStrips(run, OOC_SUBTRACT, &P, NULL, &C22);
+}
+
+/**
+ * Reads a field of /proc/self/io
+ * @param field  Field name including the colon, e.g. "read_bytes:"
+ * @return       Value, -1 if unavailable
+ */
+static long long procIo(const char* field) {
+    char line[128];
+    long long value = -1;
+    FILE* file = fopen("/proc/self/io", "r");
+    if (file == NULL) return -1;
+
+    size_t length = strlen(field);
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, field, length) == 0) {
+            value = atoll(line + length);
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+/**
+ * Returns the peak resident set size of the process (VmHWM)
+ * @return       Bytes, -1 if unavailable
+ */
+static long long peakRss(void) {
+    char line[128];
+    long long value = -1;
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file == NULL) return -1;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            value = atoll(line + 6) * 1024;
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+/**
+ * Resets the peak resident set size, so that VmHWM covers this run only
+ * Needs Linux >= 4.0; the reset is skipped silently otherwise
+ */
+static void resetPeakRss(void) {
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (file == NULL) return;
+    fputs("5", file);
+    fclose(file);
+}
+
+/**
+ * Registers a file-backed mapping whose pages may be dropped
+ * @param run    Out-of-core state
+ * @param base   Start of the mapping
+ * @param length Length in bytes
+ */
+static void addRange(struct OocRun* run, void* base, size_t length) {
+    if (base == NULL || run->rangeCount == OOC_MAX_RANGES) return;
+    run->rangeStart[run->rangeCount] = base;
+    run->rangeEnd[run->rangeCount] = (char*)base + length;
+    run->rangeCount++;
+}
+
+/**
+ * Creates the unlinked scratch file of the out-of-core levels and maps it
+ * @param dir    Directory of the file, NULL for the current one
+ * @param bytes  Size of the file
+ * @return       Mapping, NULL on failure
+ */
+static void* mapScratch(const char* dir, size_t bytes) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/strassen-scratch-XXXXXX", dir != NULL ? dir : ".");
+
+    int fd = mkstemp(path);
+    if (fd < 0) return NULL;
+    unlink(path);   /* Removed by the system when unmapped, even after a crash */
+
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0) {
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return base != MAP_FAILED ? base : NULL;
+}
+
+/**
+ * Multiplies matrices that do not fit in memory
+ * @param A          First operand, usually mapped with mapMatrixFile
+ * @param B          Second operand
+ * @param C          Result, usually created with createMatrixFile
+ * @param cutoff     Size threshold of the in-memory engine, or CUTOFF_AUTO
+ * @param budget     Memory budget in bytes
+ * @param scratchDir Directory of the scratch file, NULL for the current one
+ * @param report     Receives the statistics of the run (may be NULL)
+ * @return           Pointer to C->mat, NULL if the scratch file or the
+ *                   in-memory buffers cannot be allocated
+ */
+struct Matrix* strassenMul_outOfCore(struct MappedMatrix* A, struct MappedMatrix* B, struct MappedMatrix* C,
+                                     int cutoff, size_t budget, const char* scratchDir,
+                                     struct OutOfCoreReport* report) {
+    struct OutOfCoreReport local;
+    struct OocRun run;
+    int m = A->mat.row, k = A->mat.col, n = B->mat.col;
+
+    if (cutoff == CUTOFF_AUTO) {
+        int largest = m > k ? (m > n ? m : n) : (k > n ? k : n);
+        cutoff = profileCutoff(largest);
+    }
+    if (cutoff < 1) cutoff = 1;
+
+    memset(&local, 0, sizeof(local));
+    memset(&run, 0, sizeof(run));
+    run.cutoff = cutoff;
+    run.budget = budget;
+    run.pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    run.report = &local;
+
+    size_t ramBytes = 0;
+    size_t scratchElems = oocPlan(m, k, n, cutoff, budget, &ramBytes, &local.levels, 0);
+    local.scratchBytes = scratchElems * sizeof(int);
+    local.ramBytes = ramBytes;
+
+    run.ram = malloc(ramBytes);
+    void* scratch = scratchElems > 0 ? mapScratch(scratchDir, local.scratchBytes) : NULL;
+    if (run.ram == NULL || (scratchElems > 0 && scratch == NULL)) {
+        free(run.ram);
+        return NULL;
+    }
+
+    addRange(&run, A->base, A->length);
+    addRange(&run, B->base, B->length);
+    addRange(&run, C->base, C->length);
+    addRange(&run, scratch, local.scratchBytes);
+
+    resetPeakRss();
+    long long read0 = procIo("read_bytes:"), write0 = procIo("write_bytes:");
+
+    oocLevel(&run, &A->mat, &B->mat, &C->mat, scratch);
+
+    /* Write the result back so that the I/O of the run is complete */
+    if (C->base != NULL) msync(C->base, C->length, MS_SYNC);
+
+    long long read1 = procIo("read_bytes:"), write1 = procIo("write_bytes:");
+    local.peakRssBytes = peakRss();
+    local.readBytes = read0 >= 0 && read1 >= 0 ? read1 - read0 : -1;
+    local.writeBytes = write0 >= 0 && write1 >= 0 ? write1 - write0 : -1;
+
+    if (scratch != NULL) munmap(scratch, local.scratchBytes);
+    free(run.ram);
+
+    if (report != NULL) *report = local;
+    return &C->mat;
+}
+
+/**
+ * Prints the statistics of an out-of-core run as one CSV header and line
+ * @param out        Output stream
+ * @param report     Statistics returned by strassenMul_outOfCore
+ */
+void printOutOfCoreReport(FILE* out, const struct OutOfCoreReport* report) {
+    fprintf(out, "levels,leaves,ram_bytes,scratch_bytes,peak_rss_bytes,read_bytes,write_bytes,"
+                 "bytes_in,bytes_out\n");
+    fprintf(out, "%d,%ld,%zu,%zu,%lld,%lld,%lld,%zu,%zu\n", report->levels, report->leaves,
+            report->ramBytes, report->scratchBytes, report->peakRssBytes, report->readBytes,
+            report->writeBytes, report->bytesIn, report->bytesOut);
+}
@@ -0,0 +1,308 @@
+#include <stdlib.h>
+#include "matrix.h"
+#include "workstealing.h"
+
+/******************************************
+ * Task-parallel Strassen engine
+ *
+ * At the top `depth` recursion levels the operands of the seven products
+ * are formed first, then P1..P7 are spawned as stealable tasks on the
+ * work-stealing runtime (workstealing.c). The spawning worker then runs
+ * or steals tasks until its seven products are done (taskSync), so nested
+ * levels never block a thread. Below `depth` (or once the side reaches
+ * the cutoff) a task runs the serial strassenMul_hybrid_ws, and so does
+ * a non-square product.
+ *
+ * Each task owns its operands, its result and its workspace arena:
+ *
+ *   parallel level (newSide = h): [10 operand buffers | 4 P buffers |
+ *                                  arena of P1 | arena of P2 | ... | arena of P7]
+ *
+ * P1, P4 and P6 are written straight into C11, C12 and C21 (disjoint
+ * blocks). The C-quadrant accumulations that need more than one product
+ * run only after all seven tasks have finished, in the same order as in
+ * the serial engine, so the result is identical to strassenMul_hybrid.
+ *******************************************/
+
+/* Operand and result buffers of one parallel level, in units of h * h */
+#define PARALLEL_LEVEL_BUFFERS 14
+
+/**
+ * One sub-product of a parallel level
+ */
+struct ProductTask {
+    struct Task task;           /* Runtime task, run = runProduct */
+    struct Matrix A;            /* Left operand (buffer or view) */
+    struct Matrix B;            /* Right operand (buffer or view) */
+    struct Matrix C;            /* Result (buffer or view on a C quadrant) */
+    int cutoff;                 /* Hybrid cutoff */
+    int depth;                  /* Parallel levels left below this product */
+    int* ws;                    /* Arena owned by this product */
+};
+
+/**
+ * Arguments of the root task of a parallel multiplication
+ */
+struct ParallelRun {
+    struct Matrix* A;
+    struct Matrix* B;
+    struct Matrix* C;
+    int cutoff;
+    int depth;
+    int* ws;
+};
+
+static void parallelRecursive(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                              int cutoff, int depth, int* ws);
+
+/**
+ * Task body: computes one product
+ * @param arg    ProductTask
+ */
+static void runProduct(void* arg) {
+    struct ProductTask* p = arg;
+    parallelRecursive(&p->A, &p->B, &p->C, p->cutoff, p->depth, p->ws);
+}
+
+/**
+ * Root task body: runs the top level of the recursion on a worker
+ * @param arg    ParallelRun
+ */
+static void runParallel(void* arg) {
+    struct ParallelRun* run = arg;
+    parallelRecursive(run->A, run->B, run->C, run->cutoff, run->depth, run->ws);
+}
+
+/**
+ * Returns the workspace needed by the parallel engine, in elements
+ * Non-square products are not split in parallel: they run the serial
+ * hybrid engine on their whole arena
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Hybrid cutoff
+ * @param depth      Parallel levels left
+ * @return           Number of ints of the arena
+ */
+static size_t parallelWorkspaceElems(int m, int k, int n, int cutoff, int depth) {
+    if (depth <= 0 || m <= cutoff || m != k || k != n) {
+        return strassenWorkspaceSizeRect(m, k, n, cutoff) / sizeof(int);
+    }
+    int side = m;
+    if (side % 2 != 0) {
+        return parallelWorkspaceElems(side - 1, side - 1, side - 1, cutoff, depth);   /* Peeled level */
+    }
+    size_t newSide = side / 2;
+    return PARALLEL_LEVEL_BUFFERS * newSide * newSide +
+           7 * parallelWorkspaceElems((int)newSide, (int)newSide, (int)newSide, cutoff, depth - 1);
+}
+
+/**
+ * Builds a square matrix header over a slice of the arena
+ * @param data   First element of the slice
+ * @param side   Side length of the matrix
+ * @return       Matrix struct pointing into the arena
+ */
+static struct Matrix sliceMatrix(int* data, int side) {
+    struct Matrix mat;
+    mat.matrix = data;
+    mat.row = side;
+    mat.col = side;
+    mat.ld = side;
+    return mat;
+}
+
+/**
+ * Parallel recursive step
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param depth      Number of levels still run in parallel
+ * @param ws         Arena of parallelWorkspaceElems(A->row, A->col, B->col, cutoff, depth) ints
+ */
+static void parallelRecursive(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                              int cutoff, int depth, int* ws) {
+    if (depth <= 0 || A->row <= cutoff || A->row != A->col || A->col != B->col) {
+        strassenMul_hybrid_ws(A, B, C, cutoff, ws);
+        return;
+    }
+
+    /* Odd side: run the even leading block in parallel, then peel serially */
+    if (A->row % 2 != 0) {
+        int even = A->row - 1;
+        struct Matrix A11 = matrixView(A, 0, 0, even, even);
+        struct Matrix B11 = matrixView(B, 0, 0, even, even);
+        struct Matrix C11 = matrixView(C, 0, 0, even, even);
+        parallelRecursive(&A11, &B11, &C11, cutoff, depth, ws);
+        peelUpdate(A, B, C);
+        return;
+    }
+
+    int h = A->row / 2;
+    size_t quadrant = (size_t)h * h;
+    size_t childElems = parallelWorkspaceElems(h, h, h, cutoff, depth - 1);
+    int* childWs = ws + PARALLEL_LEVEL_BUFFERS * quadrant;
+
+    /* Operand buffers of the products that need an addition */
+    struct Matrix S1a = sliceMatrix(ws + 0 * quadrant, h), S1b = sliceMatrix(ws + 1 * quadrant, h);
+    struct Matrix S2a = sliceMatrix(ws + 2 * quadrant, h), S2b = sliceMatrix(ws + 3 * quadrant, h);
+    struct Matrix S3a = sliceMatrix(ws + 4 * quadrant, h), S3b = sliceMatrix(ws + 5 * quadrant, h);
+    struct Matrix S4a = sliceMatrix(ws + 6 * quadrant, h);
+    struct Matrix S5b = sliceMatrix(ws + 7 * quadrant, h);
+    struct Matrix S6b = sliceMatrix(ws + 8 * quadrant, h);
+    struct Matrix S7a = sliceMatrix(ws + 9 * quadrant, h);
+
+    /* Results that are not written straight into C */
+    struct Matrix P2 = sliceMatrix(ws + 10 * quadrant, h);
+    struct Matrix P3 = sliceMatrix(ws + 11 * quadrant, h);
+    struct Matrix P5 = sliceMatrix(ws + 12 * quadrant, h);
+    struct Matrix P7 = sliceMatrix(ws + 13 * quadrant, h);
+
+    /* Form every operand before any product starts */
+    subMatrix(A, 0, h, A, h, h, &S1a, 0, 0, h);   /* A12 - A22 */
+    sumMatrix(B, h, 0, B, h, h, &S1b, 0, 0, h);   /* B21 + B22 */
+    sumMatrix(A, 0, 0, A, h, h, &S2a, 0, 0, h);   /* A11 + A22 */
+    sumMatrix(B, 0, 0, B, h, h, &S2b, 0, 0, h);   /* B11 + B22 */
+    subMatrix(A, 0, 0, A, h, 0, &S3a, 0, 0, h);   /* A11 - A21 */
+    sumMatrix(B, 0, 0, B, 0, h, &S3b, 0, 0, h);   /* B11 + B12 */
+    sumMatrix(A, 0, 0, A, 0, h, &S4a, 0, 0, h);   /* A11 + A12 */
+    subMatrix(B, 0, h, B, h, h, &S5b, 0, 0, h);   /* B12 - B22 */
+    subMatrix(B, h, 0, B, 0, 0, &S6b, 0, 0, h);   /* B21 - B11 */
+    sumMatrix(A, h, 0, A, h, h, &S7a, 0, 0, h);   /* A21 + A22 */
+
+    struct Matrix A11 = matrixView(A, 0, 0, h, h);
+    struct Matrix A22 = matrixView(A, h, h, h, h);
+    struct Matrix B11 = matrixView(B, 0, 0, h, h);
+    struct Matrix B22 = matrixView(B, h, h, h, h);
+    struct Matrix C11 = matrixView(C, 0, 0, h, h);
+    struct Matrix C12 = matrixView(C, 0, h, h, h);
+    struct Matrix C21 = matrixView(C, h, 0, h, h);
+
+    struct TaskGroup group = { 0 };
+    struct ProductTask tasks[7] = {
+        { { runProduct, NULL, NULL }, S1a, S1b, C11, cutoff, depth - 1, NULL },   /* P1 -> C11 */
+        { { runProduct, NULL, NULL }, S2a, S2b, P2,  cutoff, depth - 1, NULL },   /* P2 */
+        { { runProduct, NULL, NULL }, S3a, S3b, P3,  cutoff, depth - 1, NULL },   /* P3 */
+        { { runProduct, NULL, NULL }, S4a, B22, C12, cutoff, depth - 1, NULL },   /* P4 -> C12 */
+        { { runProduct, NULL, NULL }, A11, S5b, P5,  cutoff, depth - 1, NULL },   /* P5 */
+        { { runProduct, NULL, NULL }, A22, S6b, C21, cutoff, depth - 1, NULL },   /* P6 -> C21 */
+        { { runProduct, NULL, NULL }, S7a, B11, P7,  cutoff, depth - 1, NULL },   /* P7 */
+    };
+
+    /* Help-first: queue all seven products, then work until they are done */
+    for (int i = 0; i < 7; i++) {
+        tasks[i].task.arg = &tasks[i];
+        tasks[i].ws = childWs + i * childElems;
+        taskSpawn(&group, &tasks[i].task);
+    }
+    taskSync(&group);
+
+    /* Accumulate into C in the order of the serial engine */
+    addSubmatrix(&P2, C, 0, 0, h);            /* C11 += P2 */
+    copySubmatrix(&P2, 0, 0, C, h, h, h);     /* C22 = P2 */
+    subSubmatrix(&P3, C, h, h, h);            /* C22 -= P3 */
+    subSubmatrix(&C12, C, 0, 0, h);           /* C11 -= P4 */
+    addSubmatrix(&P5, C, 0, h, h);            /* C12 += P5 */
+    addSubmatrix(&P5, C, h, h, h);            /* C22 += P5 */
+    addSubmatrix(&C21, C, 0, 0, h);           /* C11 += P6 */
+    addSubmatrix(&P7, C, h, 0, h);            /* C21 += P7 */
+    subSubmatrix(&P7, C, h, h, h);            /* C22 -= P7 */
+}
+
+/**
+ * Returns the workspace needed by strassenMul_parallel_ws, in bytes
+ * @param side       Side length of the input matrices
+ * @param cutoff     Hybrid cutoff
+ * @param depth      Number of levels run in parallel
+ * @return           Size of the arena in bytes
+ */
+size_t strassenParallelWorkspaceSize(int side, int cutoff, int depth) {
+    if (cutoff < 1) cutoff = 1;
+    return parallelWorkspaceElems(side, side, side, cutoff, depth) * sizeof(int);
+}
+
+/**
+ * Task-parallel hybrid Strassen on an existing runtime and a caller-supplied arena
+ * @param rt         Work-stealing runtime
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param depth      Number of recursion levels whose products are spawned as tasks
+ * @param workspace  Arena of at least strassenParallelWorkspaceSize(A->row, cutoff, depth) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* strassenMul_runtime_ws(struct TaskRuntime* rt, struct Matrix* A, struct Matrix* B,
+                                      struct Matrix* C, int cutoff, int depth, void* workspace) {
+    struct ParallelRun run = { A, B, C, cutoff < 1 ? 1 : cutoff, depth, workspace };
+    runtimeRun(rt, runParallel, &run);
+    return C;
+}
+
+/**
+ * Task-parallel hybrid Strassen on an existing runtime
+ * @param rt         Work-stealing runtime
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param depth      Number of recursion levels whose products are spawned as tasks
+ * @return           Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* strassenMul_runtime(struct TaskRuntime* rt, struct Matrix* A, struct Matrix* B,
+                                   struct Matrix* C, int cutoff, int depth) {
+    if (cutoff < 1) cutoff = 1;
+    void* workspace = malloc(parallelWorkspaceElems(A->row, A->col, B->col, cutoff, depth) * sizeof(int) + 1);
+    if (workspace == NULL) return NULL;
+
+    strassenMul_runtime_ws(rt, A, B, C, cutoff, depth, workspace);
+
+    free(workspace);
+    return C;
+}
+
+/**
+ * Task-parallel hybrid Strassen on a caller-supplied arena
+ * Starts a runtime of `threads` workers for the call
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param threads    Number of worker threads
+ * @param depth      Number of recursion levels whose products run in parallel
+ * @param workspace  Arena of at least strassenParallelWorkspaceSize(A->row, cutoff, depth) bytes
+ * @return           Pointer to the result matrix C, NULL if the threads cannot be started
+ */
+struct Matrix* strassenMul_parallel_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                       int cutoff, int threads, int depth, void* workspace) {
+    struct TaskRuntime* rt = runtimeCreate(threads);
+    if (rt == NULL) return NULL;
+
+    strassenMul_runtime_ws(rt, A, B, C, cutoff, depth, workspace);
+
+    runtimeDestroy(rt);
+    return C;
+}
+
+/**
+ * Task-parallel hybrid Strassen
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param threads    Number of worker threads
+ * @param depth      Number of recursion levels whose products run in parallel
+ * @return           Pointer to the result matrix C, NULL on allocation failure
+ */
+struct Matrix* strassenMul_parallel(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                    int cutoff, int threads, int depth) {
+    if (cutoff < 1) cutoff = 1;
+    void* workspace = malloc(parallelWorkspaceElems(A->row, A->col, B->col, cutoff, depth) * sizeof(int) + 1);
+    if (workspace == NULL) return NULL;
+
+    struct Matrix* result = strassenMul_parallel_ws(A, B, C, cutoff, threads, depth, workspace);
+
+    free(workspace);
+    return result;
+}
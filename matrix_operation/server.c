@@ -0,0 +1,584 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "server.h"
+#include "workstealing.h"
+
+/******************************************
+ * Multiplication daemon
+ *
+ * The server is a single poll loop over the listening socket and up to
+ * SERVER_MAX_CLIENTS connections. A request is handled as soon as it is
+ * read. The memfd that comes with a request must be sealed against
+ * shrinking, so that the server never touches truncated pages. It is
+ * looked up by device and inode among the cached mappings, and the new
+ * descriptor is closed right away because the mapping keeps the file
+ * alive. When the cache is full, the least recently used mapping is
+ * dropped.
+ *******************************************/
+
+/**
+ * A memfd mapped by the server
+ */
+struct ServerMapping {
+    dev_t dev;
+    ino_t ino;
+    void* base;                 /* NULL for a free slot */
+    size_t length;
+    unsigned long lastUse;
+};
+
+/**
+ * Everything the server keeps between jobs
+ */
+struct ServerState {
+    struct TaskRuntime* rt;     /* NULL for serial products */
+    int depth;
+    void* arena;                /* Warm workspace arena */
+    size_t arenaBytes;
+    struct ServerMapping mappings[SERVER_MAX_MAPPINGS];
+    unsigned long clock;        /* Use counter for the LRU mapping cache */
+    double latency[SERVER_LATENCY_WINDOW];  /* Service times, ring buffer */
+    struct ServerStats stats;   /* Counters; percentiles are filled on demand */
+};
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Sends one message, with a descriptor attached when fd >= 0
+ * @param sock   Connected socket
+ * @param data   Message
+ * @param bytes  Size of the message
+ * @param fd     Descriptor to pass with SCM_RIGHTS, -1 for none
+ * @return       0 on success, -1 on failure
+ */
+static int sendMessage(int sock, const void* data, size_t bytes, int fd) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { (void*)data, bytes };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    if (fd >= 0) {
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    return sendmsg(sock, &msg, MSG_NOSIGNAL) == (ssize_t)bytes ? 0 : -1;
+}
+
+/**
+ * Receives one message and the descriptor attached to it
+ * @param sock   Connected socket
+ * @param data   Buffer of the message
+ * @param bytes  Expected size of the message
+ * @param fd     Receives the descriptor, -1 if none came
+ * @return       Size received, 0 at end of connection, -1 on failure
+ */
+static ssize_t receiveMessage(int sock, void* data, size_t bytes, int* fd) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { data, bytes };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    *fd = -1;
+    ssize_t received = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (received < 0) return -1;
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    }
+    /* A truncated message (or its descriptor) cannot be trusted */
+    if (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+        return -1;
+    }
+    return received;
+}
+
+/**
+ * Maps a memfd, or finds its mapping in the cache
+ * @param state  Server state
+ * @param fd     Descriptor received with the request (closed by the caller)
+ * @param reused Set to 1 if the mapping came from the cache
+ * @return       Cached mapping, NULL if the file cannot be mapped
+ */
+static struct ServerMapping* serverMapping(struct ServerState* state, int fd, int* reused) {
+    struct stat st;
+    /* Without F_SEAL_SHRINK the client could truncate the file under the server (SIGBUS) */
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK) || fstat(fd, &st) != 0 || st.st_size <= 0) return NULL;
+
+    for (int i = 0; i < SERVER_MAX_MAPPINGS; i++) {
+        struct ServerMapping* mapping = &state->mappings[i];
+        if (mapping->base == NULL || mapping->dev != st.st_dev || mapping->ino != st.st_ino) continue;
+        if (mapping->length == (size_t)st.st_size) {
+            mapping->lastUse = ++state->clock;
+            *reused = 1;
+            return mapping;
+        }
+        /* The client grew the file: map it again */
+        munmap(mapping->base, mapping->length);
+        mapping->base = NULL;
+    }
+
+    /* Free slot first, then the least recently used one */
+    struct ServerMapping* slot = &state->mappings[0];
+    for (int i = 1; i < SERVER_MAX_MAPPINGS && slot->base != NULL; i++) {
+        struct ServerMapping* mapping = &state->mappings[i];
+        if (mapping->base == NULL || mapping->lastUse < slot->lastUse) slot = mapping;
+    }
+
+    if (slot->base != NULL) munmap(slot->base, slot->length);
+    slot->base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (slot->base == MAP_FAILED) {
+        slot->base = NULL;
+        return NULL;
+    }
+    slot->dev = st.st_dev;
+    slot->ino = st.st_ino;
+    slot->length = (size_t)st.st_size;
+    slot->lastUse = ++state->clock;
+    *reused = 0;
+    return slot;
+}
+
+/**
+ * Builds the view of one operand inside a mapping
+ * @param mapping    Mapping of the memfd
+ * @param offset     Byte offset of the matrix
+ * @param rows       Number of rows
+ * @param cols       Number of columns
+ * @param out        Receives the view (ld = cols)
+ * @return           0 if the matrix lies inside the mapping, -1 otherwise
+ */
+static int serverOperand(struct ServerMapping* mapping, uint64_t offset, int rows, int cols, struct Matrix* out) {
+    uint64_t bytes = (uint64_t)rows * cols * sizeof(int);
+    if (rows < 0 || cols < 0 || offset % sizeof(int) != 0 || offset > mapping->length ||
+        bytes > mapping->length - offset) {
+        return -1;
+    }
+    out->matrix = (int*)((char*)mapping->base + offset);
+    out->row = rows;
+    out->col = cols;
+    out->ld = cols;
+    return 0;
+}
+
+/**
+ * Returns 1 if two byte ranges overlap
+ * @param a      Start of the first range
+ * @param aBytes Length of the first range
+ * @param b      Start of the second range
+ * @param bBytes Length of the second range
+ * @return       1 if they overlap, 0 otherwise
+ */
+static int rangesOverlap(uint64_t a, uint64_t aBytes, uint64_t b, uint64_t bBytes) {
+    return aBytes > 0 && bBytes > 0 && a < b + bBytes && b < a + aBytes;
+}
+
+/**
+ * Grows the warm arena; new pages are touched so no job pays their faults
+ * @param state  Server state
+ * @param bytes  Size needed
+ * @return       0 on success, -1 on failure
+ */
+static int serverArena(struct ServerState* state, size_t bytes) {
+    if (bytes <= state->arenaBytes && state->arena != NULL) return 0;
+    free(state->arena);
+    state->arena = malloc(bytes > 0 ? bytes : 1);
+    state->arenaBytes = state->arena != NULL ? bytes : 0;
+    if (state->arena == NULL) return -1;
+    memset(state->arena, 0, bytes);
+    return 0;
+}
+
+/**
+ * Runs one product on the operands of a memfd
+ * @param state  Server state
+ * @param req    Request
+ * @param fd     memfd of the request
+ * @param reply  Receives the status, the reuse flag and the compute time
+ */
+static void serverMultiplyJob(struct ServerState* state, const struct ServerRequest* req, int fd,
+                              struct ServerReply* reply) {
+    int reused = 0;
+    struct ServerMapping* mapping = serverMapping(state, fd, &reused);
+    struct Matrix A, B, C;
+    int m = req->m, k = req->k, n = req->n;
+
+    reply->status = -1;
+    if (mapping == NULL || serverOperand(mapping, req->offsetA, m, k, &A) != 0 ||
+        serverOperand(mapping, req->offsetB, k, n, &B) != 0 || serverOperand(mapping, req->offsetC, m, n, &C) != 0) {
+        return;
+    }
+    uint64_t bytesA = (uint64_t)m * k * sizeof(int), bytesB = (uint64_t)k * n * sizeof(int);
+    uint64_t bytesC = (uint64_t)m * n * sizeof(int);
+    if (rangesOverlap(req->offsetC, bytesC, req->offsetA, bytesA) ||
+        rangesOverlap(req->offsetC, bytesC, req->offsetB, bytesB)) {
+        return;
+    }
+
+    int cutoff = req->cutoff;
+    if (cutoff == CUTOFF_AUTO) {
+        int largest = m > k ? (m > n ? m : n) : (k > n ? k : n);
+        cutoff = profileCutoff(largest);
+    }
+    if (cutoff < 1) cutoff = 1;
+    setHybridLeaf(req->leaf == LEAF_BLOCKED ? LEAF_BLOCKED : LEAF_NAIVE);
+
+    /* Square products use the runtime, the others run serially (as strassenMul_hybrid) */
+    int parallel = state->rt != NULL && m == k && k == n;
+    size_t bytes = parallel ? strassenParallelWorkspaceSize(m, cutoff, state->depth)
+                            : strassenWorkspaceSizeRect(m, k, n, cutoff);
+    if (serverArena(state, bytes) != 0) return;
+
+    double start = nowSeconds();
+    if (parallel) {
+        strassenMul_runtime_ws(state->rt, &A, &B, &C, cutoff, state->depth, state->arena);
+    } else {
+        strassenMul_hybrid_ws(&A, &B, &C, cutoff, state->arena);
+    }
+    reply->computeSeconds = nowSeconds() - start;
+    reply->mappingReused = reused;
+    reply->status = 0;
+
+    if (reused) {
+        state->stats.mappingHits++;
+    } else {
+        state->stats.mappingMisses++;
+    }
+}
+
+/**
+ * Compares two doubles for qsort
+ * @param a      First value
+ * @param b      Second value
+ * @return       -1, 0 or 1
+ */
+static int compareSeconds(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Fills the percentiles of the service times in the window
+ * @param state  Server state
+ * @param stats  Receives the counters and the percentiles
+ */
+static void serverFillStats(struct ServerState* state, struct ServerStats* stats) {
+    static double sorted[SERVER_LATENCY_WINDOW];
+    size_t count = state->stats.jobs < SERVER_LATENCY_WINDOW ? state->stats.jobs : SERVER_LATENCY_WINDOW;
+
+    *stats = state->stats;
+    stats->workspaceBytes = state->arenaBytes;
+    if (count == 0) return;
+
+    double sum = 0.0;
+    memcpy(sorted, state->latency, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compareSeconds);
+    for (size_t i = 0; i < count; i++) {
+        sum += sorted[i];
+    }
+    /* Nearest-rank percentiles */
+    stats->meanSeconds = sum / count;
+    stats->p50Seconds = sorted[(count * 50 + 99) / 100 - 1];
+    stats->p90Seconds = sorted[(count * 90 + 99) / 100 - 1];
+    stats->p99Seconds = sorted[(count * 99 + 99) / 100 - 1];
+    stats->maxSeconds = sorted[count - 1];
+}
+
+/**
+ * Reads and serves one request of a client
+ * @param state  Server state
+ * @param sock   Client socket
+ * @return       1 to keep the client, 0 to close it, -1 to shut the server down
+ */
+static int serverHandle(struct ServerState* state, int sock) {
+    struct ServerRequest req;
+    struct ServerReply reply;
+    int fd;
+
+    ssize_t received = receiveMessage(sock, &req, sizeof(req), &fd);
+    if (received <= 0) return 0;
+    double start = nowSeconds();
+    memset(&reply, 0, sizeof(reply));
+    reply.status = -1;
+
+    if (received != (ssize_t)sizeof(req)) {
+        if (fd >= 0) close(fd);
+        return sendMessage(sock, &reply, sizeof(reply), -1) == 0;
+    }
+
+    switch (req.op) {
+    case SERVER_OP_MUL:
+        if (fd >= 0) {
+            serverMultiplyJob(state, &req, fd, &reply);
+        }
+        break;
+    case SERVER_OP_STATS: {
+        struct ServerStats stats;
+        if (fd >= 0) close(fd);
+        serverFillStats(state, &stats);
+        return sendMessage(sock, &stats, sizeof(stats), -1) == 0;
+    }
+    case SERVER_OP_RESET_STATS:
+        memset(&state->stats, 0, sizeof(state->stats));
+        reply.status = 0;
+        break;
+    case SERVER_OP_SHUTDOWN:
+        reply.status = 0;
+        break;
+    default:
+        break;
+    }
+    if (fd >= 0) close(fd);
+
+    reply.serviceSeconds = nowSeconds() - start;
+    if (req.op == SERVER_OP_MUL && reply.status == 0) {
+        state->latency[state->stats.jobs % SERVER_LATENCY_WINDOW] = reply.serviceSeconds;
+        state->stats.jobs++;
+    }
+    if (sendMessage(sock, &reply, sizeof(reply), -1) != 0) return 0;
+    return req.op == SERVER_OP_SHUTDOWN && reply.status == 0 ? -1 : 1;
+}
+
+/**
+ * Runs the server until a SERVER_OP_SHUTDOWN request
+ * @param path       Path of the socket
+ * @param threads    Worker threads of the runtime, 1 for serial products
+ * @param depth      Recursion levels spawned as tasks when threads > 1
+ * @return           0 after a shutdown request, -1 on setup failure
+ */
+int serverRun(const char* path, int threads, int depth) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listener < 0) return -1;
+    unlink(path);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, SERVER_MAX_CLIENTS) != 0) {
+        close(listener);
+        return -1;
+    }
+
+    struct ServerState* state = calloc(1, sizeof(*state));
+    if (state == NULL) {
+        close(listener);
+        unlink(path);
+        return -1;
+    }
+    state->depth = depth;
+    if (threads > 1) {
+        state->rt = runtimeCreate(threads);
+        if (state->rt == NULL) {
+            free(state);
+            close(listener);
+            unlink(path);
+            return -1;
+        }
+    }
+
+    struct pollfd fds[1 + SERVER_MAX_CLIENTS];
+    int count = 1;
+    fds[0].fd = listener;
+    fds[0].events = POLLIN;
+
+    int running = 1;
+    while (running) {
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 1; i < count && running; i++) {
+            if (fds[i].revents == 0) continue;
+            int keep = fds[i].revents & POLLIN ? serverHandle(state, fds[i].fd) : 0;
+            if (keep < 0) running = 0;
+            if (keep <= 0) {
+                close(fds[i].fd);
+                fds[i--] = fds[--count];
+            }
+        }
+        if (running && (fds[0].revents & POLLIN)) {
+            int client = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+            if (client >= 0 && count < 1 + SERVER_MAX_CLIENTS) {
+                fds[count].fd = client;
+                fds[count].events = POLLIN;
+                fds[count].revents = 0;
+                count++;
+            } else if (client >= 0) {
+                close(client);
+            }
+        }
+    }
+
+    for (int i = 1; i < count; i++) {
+        close(fds[i].fd);
+    }
+    close(listener);
+    unlink(path);
+    for (int i = 0; i < SERVER_MAX_MAPPINGS; i++) {
+        if (state->mappings[i].base != NULL) munmap(state->mappings[i].base, state->mappings[i].length);
+    }
+    if (state->rt != NULL) runtimeDestroy(state->rt);
+    free(state->arena);
+    free(state);
+    return running ? -1 : 0;
+}
+
+/******************************************
+ * Client side
+ *******************************************/
+
+/**
+ * Connects to a server
+ * @param path   Path of the socket
+ * @return       Connected socket, -1 on failure
+ */
+int serverConnect(const char* path) {
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0) return -1;
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/**
+ * Creates a memfd holding an m x k, a k x n and an m x n matrix
+ * @param ops    Receives the memfd, its mapping and the views
+ * @param m      Rows of A and C
+ * @param k      Columns of A / rows of B
+ * @param n      Columns of B and C
+ * @return       0 on success, -1 on failure
+ */
+int sharedOperandsCreate(struct SharedOperands* ops, int m, int k, int n) {
+    if (m < 0 || k < 0 || n < 0) return -1;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t bytesA = ((size_t)m * k * sizeof(int) + page - 1) / page * page;
+    size_t bytesB = ((size_t)k * n * sizeof(int) + page - 1) / page * page;
+    size_t bytesC = ((size_t)m * n * sizeof(int) + page - 1) / page * page;
+    size_t length = bytesA + bytesB + bytesC > 0 ? bytesA + bytesB + bytesC : page;
+
+    ops->fd = memfd_create("strassen-operands", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (ops->fd < 0) return -1;
+    if (ftruncate(ops->fd, (off_t)length) != 0 || fcntl(ops->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+        close(ops->fd);
+        return -1;
+    }
+    ops->base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, ops->fd, 0);
+    if (ops->base == MAP_FAILED) {
+        close(ops->fd);
+        return -1;
+    }
+    ops->length = length;
+
+    char* base = ops->base;
+    ops->A = (struct Matrix){ (int*)base, m, k, k };
+    ops->B = (struct Matrix){ (int*)(base + bytesA), k, n, n };
+    ops->C = (struct Matrix){ (int*)(base + bytesA + bytesB), m, n, n };
+    return 0;
+}
+
+/**
+ * Unmaps and closes the memfd of shared operands
+ * @param ops    Operands created by sharedOperandsCreate
+ */
+void sharedOperandsFree(struct SharedOperands* ops) {
+    munmap(ops->base, ops->length);
+    close(ops->fd);
+    ops->base = NULL;
+    ops->fd = -1;
+}
+
+/**
+ * Asks the server for C = A * B on shared operands and waits for the reply
+ * @param sock   Socket returned by serverConnect
+ * @param ops    Shared operands
+ * @param cutoff Cutoff of the hybrid engine, or CUTOFF_AUTO
+ * @param leaf   Leaf kernel of the hybrid engine
+ * @param reply  Receives the reply
+ * @return       0 on success, -1 on failure
+ */
+int serverMultiply(int sock, struct SharedOperands* ops, int cutoff, enum LeafKernel leaf,
+                   struct ServerReply* reply) {
+    char* base = ops->base;
+    struct ServerRequest req = {
+        SERVER_OP_MUL, ops->A.row, ops->A.col, ops->B.col, cutoff, leaf,
+        (uint64_t)((char*)ops->A.matrix - base), (uint64_t)((char*)ops->B.matrix - base),
+        (uint64_t)((char*)ops->C.matrix - base)
+    };
+    if (sendMessage(sock, &req, sizeof(req), ops->fd) != 0) return -1;
+    if (recv(sock, reply, sizeof(*reply), 0) != (ssize_t)sizeof(*reply)) return -1;
+    return reply->status;
+}
+
+/**
+ * Queries the latency percentiles and counters of the server
+ * @param sock   Socket returned by serverConnect
+ * @param stats  Receives the statistics
+ * @return       0 on success, -1 on failure
+ */
+int serverQueryStats(int sock, struct ServerStats* stats) {
+    struct ServerRequest req;
+    memset(&req, 0, sizeof(req));
+    req.op = SERVER_OP_STATS;
+    if (sendMessage(sock, &req, sizeof(req), -1) != 0) return -1;
+    return recv(sock, stats, sizeof(*stats), 0) == (ssize_t)sizeof(*stats) ? 0 : -1;
+}
+
+/**
+ * Sends a request without operands
+ * @param sock   Socket returned by serverConnect
+ * @param op     SERVER_OP_RESET_STATS or SERVER_OP_SHUTDOWN
+ * @return       0 on success, -1 on failure
+ */
+int serverCommand(int sock, enum ServerOp op) {
+    struct ServerRequest req;
+    struct ServerReply reply;
+    memset(&req, 0, sizeof(req));
+    req.op = op;
+    if (sendMessage(sock, &req, sizeof(req), -1) != 0) return -1;
+    if (recv(sock, &reply, sizeof(reply), 0) != (ssize_t)sizeof(reply)) return -1;
+    return reply.status;
+}
@@ -0,0 +1,165 @@
+#ifndef server_H_
+#define server_H_
+
+#include <stdint.h>
+#include "matrix.h"
+
+/*********************************************
+ * Multiplication daemon
+ *
+ * A resident process serves products over a Unix domain socket
+ * (SOCK_SEQPACKET, one message per request or reply). The operands
+ * travel as a memfd passed with SCM_RIGHTS: the client lays out A, B
+ * and C in one shared-memory file sealed with F_SEAL_SHRINK. The server
+ * maps it and writes C in place, so no element crosses the socket.
+ * Between jobs the server keeps:
+ *   - the work-stealing runtime, when started with more than one thread;
+ *   - the workspace arena, grown and pre-faulted on demand;
+ *   - the mappings of the last SERVER_MAX_MAPPINGS memfds. A client
+ *     that reuses its buffers skips mmap and the page faults of a
+ *     fresh mapping.
+ * Jobs run one at a time, in arrival order over all clients. The server
+ * records the service time of each job (request received to reply
+ * sent) and reports percentiles over the last SERVER_LATENCY_WINDOW jobs.
+ *
+ * All messages are fixed-size structs of fixed-width fields, so clients
+ * in other languages can pack them (see Server/strassen_client.py).
+ *********************************************/
+
+#define SERVER_MAX_CLIENTS 64
+#define SERVER_MAX_MAPPINGS 16
+#define SERVER_LATENCY_WINDOW 4096
+
+/**
+ * Requests understood by the server
+ */
+enum ServerOp {
+    SERVER_OP_MUL = 1,          /* Multiply the operands of the attached memfd */
+    SERVER_OP_STATS = 2,        /* Reply with a struct ServerStats */
+    SERVER_OP_RESET_STATS = 3,  /* Clear the latency samples and counters */
+    SERVER_OP_SHUTDOWN = 4      /* Stop the server after replying */
+};
+
+/**
+ * Request message, 48 bytes
+ * Offsets are in bytes from the start of the memfd, rows are packed (ld = cols)
+ */
+struct ServerRequest {
+    uint32_t op;                /* enum ServerOp */
+    int32_t m;                  /* Rows of A and C */
+    int32_t k;                  /* Columns of A / rows of B */
+    int32_t n;                  /* Columns of B and C */
+    int32_t cutoff;             /* Cutoff of the hybrid engine, or CUTOFF_AUTO */
+    int32_t leaf;               /* enum LeafKernel */
+    uint64_t offsetA;
+    uint64_t offsetB;
+    uint64_t offsetC;
+};
+
+/**
+ * Reply to SERVER_OP_MUL, SERVER_OP_RESET_STATS and SERVER_OP_SHUTDOWN, 24 bytes
+ */
+struct ServerReply {
+    int32_t status;             /* 0 on success, -1 for an invalid request or memfd */
+    int32_t mappingReused;      /* 1 if the memfd was already mapped */
+    double computeSeconds;      /* Time in the engine */
+    double serviceSeconds;      /* Request received to reply sent, minus the send */
+};
+
+/**
+ * Reply to SERVER_OP_STATS, 72 bytes
+ */
+struct ServerStats {
+    uint64_t jobs;              /* Products served since the last reset */
+    uint64_t mappingHits;       /* Jobs that reused a mapping */
+    uint64_t mappingMisses;     /* Jobs that mapped their memfd */
+    uint64_t workspaceBytes;    /* Size of the warm workspace arena */
+    double meanSeconds;         /* Service time over the window */
+    double p50Seconds;
+    double p90Seconds;
+    double p99Seconds;
+    double maxSeconds;
+};
+
+/**
+ * Operands of a product in a memfd shared with the server
+ */
+struct SharedOperands {
+    int fd;                     /* memfd, sent with every request */
+    void* base;                 /* Mapping of the whole file in the client */
+    size_t length;
+    struct Matrix A;            /* Views into the mapping, page-aligned */
+    struct Matrix B;
+    struct Matrix C;
+};
+
+/**
+ * Runs the server until a SERVER_OP_SHUTDOWN request
+ * An existing socket file at path is replaced
+ *
+ * @param path       Path of the socket
+ * @param threads    Worker threads of the runtime, 1 for serial products
+ * @param depth      Recursion levels spawned as tasks when threads > 1
+ * @return           0 after a shutdown request, -1 if the socket or the runtime cannot be set up
+ */
+int serverRun(const char* path, int threads, int depth);
+
+/**
+ * Connects to a server
+ *
+ * @param path   Path of the socket
+ * @return       Connected socket, -1 on failure
+ */
+int serverConnect(const char* path);
+
+/**
+ * Creates a memfd holding an m x k, a k x n and an m x n matrix
+ *
+ * @param ops    Receives the memfd, its mapping and the views
+ * @param m      Rows of A and C
+ * @param k      Columns of A / rows of B
+ * @param n      Columns of B and C
+ * @return       0 on success, -1 on failure
+ */
+int sharedOperandsCreate(struct SharedOperands* ops, int m, int k, int n);
+
+/**
+ * Unmaps and closes the memfd of shared operands
+ *
+ * @param ops    Operands created by sharedOperandsCreate
+ */
+void sharedOperandsFree(struct SharedOperands* ops);
+
+/**
+ * Asks the server for C = A * B on shared operands and waits for the reply
+ * C is written by the server directly in the shared mapping
+ *
+ * @param sock   Socket returned by serverConnect
+ * @param ops    Shared operands
+ * @param cutoff Cutoff of the hybrid engine, or CUTOFF_AUTO
+ * @param leaf   Leaf kernel of the hybrid engine
+ * @param reply  Receives the reply
+ * @return       0 on success, -1 if the server failed the job or the socket failed
+ */
+int serverMultiply(int sock, struct SharedOperands* ops, int cutoff, enum LeafKernel leaf,
+                   struct ServerReply* reply);
+
+/**
+ * Queries the latency percentiles and counters of the server
+ *
+ * @param sock   Socket returned by serverConnect
+ * @param stats  Receives the statistics
+ * @return       0 on success, -1 on failure
+ */
+int serverQueryStats(int sock, struct ServerStats* stats);
+
+/**
+ * Sends a request without operands (SERVER_OP_RESET_STATS or SERVER_OP_SHUTDOWN)
+ *
+ * @param sock   Socket returned by serverConnect
+ * @param op     Request
+ * @return       0 on success, -1 on failure
+ */
+int serverCommand(int sock, enum ServerOp op);
+
+#endif /* server_H_ */
@@ -0,0 +1,328 @@
+#include <stdlib.h>
+#include <string.h>
+#include "matrix.h"
+#include "simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+/******************************************
+ * Element-wise row kernels with runtime CPU dispatch
+ *
+ * Each kernel exists in a scalar version and, on x86, in SSE2, AVX2 and
+ * AVX-512 versions compiled with the matching target attribute. The
+ * widest set supported by the CPU (queried through cpuid) is installed
+ * in rowKernels once, before main() runs. Setting the environment
+ * variable MATRIX_SIMD to scalar, sse2, avx2 or avx512 caps the choice,
+ * which is how the benchmarks compare the implementations.
+ *
+ * Additions wrap modulo 2^32 in every version (the scalar code goes
+ * through unsigned arithmetic), so all of them give identical results.
+ *******************************************/
+
+/******************************************
+ * Scalar kernels
+ *******************************************/
+
+static void addScalar(int* dst, const int* a, const int* b, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (int)((unsigned)a[i] + (unsigned)b[i]);
+    }
+}
+
+static void subScalar(int* dst, const int* a, const int* b, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (int)((unsigned)a[i] - (unsigned)b[i]);
+    }
+}
+
+static void addInPlaceScalar(int* dst, const int* src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (int)((unsigned)dst[i] + (unsigned)src[i]);
+    }
+}
+
+static void subInPlaceScalar(int* dst, const int* src, int n) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = (int)((unsigned)dst[i] - (unsigned)src[i]);
+    }
+}
+
+static void copyScalar(int* dst, const int* src, int n) {
+    memcpy(dst, src, sizeof(int) * n);
+}
+
+static void zeroScalar(int* dst, int n) {
+    memset(dst, 0, sizeof(int) * n);
+}
+
+#ifdef SIMD_X86
+
+/******************************************
+ * SSE2 kernels (4 ints per vector)
+ *******************************************/
+
+__attribute__((target("sse2")))
+static void addSSE2(int* dst, const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(va, vb));
+    }
+    addScalar(dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void subSSE2(int* dst, const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_sub_epi32(va, vb));
+    }
+    subScalar(dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void addInPlaceSSE2(int* dst, const int* src, int n) {
+    addSSE2(dst, dst, src, n);
+}
+
+__attribute__((target("sse2")))
+static void subInPlaceSSE2(int* dst, const int* src, int n) {
+    subSSE2(dst, dst, src, n);
+}
+
+__attribute__((target("sse2")))
+static void copySSE2(int* dst, const int* src, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    }
+    copyScalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void zeroSSE2(int* dst, int n) {
+    __m128i z = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), z);
+    }
+    zeroScalar(dst + i, n - i);
+}
+
+/******************************************
+ * AVX2 kernels (8 ints per vector)
+ *******************************************/
+
+__attribute__((target("avx2")))
+static void addAVX2(int* dst, const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(va, vb));
+    }
+    addSSE2(dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void subAVX2(int* dst, const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_sub_epi32(va, vb));
+    }
+    subSSE2(dst + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void addInPlaceAVX2(int* dst, const int* src, int n) {
+    addAVX2(dst, dst, src, n);
+}
+
+__attribute__((target("avx2")))
+static void subInPlaceAVX2(int* dst, const int* src, int n) {
+    subAVX2(dst, dst, src, n);
+}
+
+__attribute__((target("avx2")))
+static void copyAVX2(int* dst, const int* src, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_loadu_si256((const __m256i*)(src + i)));
+    }
+    copySSE2(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void zeroAVX2(int* dst, int n) {
+    __m256i z = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst + i), z);
+    }
+    zeroSSE2(dst + i, n - i);
+}
+
+/******************************************
+ * AVX-512 kernels (16 ints per vector, masked tail)
+ *******************************************/
+
+__attribute__((target("avx512f")))
+static void addAVX512(int* dst, const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(dst + i, _mm512_add_epi32(va, vb));
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        __m512i va = _mm512_maskz_loadu_epi32(m, a + i);
+        __m512i vb = _mm512_maskz_loadu_epi32(m, b + i);
+        _mm512_mask_storeu_epi32(dst + i, m, _mm512_add_epi32(va, vb));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void subAVX512(int* dst, const int* a, const int* b, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        _mm512_storeu_si512(dst + i, _mm512_sub_epi32(va, vb));
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        __m512i va = _mm512_maskz_loadu_epi32(m, a + i);
+        __m512i vb = _mm512_maskz_loadu_epi32(m, b + i);
+        _mm512_mask_storeu_epi32(dst + i, m, _mm512_sub_epi32(va, vb));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void addInPlaceAVX512(int* dst, const int* src, int n) {
+    addAVX512(dst, dst, src, n);
+}
+
+__attribute__((target("avx512f")))
+static void subInPlaceAVX512(int* dst, const int* src, int n) {
+    subAVX512(dst, dst, src, n);
+}
+
+__attribute__((target("avx512f")))
+static void copyAVX512(int* dst, const int* src, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_si512(dst + i, _mm512_loadu_si512(src + i));
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi32(dst + i, m, _mm512_maskz_loadu_epi32(m, src + i));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void zeroAVX512(int* dst, int n) {
+    __m512i z = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_si512(dst + i, z);
+    }
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_epi32(dst + i, m, z);
+    }
+}
+
+#endif /* SIMD_X86 */
+
+/******************************************
+ * Dispatch
+ *******************************************/
+
+/* Kernel table for every level, indexed by enum SimdLevel */
+static const struct RowKernels kernelsByLevel[] = {
+    { addScalar, subScalar, addInPlaceScalar, subInPlaceScalar, copyScalar, zeroScalar },
+#ifdef SIMD_X86
+    { addSSE2, subSSE2, addInPlaceSSE2, subInPlaceSSE2, copySSE2, zeroSSE2 },
+    { addAVX2, subAVX2, addInPlaceAVX2, subInPlaceAVX2, copyAVX2, zeroAVX2 },
+    { addAVX512, subAVX512, addInPlaceAVX512, subInPlaceAVX512, copyAVX512, zeroAVX512 },
+#endif
+};
+
+struct RowKernels rowKernels = {
+    addScalar, subScalar, addInPlaceScalar, subInPlaceScalar, copyScalar, zeroScalar
+};
+
+static enum SimdLevel currentLevel = SIMD_SCALAR;
+
+/**
+ * Returns the widest instruction set supported by the running CPU
+ * @return      Best available SIMD level
+ */
+static enum SimdLevel detectSimdLevel(void) {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+/**
+ * Selects the row kernels for the requested instruction set
+ * @param level  Requested SIMD level
+ * @return       0 on success, -1 if the CPU does not support it
+ */
+int setSimdLevel(enum SimdLevel level) {
+    if (level < SIMD_SCALAR || level > detectSimdLevel()) return -1;
+    rowKernels = kernelsByLevel[level];
+    currentLevel = level;
+    return 0;
+}
+
+/**
+ * Returns the instruction set currently used by the row kernels
+ * @return       Current SIMD level
+ */
+enum SimdLevel getSimdLevel(void) {
+    return currentLevel;
+}
+
+/**
+ * Returns a printable name for a SIMD level
+ * @param level  SIMD level
+ * @return       "scalar", "sse2", "avx2" or "avx512"
+ */
+const char* simdLevelName(enum SimdLevel level) {
+    static const char* names[] = { "scalar", "sse2", "avx2", "avx512" };
+    if (level < SIMD_SCALAR || level > SIMD_AVX512) return "unknown";
+    return names[level];
+}
+
+/**
+ * Picks the kernels once at startup
+ * MATRIX_SIMD caps the level, e.g. MATRIX_SIMD=scalar forces the fallback
+ */
+__attribute__((constructor))
+static void initRowKernels(void) {
+    enum SimdLevel level = detectSimdLevel();
+    const char* forced = getenv("MATRIX_SIMD");
+
+    if (forced != NULL) {
+        for (int l = SIMD_SCALAR; l <= SIMD_AVX512; l++) {
+            if (strcmp(forced, simdLevelName(l)) == 0 && l < (int)level) {
+                level = l;
+            }
+        }
+    }
+    setSimdLevel(level);
+}
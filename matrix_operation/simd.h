@@ -0,0 +1,26 @@
+#ifndef simd_H_
+#define simd_H_
+
+/**
+ * Row kernels used by the element-wise matrix helpers
+ *
+ * Every helper in matrix.c walks its blocks row by row and hands each
+ * contiguous row to one of these kernels. The table is filled once at
+ * startup with the widest implementation the CPU supports (see simd.c);
+ * all implementations give bit-identical results.
+ *
+ * Internal header: only the library sources include it.
+ */
+struct RowKernels {
+    void (*add)(int* dst, const int* a, const int* b, int n);     /* dst = a + b */
+    void (*sub)(int* dst, const int* a, const int* b, int n);     /* dst = a - b */
+    void (*addInPlace)(int* dst, const int* src, int n);           /* dst += src  */
+    void (*subInPlace)(int* dst, const int* src, int n);           /* dst -= src  */
+    void (*copy)(int* dst, const int* src, int n);                 /* dst = src   */
+    void (*zero)(int* dst, int n);                                  /* dst = 0     */
+};
+
+/* Kernels selected for the running CPU */
+extern struct RowKernels rowKernels;
+
+#endif /* simd_H_ */
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "trace.h"
+
+/******************************************
+ * Phase tracer
+ *
+ * Each thread allocates its ring buffer on its first event and links it
+ * into a global list (the only locked operation). Buffers outlive their
+ * threads so that traceWrite can dump the events of finished workers;
+ * call it while no multiplication is running.
+ *******************************************/
+
+/**
+ * One complete event ("ph": "X")
+ */
+struct TraceEvent {
+    const char* name;
+    long start;         /* Nanoseconds, traceNow clock */
+    long duration;      /* Nanoseconds */
+    int a;
+    int b;
+};
+
+/**
+ * Ring buffer of one thread
+ */
+struct TraceRing {
+    struct TraceEvent* events;
+    long recorded;              /* Events recorded since the last reset */
+    int tid;                    /* Thread number in the trace */
+    struct TraceRing* next;
+};
+
+static __thread struct TraceRing* threadRing = NULL;
+static struct TraceRing* rings = NULL;
+static int ringCount = 0;
+static pthread_mutex_t ringsLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns a monotonic timestamp in nanoseconds
+ * @return      Current time
+ */
+long traceNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/**
+ * Returns the ring buffer of the calling thread, creating it on first use
+ * @return      Ring buffer, NULL if it cannot be allocated
+ */
+static struct TraceRing* getThreadRing(void) {
+    if (threadRing != NULL) return threadRing;
+
+    struct TraceRing* ring = malloc(sizeof(struct TraceRing));
+    if (ring == NULL) return NULL;
+    ring->events = malloc(sizeof(struct TraceEvent) * TRACE_RING_EVENTS);
+    if (ring->events == NULL) {
+        free(ring);
+        return NULL;
+    }
+    ring->recorded = 0;
+
+    pthread_mutex_lock(&ringsLock);
+    ring->tid = ringCount++;
+    ring->next = rings;
+    rings = ring;
+    pthread_mutex_unlock(&ringsLock);
+
+    threadRing = ring;
+    return ring;
+}
+
+/**
+ * Records a complete event in the ring buffer of the calling thread
+ * @param name   Event name
+ * @param start  Start timestamp
+ * @param a      First size argument
+ * @param b      Second size argument
+ */
+void traceRecord(const char* name, long start, int a, int b) {
+    long duration = traceNow() - start;
+    struct TraceRing* ring = getThreadRing();
+    if (ring == NULL) return;
+
+    struct TraceEvent* event = &ring->events[ring->recorded % TRACE_RING_EVENTS];
+    event->name = name;
+    event->start = start;
+    event->duration = duration;
+    event->a = a;
+    event->b = b;
+    ring->recorded++;
+}
+
+/**
+ * Discards the events recorded so far by every thread
+ */
+void traceReset(void) {
+    pthread_mutex_lock(&ringsLock);
+    for (struct TraceRing* ring = rings; ring != NULL; ring = ring->next) {
+        ring->recorded = 0;
+    }
+    pthread_mutex_unlock(&ringsLock);
+}
+
+/**
+ * Writes the recorded events as Chrome trace-event JSON
+ * Timestamps are in microseconds from the earliest event kept
+ *
+ * @param path   Output file
+ * @return       Number of events written, -1 on failure or without MATRIX_TRACE
+ */
+long traceWrite(const char* path) {
+#ifndef MATRIX_TRACE
+    (void)path;
+    return -1;
+#else
+    long written = 0;
+    long origin = 0;
+    int first = 1;
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return -1;
+
+    pthread_mutex_lock(&ringsLock);
+
+    /* Earliest start among the events still in the buffers */
+    for (struct TraceRing* ring = rings; ring != NULL; ring = ring->next) {
+        long kept = ring->recorded < TRACE_RING_EVENTS ? ring->recorded : TRACE_RING_EVENTS;
+        for (long i = ring->recorded - kept; i < ring->recorded; i++) {
+            long start = ring->events[i % TRACE_RING_EVENTS].start;
+            if (first || start < origin) origin = start;
+            first = 0;
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    for (struct TraceRing* ring = rings; ring != NULL; ring = ring->next) {
+        long kept = ring->recorded < TRACE_RING_EVENTS ? ring->recorded : TRACE_RING_EVENTS;
+        for (long i = ring->recorded - kept; i < ring->recorded; i++) {
+            const struct TraceEvent* event = &ring->events[i % TRACE_RING_EVENTS];
+            fprintf(file, "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                    "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"a\": %d, \"b\": %d}}",
+                    written > 0 ? "," : "", event->name, ring->tid,
+                    (event->start - origin) / 1000.0, event->duration / 1000.0, event->a, event->b);
+            written++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    pthread_mutex_unlock(&ringsLock);
+
+    if (fclose(file) != 0) return -1;
+    return written;
+#endif
+}
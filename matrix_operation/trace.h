@@ -0,0 +1,61 @@
+#ifndef trace_H_
+#define trace_H_
+
+/*********************************************
+ * Phase tracer (Chrome trace-event output)
+ *
+ * Built with -DMATRIX_TRACE, the library records one complete event
+ * (name, start, duration, two size arguments) for every Strassen level,
+ * every product P1..P7, every block helper call and every leaf kernel
+ * call. Events go to a ring buffer owned by the recording thread, so
+ * recording takes no lock; when a buffer is full the oldest events are
+ * overwritten. traceWrite dumps every buffer as a JSON file that
+ * chrome://tracing or https://ui.perfetto.dev opens directly.
+ *
+ * Without -DMATRIX_TRACE the TRACE_* macros expand to nothing, so the
+ * engines contain no tracing code, and traceWrite returns -1.
+ *********************************************/
+
+#ifndef TRACE_RING_EVENTS
+#define TRACE_RING_EVENTS (1 << 20)    /* Events kept per thread (32 bytes each) */
+#endif
+
+/**
+ * Returns a monotonic timestamp in nanoseconds
+ *
+ * @return      Current time
+ */
+long traceNow(void);
+
+/**
+ * Records a complete event in the ring buffer of the calling thread
+ *
+ * @param name   Event name, a string literal (only the pointer is stored)
+ * @param start  Start timestamp returned by traceNow
+ * @param a      First size argument (rows, or the side of a level)
+ * @param b      Second size argument (columns)
+ */
+void traceRecord(const char* name, long start, int a, int b);
+
+/**
+ * Discards the events recorded so far by every thread
+ */
+void traceReset(void);
+
+/**
+ * Writes the recorded events as Chrome trace-event JSON
+ *
+ * @param path   Output file
+ * @return       Number of events written, -1 on failure or without MATRIX_TRACE
+ */
+long traceWrite(const char* path);
+
+#ifdef MATRIX_TRACE
+#define TRACE_BEGIN(start)                 long start = traceNow()
+#define TRACE_END(start, name, a, b)       traceRecord(name, start, a, b)
+#else
+#define TRACE_BEGIN(start)                 ((void)0)
+#define TRACE_END(start, name, a, b)       ((void)0)
+#endif
+
+#endif /* trace_H_ */
@@ -0,0 +1,242 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "matrix.h"
+
+/******************************************
+ * Cutoff tuning and per-machine profile
+ *
+ * findOptimalCutoff times strassenMul_hybrid_ws in-process for every
+ * candidate cutoff: the calling thread is pinned to the core it runs on,
+ * each cutoff gets TUNING_WARMUP untimed runs and TUNING_TRIALS timed
+ * ones, and the fastest trial is kept. tuneCutoffProfile repeats this
+ * over a list of sizes and writes one line per size band:
+ *
+ *   # <largest side of the band> <cutoff>
+ *   512 32
+ *   1024 64
+ *
+ * A band covers the sides above the previous band up to its own side;
+ * sides above the last band use its cutoff.
+ *******************************************/
+
+#ifndef TUNING_WARMUP
+#define TUNING_WARMUP 1    /* Untimed runs before the trials of a cutoff */
+#endif
+#ifndef TUNING_TRIALS
+#define TUNING_TRIALS 5    /* Timed runs per cutoff, the fastest is kept */
+#endif
+
+/* Largest number of bands in a profile */
+#define PROFILE_MAX_BANDS 32
+
+/* Profile used by strassenMul_hybrid with cutoff CUTOFF_AUTO */
+static int profileSides[PROFILE_MAX_BANDS];
+static int profileCutoffs[PROFILE_MAX_BANDS];
+static int profileBands = 0;
+static pthread_once_t profileOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Returns a monotonic timestamp in seconds
+ * @return      Current time
+ */
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Pins the calling thread to the core it is running on
+ * @param saved  Receives the previous affinity mask
+ * @return       0 if the thread was pinned, -1 otherwise
+ */
+static int pinToCurrentCore(cpu_set_t* saved) {
+    int cpu = sched_getcpu();
+    cpu_set_t only;
+
+    if (cpu < 0 || sched_getaffinity(0, sizeof(cpu_set_t), saved) != 0) return -1;
+    CPU_ZERO(&only);
+    CPU_SET(cpu, &only);
+    return sched_setaffinity(0, sizeof(cpu_set_t), &only) == 0 ? 0 : -1;
+}
+
+/**
+ * Tests performance with different cutoff values and returns the optimal cutoff
+ * The matrices are paddedSide x paddedSide with random values in their
+ * leading originalSide x originalSide block and zeros elsewhere
+ *
+ * @param minCutoff       Minimum cutoff value to test
+ * @param maxCutoff       Maximum cutoff value to test
+ * @param step            Step size between cutoff values
+ * @param originalSide    Original matrix size
+ * @param paddedSide      Allocated matrix size (originalSide when not padding)
+ * @return                The fastest cutoff, -1 on allocation failure,
+ *                        -2 if the range holds no cutoff >= 1
+ */
+int findOptimalCutoff(int minCutoff, int maxCutoff, int step, int originalSide, int paddedSide) {
+    int best = -1;
+    double bestTime = 0.0;
+    cpu_set_t saved;
+    int pinned;
+
+    if (step < 1) step = 1;
+    if (minCutoff < 1) minCutoff = 1;
+    if (minCutoff > maxCutoff) return -2;
+
+    struct Matrix A = allocMatrix(paddedSide);
+    struct Matrix B = allocMatrix(paddedSide);
+    struct Matrix C = allocMatrix(paddedSide);
+    if (A.matrix == NULL || B.matrix == NULL || C.matrix == NULL) {
+        freeMatrix(&A);
+        freeMatrix(&B);
+        freeMatrix(&C);
+        return -1;
+    }
+
+    initMatrixZeros(&A);
+    initMatrixZeros(&B);
+    struct Matrix a = matrixView(&A, 0, 0, originalSide, originalSide);
+    struct Matrix b = matrixView(&B, 0, 0, originalSide, originalSide);
+    fillMatrixRand(&a);
+    fillMatrixRand(&b);
+
+    pinned = pinToCurrentCore(&saved);
+
+    for (int cutoff = minCutoff; cutoff <= maxCutoff; cutoff += step) {
+        void* workspace = malloc(strassenWorkspaceSize(paddedSide, cutoff) + 1);
+        if (workspace == NULL) {
+            best = -1;
+            break;
+        }
+
+        for (int i = 0; i < TUNING_WARMUP; i++) {
+            strassenMul_hybrid_ws(&A, &B, &C, cutoff, workspace);
+        }
+        for (int i = 0; i < TUNING_TRIALS; i++) {
+            double start = nowSeconds();
+            strassenMul_hybrid_ws(&A, &B, &C, cutoff, workspace);
+            double elapsed = nowSeconds() - start;
+            if (best < 0 || elapsed < bestTime) {
+                best = cutoff;
+                bestTime = elapsed;
+            }
+        }
+
+        free(workspace);
+    }
+
+    if (pinned == 0) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &saved);
+    }
+
+    freeMatrix(&A);
+    freeMatrix(&B);
+    freeMatrix(&C);
+    return best;
+}
+
+/**
+ * Tunes the cutoff for each size and writes the profile file
+ * @param path        Profile file to write
+ * @param sides       Sides to tune, in increasing order; each is the upper bound of a band
+ * @param count       Number of sides (at most PROFILE_MAX_BANDS)
+ * @param minCutoff   Minimum cutoff value to test
+ * @param maxCutoff   Maximum cutoff value to test
+ * @param step        Step size between cutoff values
+ * @return            0 on success, -1 on allocation failure or if the file cannot
+ *                    be written, -2 for invalid sides or an empty cutoff range
+ */
+int tuneCutoffProfile(const char* path, const int* sides, int count,
+                      int minCutoff, int maxCutoff, int step) {
+    int cutoffs[PROFILE_MAX_BANDS];
+
+    if (count < 1 || count > PROFILE_MAX_BANDS) return -2;
+    for (int i = 1; i < count; i++) {
+        if (sides[i] <= sides[i - 1]) return -2;
+    }
+    for (int i = 0; i < count; i++) {
+        cutoffs[i] = findOptimalCutoff(minCutoff, maxCutoff, step, sides[i], sides[i]);
+        if (cutoffs[i] < 0) return cutoffs[i];
+    }
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return -1;
+
+    fprintf(file, "# strassen cutoff profile (%s leaf): <largest side of the band> <cutoff>\n",
+            getHybridLeaf() == LEAF_BLOCKED ? "blocked" : "naive");
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%d %d\n", sides[i], cutoffs[i]);
+    }
+
+    return fclose(file) == 0 ? 0 : -1;
+}
+
+/**
+ * Loads a profile file written by tuneCutoffProfile
+ * The profile in use is only replaced when the whole file is valid
+ *
+ * @param path   Profile file to read
+ * @return       0 on success, -1 if the file cannot be read or is malformed
+ */
+int loadCutoffProfile(const char* path) {
+    int sides[PROFILE_MAX_BANDS];
+    int cutoffs[PROFILE_MAX_BANDS];
+    int bands = 0;
+    char line[256];
+
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return -1;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        int side, cutoff;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') continue;
+        if (sscanf(line, "%d %d", &side, &cutoff) != 2 || bands == PROFILE_MAX_BANDS ||
+            cutoff < 1 || (bands > 0 && side <= sides[bands - 1])) {
+            fclose(file);
+            return -1;
+        }
+        sides[bands] = side;
+        cutoffs[bands] = cutoff;
+        bands++;
+    }
+    fclose(file);
+    if (bands == 0) return -1;
+
+    memcpy(profileSides, sides, sizeof(int) * bands);
+    memcpy(profileCutoffs, cutoffs, sizeof(int) * bands);
+    profileBands = bands;
+    return 0;
+}
+
+/**
+ * Loads the profile named by the CUTOFF_PROFILE_ENV environment variable
+ */
+static void loadProfileFromEnvironment(void) {
+    const char* path = getenv(CUTOFF_PROFILE_ENV);
+    if (path != NULL && profileBands == 0) {
+        loadCutoffProfile(path);
+    }
+}
+
+/**
+ * Returns the cutoff of the loaded profile for a given size
+ * On first use, loads the file named by CUTOFF_PROFILE_ENV if no
+ * profile has been loaded yet
+ *
+ * @param side   Largest dimension of the product
+ * @return       Cutoff of the band containing side, CUTOFF_DEFAULT without a profile
+ */
+int profileCutoff(int side) {
+    pthread_once(&profileOnce, loadProfileFromEnvironment);
+
+    if (profileBands == 0) return CUTOFF_DEFAULT;
+    for (int i = 0; i < profileBands; i++) {
+        if (side <= profileSides[i]) return profileCutoffs[i];
+    }
+    return profileCutoffs[profileBands - 1];
+}
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "matrix.h"
+
+/******************************************
+ * Probabilistic verification (Freivalds)
+ *
+ * C = A * B is checked by comparing A (B x) with C x for random vectors
+ * x with entries in {0, 1}. Every round costs three matrix-vector
+ * products, O(mk + kn + mn), instead of the O(mkn) of a reference product.
+ * The engines compute in int, which wraps modulo 2^32, so the check does
+ * the same in uint32_t. A product that differs from A * B in any element
+ * passes a round with probability at most 1/2, in any ring: fix all
+ * entries of x but the one that meets a wrong element, and at most one
+ * of its two values hides the difference. r rounds bound the
+ * false-positive rate by 2^-r.
+ *
+ * A chain M1 * ... * Mc is checked the same way, applying the factors to
+ * x from right to left.
+ *
+ * Rounds run FREIVALDS_BATCH at a time: x is an n x FREIVALDS_BATCH
+ * block, so each element of the factors and of C is loaded once per
+ * batch and the inner loop over the vectors vectorises.
+ *******************************************/
+
+#define FREIVALDS_BATCH 8
+
+/**
+ * Returns the next value of a splitmix64 generator
+ * @param state  Generator state, updated
+ * @return       64 random bits
+ */
+static uint64_t nextRandom(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Multiplies a matrix by a block of FREIVALDS_BATCH vectors, modulo 2^32
+ * @param M  Matrix (rows x cols)
+ * @param X  Vectors, cols x FREIVALDS_BATCH, row-major
+ * @param Y  Receives M * X, rows x FREIVALDS_BATCH, row-major
+ */
+static void applyMatrix(struct Matrix* M, const uint32_t* X, uint32_t* Y) {
+    for (int i = 0; i < M->row; i++) {
+        uint32_t acc[FREIVALDS_BATCH] = {0};
+        const int* row = &matrixElem(M->matrix, i, 0, M->ld);
+        for (int j = 0; j < M->col; j++) {
+            uint32_t e = (uint32_t)row[j];
+            const uint32_t* x = X + (size_t)j * FREIVALDS_BATCH;
+            for (int w = 0; w < FREIVALDS_BATCH; w++) {
+                acc[w] += e * x[w];
+            }
+        }
+        memcpy(Y + (size_t)i * FREIVALDS_BATCH, acc, sizeof(acc));
+    }
+}
+
+/**
+ * Returns the number of rounds needed for a false-positive bound
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @return               Rounds (2^-rounds <= falsePositive), -1 unless 0 < falsePositive < 1
+ */
+int freivaldsRounds(double falsePositive) {
+    if (!(falsePositive > 0.0 && falsePositive < 1.0)) return -1;
+
+    int rounds = 1;
+    double bound = 0.5;
+    while (bound > falsePositive) {
+        bound *= 0.5;
+        rounds++;
+    }
+    return rounds;
+}
+
+/**
+ * Checks C = M1 * M2 * ... * Mcount with Freivalds' algorithm
+ * @param mats           Factors of the chain
+ * @param count          Number of factors (at least 1)
+ * @param C              Product to check
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is certainly wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int verifyChainProduct(struct Matrix** mats, int count, struct Matrix* C,
+                       double falsePositive, unsigned long long seed) {
+    int rounds = freivaldsRounds(falsePositive);
+    if (rounds < 0 || count < 1 || C->row != mats[0]->row || C->col != mats[count - 1]->col) return -1;
+
+    /* Largest inner dimension, for the two ping-pong buffers */
+    int widest = C->row;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && mats[i]->row != mats[i - 1]->col) return -1;
+        if (mats[i]->row > widest) widest = mats[i]->row;
+    }
+
+    int m = C->row, n = C->col;
+    size_t elems = (size_t)n + 2 * (size_t)widest + m;
+    uint32_t* buffer = malloc(sizeof(uint32_t) * FREIVALDS_BATCH * (elems > 0 ? elems : 1));
+    if (buffer == NULL) return -1;
+    uint32_t* X = buffer;                                   /* n x batch */
+    uint32_t* ping = X + (size_t)n * FREIVALDS_BATCH;       /* widest x batch */
+    uint32_t* pong = ping + (size_t)widest * FREIVALDS_BATCH;
+    uint32_t* CX = pong + (size_t)widest * FREIVALDS_BATCH; /* m x batch */
+
+    uint64_t state = seed;
+    int passed = 1;
+    for (int done = 0; done < rounds && passed; done += FREIVALDS_BATCH) {
+        /* One random byte per row of X: bit w is the entry of vector w */
+        uint64_t bits = 0;
+        for (int j = 0; j < n; j++) {
+            if (j % 8 == 0) bits = nextRandom(&state);
+            for (int w = 0; w < FREIVALDS_BATCH; w++) {
+                X[(size_t)j * FREIVALDS_BATCH + w] = (uint32_t)(bits >> (8 * (j % 8) + w)) & 1u;
+            }
+        }
+        /* M1 (M2 (... (Mcount X))), right to left */
+        const uint32_t* in = X;
+        for (int i = count - 1; i >= 0; i--) {
+            uint32_t* out = in == ping ? pong : ping;
+            applyMatrix(mats[i], in, out);
+            in = out;
+        }
+        applyMatrix(C, X, CX);
+        passed = memcmp(in, CX, sizeof(uint32_t) * FREIVALDS_BATCH * (size_t)m) == 0;
+    }
+
+    free(buffer);
+    return passed;
+}
+
+/**
+ * Checks C = A * B with Freivalds' algorithm
+ * @param A              First operand (m x k)
+ * @param B              Second operand (k x n)
+ * @param C              Product to check (m x n)
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @param seed           Seed of the random vectors
+ * @return               1 if C passed every round, 0 if C is certainly wrong,
+ *                       -1 for mismatched shapes, an invalid bound or an allocation failure
+ */
+int verifyProduct(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                  double falsePositive, unsigned long long seed) {
+    struct Matrix* chain[2] = { A, B };
+    return verifyChainProduct(chain, 2, C, falsePositive, seed);
+}
+
+/**
+ * Checks C = A * B with a fresh seed and prints the outcome
+ * @param out            Output stream of the report line
+ * @param A              First operand (m x k)
+ * @param B              Second operand (k x n)
+ * @param C              Product to check (m x n)
+ * @param falsePositive  Largest accepted probability of passing a wrong product
+ * @return               0 if C passed, -1 if it failed or could not be checked
+ */
+int verifyProductReport(FILE* out, struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                        double falsePositive) {
+    struct timespec start, end;
+    unsigned long long seed = (unsigned long long)time(NULL) * 0x100000001B3ull ^ (unsigned long long)getpid();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int result = verifyProduct(A, B, C, falsePositive, seed);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (result < 0) {
+        fprintf(out, "verify: not checked (invalid shapes or bound, or out of memory)\n");
+        return -1;
+    }
+    fprintf(out, "verify: %s, %d rounds, false-positive bound %g, seed %llu, %f s\n",
+            result ? "passed" : "FAILED", freivaldsRounds(falsePositive), falsePositive, seed, seconds);
+    return result ? 0 : -1;
+}
+
+/**
+ * Extracts --verify or --verify=<bound> from the arguments of a driver
+ * @param argc           Number of arguments, updated
+ * @param argv           Arguments, compacted in place
+ * @param falsePositive  Receives the bound, VERIFY_DEFAULT_BOUND for --verify, 0 when absent
+ * @return               0 on success, -1 if the bound is not in (0, 1)
+ */
+int parseVerifyArg(int* argc, char* argv[], double* falsePositive) {
+    int kept = 1;
+    int status = 0;
+
+    *falsePositive = 0.0;
+    for (int i = 1; i < *argc; i++) {
+        if (strcmp(argv[i], "--verify") == 0) {
+            *falsePositive = VERIFY_DEFAULT_BOUND;
+        } else if (strncmp(argv[i], "--verify=", 9) == 0) {
+            *falsePositive = atof(argv[i] + 9);
+            if (freivaldsRounds(*falsePositive) < 0) status = -1;
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+
+    *argc = kept;
+    argv[kept] = NULL;
+    return status;
+}
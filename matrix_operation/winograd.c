@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include "matrix.h"
+
+/******************************************
+ * Strassen-Winograd algorithm with 2 temporary matrices
+ *
+ * Winograd's form of Strassen's algorithm reuses partial sums so that a
+ * level needs 15 block additions instead of 18:
+ *
+ * S1 = A21 + A22     T1 = B12 - B11     P1 = A11 * B11    P5 = S1 * T1
+ * S2 = S1 - A11      T2 = B22 - T1      P2 = A12 * B21    P6 = S2 * T2
+ * S3 = A11 - A21     T3 = B22 - B12     P3 = S4 * B22     P7 = S3 * T3
+ * S4 = A12 - S2      T4 = T2 - B21      P4 = A22 * T4
+ *
+ * U2 = P1 + P6   U3 = U2 + P7   U4 = U2 + P5
+ * C11 = P1 + P2   C12 = U4 + P3   C21 = U3 - P4   C22 = U3 + P5
+ *
+ * The operations are run in the order given by Boyer, Dumas, Pernet and
+ * Zhou ("Memory efficient scheduling of Strassen-Winograd's matrix
+ * multiplication algorithm", ISSAC 2009): the four quadrants of C hold
+ * products and partial sums while they are not final, so a level only
+ * needs two temporaries, X for the sums of A and Y for the sums of B.
+ * As for strassenMul, they are sliced from a workspace arena laid out
+ * as [X Y | X Y | ...] from the top level down. Odd dimensions and
+ * unbalanced rectangular shapes are handled as in strassenMul.
+ *******************************************/
+
+/**
+ * Builds a matrix header over a slice of the workspace arena
+ * The returned matrix does not own its memory and must not be freed
+ *
+ * @param data   First element of the slice
+ * @param rows   Number of rows of the matrix
+ * @param cols   Number of columns of the matrix
+ * @return       Matrix struct pointing into the arena
+ */
+static struct Matrix arenaMatrix(int* data, int rows, int cols) {
+    struct Matrix mat;
+    mat.matrix = data;
+    mat.row = rows;
+    mat.col = cols;
+    mat.ld = cols;
+    return mat;
+}
+
+/**
+ * Returns the larger of two ints
+ * @param a      First value
+ * @param b      Second value
+ * @return       max(a, b)
+ */
+static int maxInt(int a, int b) {
+    return a > b ? a : b;
+}
+
+/**
+ * Returns the smaller of two ints
+ * @param a      First value
+ * @param b      Second value
+ * @return       min(a, b)
+ */
+static int minInt(int a, int b) {
+    return a < b ? a : b;
+}
+
+/**
+ * Returns the number of bytes of workspace needed by the Winograd engines
+ * for an m x k by k x n product
+ * Same recursion as strassenWorkspaceSizeRect, but a Winograd level only
+ * needs X (m/2 x max(k/2, n/2), it also receives P1) and Y (k/2 x n/2)
+ *
+ * @param m          Rows of A and C
+ * @param k          Columns of A / rows of B
+ * @param n          Columns of B and C
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Winograd)
+ * @return           Size of the arena in bytes
+ */
+size_t winogradWorkspaceSizeRect(int m, int k, int n, int cutoff) {
+    size_t elems = 0;
+
+    if (cutoff < 1) cutoff = 1;
+
+    while (m > cutoff && k > cutoff && n > cutoff) {
+        if ((m | k | n) & 1) {
+            m &= ~1;                     /* Peeled level: no temporaries */
+            k &= ~1;
+            n &= ~1;
+            continue;
+        }
+        int largest = maxInt(m, maxInt(k, n));
+        if (largest >= 2 * minInt(m, minInt(k, n))) {
+            if (m == largest) {
+                m /= 2;
+            } else if (n == largest) {
+                n /= 2;
+            } else {
+                elems += (size_t)m * n;  /* Second half-k product */
+                k /= 2;
+            }
+            continue;
+        }
+        elems += (size_t)(m / 2) * maxInt(k / 2, n / 2) + (size_t)(k / 2) * (n / 2);  /* X and Y */
+        m /= 2;
+        k /= 2;
+        n /= 2;
+    }
+
+    /* The blocked leaf packs its panels right after the last level */
+    if (cutoff > 1 && getHybridLeaf() == LEAF_BLOCKED) {
+        return elems * sizeof(int) + gemmPackSize(m, n, k);
+    }
+    return elems * sizeof(int);
+}
+
+/**
+ * Returns the number of bytes of workspace needed by the Winograd engines
+ * for two side x side matrices
+ *
+ * @param side       Side length of the (square) input matrices
+ * @param cutoff     Size threshold of the hybrid engine (1 for pure Winograd)
+ * @return           Size of the arena in bytes
+ */
+size_t winogradWorkspaceSize(int side, int cutoff) {
+    return winogradWorkspaceSizeRect(side, side, side, cutoff);
+}
+
+/**
+ * Recursive step shared by winogradMul and winogradMul_hybrid
+ * Computes C = A * B (A m x k, B k x n), switching to the leaf kernel
+ * once a dimension is <= cutoff. Odd dimensions and unbalanced shapes
+ * are handled as in strassenMul.
+ * A, B and C may be views with any leading dimension; C must not overlap A or B.
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param ws         Workspace arena for this level and the ones below it
+ * @return           Pointer to the result matrix C
+ */
+static struct Matrix* winogradRecursive(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                        int cutoff, int* ws) {
+    int m = A->row, k = A->col, n = B->col;
+
+    /* Base case: switch to standard multiplication when a dimension is <= cutoff */
+    if (m <= cutoff || k <= cutoff || n <= cutoff) {
+        if (cutoff > 1 && getHybridLeaf() == LEAF_BLOCKED) {
+            return mulBlocked_ws(A, B, C, ws);
+        }
+        return mul(A, B, C);
+    }
+
+    /* Odd dimension: multiply the even leading blocks, then fix up the rest */
+    if ((m | k | n) & 1) {
+        struct Matrix A11 = matrixView(A, 0, 0, m & ~1, k & ~1);
+        struct Matrix B11 = matrixView(B, 0, 0, k & ~1, n & ~1);
+        struct Matrix C11 = matrixView(C, 0, 0, m & ~1, n & ~1);
+        winogradRecursive(&A11, &B11, &C11, cutoff, ws);
+        peelUpdate(A, B, C);
+        return C;
+    }
+
+    /* Unbalanced shape: halve the largest dimension instead of all three */
+    int largest = maxInt(m, maxInt(k, n));
+    if (largest >= 2 * minInt(m, minInt(k, n))) {
+        if (m == largest) {
+            struct Matrix A1 = matrixView(A, 0, 0, m / 2, k), A2 = matrixView(A, m / 2, 0, m / 2, k);
+            struct Matrix C1 = matrixView(C, 0, 0, m / 2, n), C2 = matrixView(C, m / 2, 0, m / 2, n);
+            winogradRecursive(&A1, B, &C1, cutoff, ws);
+            winogradRecursive(&A2, B, &C2, cutoff, ws);
+        } else if (n == largest) {
+            struct Matrix B1 = matrixView(B, 0, 0, k, n / 2), B2 = matrixView(B, 0, n / 2, k, n / 2);
+            struct Matrix C1 = matrixView(C, 0, 0, m, n / 2), C2 = matrixView(C, 0, n / 2, m, n / 2);
+            winogradRecursive(A, &B1, &C1, cutoff, ws);
+            winogradRecursive(A, &B2, &C2, cutoff, ws);
+        } else {
+            /* C = A1 * B1 + A2 * B2, the second product goes through a temporary */
+            struct Matrix A1 = matrixView(A, 0, 0, m, k / 2), A2 = matrixView(A, 0, k / 2, m, k / 2);
+            struct Matrix B1 = matrixView(B, 0, 0, k / 2, n), B2 = matrixView(B, k / 2, 0, k / 2, n);
+            struct Matrix P = arenaMatrix(ws, m, n);
+            winogradRecursive(&A1, &B1, C, cutoff, ws + (size_t)m * n);
+            winogradRecursive(&A2, &B2, &P, cutoff, ws + (size_t)m * n);
+            addSubmatrixRect(&P, C, 0, 0, m, n);
+        }
+        return C;
+    }
+
+    int hm = m / 2, hk = k / 2, hn = n / 2;
+    size_t sizeX = (size_t)hm * maxInt(hk, hn);
+
+    /* Slice the two temporaries of this level from the arena */
+    struct Matrix X = arenaMatrix(ws, hm, hk);           /* Sums of A */
+    struct Matrix P1 = arenaMatrix(ws, hm, hn);          /* Same memory, holds P1 once S4 is used */
+    struct Matrix Y = arenaMatrix(ws + sizeX, hk, hn);   /* Sums of B */
+    int* next = ws + sizeX + (size_t)hk * hn;
+
+    struct Matrix A11 = matrixView(A, 0, 0, hm, hk);
+    struct Matrix A12 = matrixView(A, 0, hk, hm, hk);
+    struct Matrix A22 = matrixView(A, hm, hk, hm, hk);
+    struct Matrix B11 = matrixView(B, 0, 0, hk, hn);
+    struct Matrix B21 = matrixView(B, hk, 0, hk, hn);
+    struct Matrix B22 = matrixView(B, hk, hn, hk, hn);
+    struct Matrix C11 = matrixView(C, 0, 0, hm, hn);
+    struct Matrix C12 = matrixView(C, 0, hn, hm, hn);
+    struct Matrix C21 = matrixView(C, hm, 0, hm, hn);
+    struct Matrix C22 = matrixView(C, hm, hn, hm, hn);
+
+    /* P7 = (A11 - A21) * (B22 - B12) -> C21 */
+    subMatrixRect(A, 0, 0, A, hm, 0, &X, 0, 0, hm, hk);      /* X = S3 */
+    subMatrixRect(B, hk, hn, B, 0, hn, &Y, 0, 0, hk, hn);    /* Y = T3 */
+    winogradRecursive(&X, &Y, &C21, cutoff, next);
+
+    /* P5 = (A21 + A22) * (B12 - B11) -> C22 */
+    sumMatrixRect(A, hm, 0, A, hm, hk, &X, 0, 0, hm, hk);    /* X = S1 */
+    subMatrixRect(B, 0, hn, B, 0, 0, &Y, 0, 0, hk, hn);      /* Y = T1 */
+    winogradRecursive(&X, &Y, &C22, cutoff, next);
+
+    /* P6 = (S1 - A11) * (B22 - T1) -> C12 */
+    subMatrixRect(&X, 0, 0, A, 0, 0, &X, 0, 0, hm, hk);      /* X = S2 */
+    subMatrixRect(B, hk, hn, &Y, 0, 0, &Y, 0, 0, hk, hn);    /* Y = T2 */
+    winogradRecursive(&X, &Y, &C12, cutoff, next);
+
+    /* P3 = (A12 - S2) * B22 -> C11 */
+    subMatrixRect(A, 0, hk, &X, 0, 0, &X, 0, 0, hm, hk);     /* X = S4 */
+    winogradRecursive(&X, &B22, &C11, cutoff, next);
+
+    /* P1 = A11 * B11 -> X */
+    winogradRecursive(&A11, &B11, &P1, cutoff, next);
+
+    addSubmatrixRect(&P1, C, 0, hn, hm, hn);     /* C12 = U2 = P1 + P6 */
+    addSubmatrixRect(&C12, C, hm, 0, hm, hn);    /* C21 = U3 = U2 + P7 */
+    addSubmatrixRect(&C22, C, 0, hn, hm, hn);    /* C12 = U4 = U2 + P5 */
+    addSubmatrixRect(&C21, C, hm, hn, hm, hn);   /* C22 = U3 + P5 */
+    addSubmatrixRect(&C11, C, 0, hn, hm, hn);    /* C12 = U4 + P3 */
+
+    /* P4 = A22 * (T2 - B21) -> C11 */
+    subMatrixRect(&Y, 0, 0, B, hk, 0, &Y, 0, 0, hk, hn);     /* Y = T4 */
+    winogradRecursive(&A22, &Y, &C11, cutoff, next);
+
+    subSubmatrixRect(&C11, C, hm, 0, hm, hn);    /* C21 = U3 - P4 */
+
+    /* P2 = A12 * B21 -> C11 */
+    winogradRecursive(&A12, &B21, &C11, cutoff, next);
+
+    addSubmatrixRect(&P1, C, 0, 0, hm, hn);      /* C11 = P1 + P2 */
+
+    return C;
+}
+
+/**
+ * Strassen-Winograd algorithm on a caller-supplied workspace arena
+ * Performs no heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param workspace  Arena of at least winogradWorkspaceSizeRect(A->row, A->col, B->col, 1) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* winogradMul_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C, void* workspace) {
+    return winogradRecursive(A, B, C, 1, workspace);
+}
+
+/**
+ * Hybrid Strassen-Winograd algorithm on a caller-supplied workspace arena
+ * Performs no heap allocation
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @param workspace  Arena of at least winogradWorkspaceSizeRect(A->row, A->col, B->col, cutoff) bytes
+ * @return           Pointer to the result matrix C
+ */
+struct Matrix* winogradMul_hybrid_ws(struct Matrix* A, struct Matrix* B, struct Matrix* C,
+                                     int cutoff, void* workspace) {
+    if (cutoff < 1) cutoff = 1;
+    return winogradRecursive(A, B, C, cutoff, workspace);
+}
+
+/**
+ * Performs the Strassen-Winograd algorithm
+ * Computes C = A * B with 7 products and 15 additions per level
+ * The workspace arena is allocated once for the whole multiplication
+ *
+ * @param A      First input matrix
+ * @param B      Second input matrix
+ * @param C      Output matrix
+ * @return       Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* winogradMul(struct Matrix* A, struct Matrix* B, struct Matrix* C) {
+    size_t bytes = winogradWorkspaceSizeRect(A->row, A->col, B->col, 1);
+    void* workspace = malloc(bytes > 0 ? bytes : 1);
+    if (workspace == NULL) return NULL;
+
+    winogradMul_ws(A, B, C, workspace);
+
+    free(workspace);
+    return C;
+}
+
+/**
+ * Hybrid Strassen-Winograd algorithm that switches to standard multiplication
+ * for small matrices (same leaf kernel as strassenMul_hybrid, see setHybridLeaf)
+ * The workspace arena is allocated once for the whole multiplication
+ *
+ * @param A          First input matrix
+ * @param B          Second input matrix
+ * @param C          Output matrix
+ * @param cutoff     Size threshold to switch to standard multiplication
+ * @return           Pointer to the result matrix C, NULL if the arena cannot be allocated
+ */
+struct Matrix* winogradMul_hybrid(struct Matrix* A, struct Matrix* B, struct Matrix* C, int cutoff) {
+    size_t bytes = winogradWorkspaceSizeRect(A->row, A->col, B->col, cutoff);
+    void* workspace = malloc(bytes > 0 ? bytes : 1);
+    if (workspace == NULL) return NULL;
+
+    winogradMul_hybrid_ws(A, B, C, cutoff, workspace);
+
+    free(workspace);
+    return C;
+}
@@ -0,0 +1,538 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "workstealing.h"
+
+/******************************************
+ * Work-stealing task runtime
+ *
+ * Each deque is a ring buffer protected by its own mutex: the owner
+ * pushes and pops at the bottom, thieves take the oldest half from the
+ * top in one critical section. Tasks are never copied, the deques only
+ * hold pointers to Task structs owned by the spawner.
+ *
+ * Workers sleep on a condition variable while no run is active, and
+ * poll with an exponential backoff (spin, yield, short sleep) while a
+ * run is active but they find no work; that polling time is reported
+ * as idle time.
+ *******************************************/
+
+/* Tasks a thief takes in one steal at most */
+#define MAX_STEAL 64
+
+/* Initial number of slots of a deque */
+#define DEQUE_CAPACITY 256
+
+/**
+ * Double-ended queue of task pointers
+ */
+struct Deque {
+    pthread_mutex_t lock;
+    struct Task** tasks;    /* Ring buffer */
+    int capacity;
+    int top;                /* Index of the oldest task */
+    int count;
+};
+
+/**
+ * One worker thread with its deque and counters
+ */
+struct Worker {
+    struct TaskRuntime* rt;
+    int index;
+    pthread_t thread;
+    struct Deque deque;
+    unsigned seed;              /* Victim selection */
+    long tasksExecuted;         /* Counters, updated atomically */
+    long tasksSpawned;
+    long steals;
+    long tasksStolen;
+    long failedSteals;
+    long idleNanoseconds;
+};
+
+struct TaskRuntime {
+    struct Worker* workers;
+    int count;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* A run started or the runtime shuts down */
+    pthread_cond_t finished;    /* A root task completed */
+    int activeRuns;
+    int nextWorker;             /* Worker receiving the next root task */
+    int shutdown;
+};
+
+/**
+ * Root task of a run, completed under the runtime lock
+ */
+struct RootTask {
+    struct TaskRuntime* rt;
+    void (*run)(void* arg);
+    void* arg;
+    int done;
+};
+
+/* Worker executing on the current thread, NULL outside the runtime */
+static __thread struct Worker* currentWorker = NULL;
+
+/**
+ * Returns a monotonic timestamp in nanoseconds
+ * @return      Current time
+ */
+static long nowNanoseconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/**
+ * Adds a value to a counter owned by a worker
+ * @param counter   Counter to update
+ * @param value     Increment
+ */
+static void countAdd(long* counter, long value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * Initializes an empty deque
+ * @param dq    Deque to initialize
+ * @return      0 on success, -1 on allocation failure
+ */
+static int dequeInit(struct Deque* dq) {
+    dq->tasks = malloc(sizeof(struct Task*) * DEQUE_CAPACITY);
+    if (dq->tasks == NULL) return -1;
+    dq->capacity = DEQUE_CAPACITY;
+    dq->top = 0;
+    dq->count = 0;
+    pthread_mutex_init(&dq->lock, NULL);
+    return 0;
+}
+
+/**
+ * Pushes a task at the bottom of a deque, growing it if needed
+ * @param dq    Deque
+ * @param task  Task to push
+ */
+static void dequePushBottom(struct Deque* dq, struct Task* task) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count == dq->capacity) {
+        /* Grow and unroll the ring so that top is at index 0 */
+        struct Task** grown = malloc(sizeof(struct Task*) * dq->capacity * 2);
+        if (grown == NULL) {
+            pthread_mutex_unlock(&dq->lock);
+            task->run(task->arg);   /* No room: run it inline */
+            __atomic_sub_fetch(&task->group->pending, 1, __ATOMIC_SEQ_CST);
+            return;
+        }
+        for (int i = 0; i < dq->count; i++) {
+            grown[i] = dq->tasks[(dq->top + i) % dq->capacity];
+        }
+        free(dq->tasks);
+        dq->tasks = grown;
+        dq->capacity *= 2;
+        dq->top = 0;
+    }
+    dq->tasks[(dq->top + dq->count) % dq->capacity] = task;
+    dq->count++;
+    pthread_mutex_unlock(&dq->lock);
+}
+
+/**
+ * Pops the most recently pushed task of a deque
+ * @param dq    Deque
+ * @return      The task, NULL if the deque is empty
+ */
+static struct Task* dequePopBottom(struct Deque* dq) {
+    struct Task* task = NULL;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count > 0) {
+        dq->count--;
+        task = dq->tasks[(dq->top + dq->count) % dq->capacity];
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return task;
+}
+
+/**
+ * Takes the oldest half of the tasks of a deque
+ * @param dq    Victim deque
+ * @param out   Destination of the stolen tasks, oldest first
+ * @return      Number of tasks stolen
+ */
+static int dequeStealHalf(struct Deque* dq, struct Task** out) {
+    pthread_mutex_lock(&dq->lock);
+    int n = (dq->count + 1) / 2;
+    if (n > MAX_STEAL) n = MAX_STEAL;
+    for (int i = 0; i < n; i++) {
+        out[i] = dq->tasks[(dq->top + i) % dq->capacity];
+    }
+    dq->top = (dq->top + n) % dq->capacity;
+    dq->count -= n;
+    pthread_mutex_unlock(&dq->lock);
+    return n;
+}
+
+/**
+ * Runs a task and notifies its group
+ * @param w     Worker running the task
+ * @param task  Task to run
+ */
+static void runTask(struct Worker* w, struct Task* task) {
+    struct TaskGroup* group = task->group;
+    task->run(task->arg);
+    countAdd(&w->tasksExecuted, 1);
+    /* Last access: the spawner may release the task once pending drops */
+    __atomic_sub_fetch(&group->pending, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Tries to steal half of the deque of a random victim
+ * Keeps the oldest stolen task to run and queues the others locally
+ * @param w     Thief
+ * @return      Task to run, NULL if the victim had nothing
+ */
+static struct Task* stealWork(struct Worker* w) {
+    struct TaskRuntime* rt = w->rt;
+    struct Task* stolen[MAX_STEAL];
+
+    if (rt->count < 2) return NULL;
+
+    /* xorshift victim selection, never ourselves */
+    w->seed ^= w->seed << 13;
+    w->seed ^= w->seed >> 17;
+    w->seed ^= w->seed << 5;
+    int victim = (int)(w->seed % (unsigned)(rt->count - 1));
+    if (victim >= w->index) victim++;
+
+    int n = dequeStealHalf(&rt->workers[victim].deque, stolen);
+    if (n == 0) {
+        countAdd(&w->failedSteals, 1);
+        return NULL;
+    }
+
+    for (int i = 1; i < n; i++) {
+        dequePushBottom(&w->deque, stolen[i]);
+    }
+    countAdd(&w->steals, 1);
+    countAdd(&w->tasksStolen, n);
+    return stolen[0];
+}
+
+/**
+ * Returns the next task for a worker: its own newest task, or a stolen one
+ * @param w     Worker
+ * @return      Task to run, NULL if none was found
+ */
+static struct Task* findWork(struct Worker* w) {
+    struct Task* task = dequePopBottom(&w->deque);
+    return task != NULL ? task : stealWork(w);
+}
+
+/**
+ * Waits a little after a failed search for work
+ * @param attempts  Consecutive failed searches
+ */
+static void backoff(int attempts) {
+    if (attempts < 64) {
+        return;                             /* Spin */
+    } else if (attempts < 1024) {
+        sched_yield();
+    } else {
+        struct timespec pause = { 0, 50000 };   /* 50 us */
+        nanosleep(&pause, NULL);
+    }
+}
+
+/**
+ * Worker thread: sleeps while no run is active, otherwise runs or steals tasks
+ * @param arg   Worker
+ * @return      NULL
+ */
+static void* workerMain(void* arg) {
+    struct Worker* w = arg;
+    struct TaskRuntime* rt = w->rt;
+    int attempts = 0;
+    long idleSince = 0;
+
+    currentWorker = w;
+
+    for (;;) {
+        if (__atomic_load_n(&rt->activeRuns, __ATOMIC_ACQUIRE) == 0) {
+            pthread_mutex_lock(&rt->lock);
+            while (rt->activeRuns == 0 && !rt->shutdown) {
+                pthread_cond_wait(&rt->wake, &rt->lock);
+            }
+            int stop = rt->shutdown && rt->activeRuns == 0;
+            pthread_mutex_unlock(&rt->lock);
+            if (stop) break;
+        }
+
+        struct Task* task = findWork(w);
+        if (task != NULL) {
+            if (idleSince != 0) {
+                countAdd(&w->idleNanoseconds, nowNanoseconds() - idleSince);
+                idleSince = 0;
+            }
+            attempts = 0;
+            runTask(w, task);
+        } else {
+            if (idleSince == 0) idleSince = nowNanoseconds();
+            backoff(++attempts);
+            if (__atomic_load_n(&rt->activeRuns, __ATOMIC_ACQUIRE) == 0) {
+                /* The run ended while we were looking: stop counting */
+                countAdd(&w->idleNanoseconds, nowNanoseconds() - idleSince);
+                idleSince = 0;
+                attempts = 0;
+            }
+        }
+    }
+
+    currentWorker = NULL;
+    return NULL;
+}
+
+/**
+ * Creates a runtime and starts its worker threads
+ * @param workers   Number of worker threads
+ * @return          The runtime, NULL on failure
+ */
+struct TaskRuntime* runtimeCreate(int workers) {
+    if (workers < 1) workers = 1;
+
+    struct TaskRuntime* rt = calloc(1, sizeof(struct TaskRuntime));
+    if (rt == NULL) return NULL;
+    rt->workers = calloc(workers, sizeof(struct Worker));
+    if (rt->workers == NULL) {
+        free(rt);
+        return NULL;
+    }
+    pthread_mutex_init(&rt->lock, NULL);
+    pthread_cond_init(&rt->wake, NULL);
+    pthread_cond_init(&rt->finished, NULL);
+
+    for (int i = 0; i < workers; i++) {
+        struct Worker* w = &rt->workers[i];
+        w->rt = rt;
+        w->index = i;
+        w->seed = 2463534242u + 7919u * (unsigned)i;
+        if (dequeInit(&w->deque) != 0) break;
+        if (pthread_create(&w->thread, NULL, workerMain, w) != 0) {
+            free(w->deque.tasks);
+            break;
+        }
+        rt->count++;
+    }
+
+    if (rt->count == 0) {
+        runtimeDestroy(rt);
+        return NULL;
+    }
+    return rt;
+}
+
+/**
+ * Stops the worker threads and frees the runtime
+ * @param rt    Runtime to destroy
+ */
+void runtimeDestroy(struct TaskRuntime* rt) {
+    if (rt == NULL) return;
+
+    pthread_mutex_lock(&rt->lock);
+    rt->shutdown = 1;
+    pthread_cond_broadcast(&rt->wake);
+    pthread_mutex_unlock(&rt->lock);
+
+    /* Join everyone first: a worker may still poll the deques of the others */
+    for (int i = 0; i < rt->count; i++) {
+        pthread_join(rt->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < rt->count; i++) {
+        pthread_mutex_destroy(&rt->workers[i].deque.lock);
+        free(rt->workers[i].deque.tasks);
+    }
+
+    pthread_cond_destroy(&rt->finished);
+    pthread_cond_destroy(&rt->wake);
+    pthread_mutex_destroy(&rt->lock);
+    free(rt->workers);
+    free(rt);
+}
+
+/**
+ * Body of the root task of a run: calls the user function and wakes the submitter
+ * @param arg   RootTask
+ */
+static void runRoot(void* arg) {
+    struct RootTask* root = arg;
+    root->run(root->arg);
+
+    pthread_mutex_lock(&root->rt->lock);
+    root->done = 1;
+    pthread_cond_broadcast(&root->rt->finished);
+    pthread_mutex_unlock(&root->rt->lock);
+}
+
+/**
+ * Runs fn(arg) as a root task on the workers and waits for it
+ * @param rt    Runtime
+ * @param run   Root function
+ * @param arg   Argument of the root function
+ */
+void runtimeRun(struct TaskRuntime* rt, void (*run)(void* arg), void* arg) {
+    /* Nested run from one of our own workers: just call it */
+    if (currentWorker != NULL && currentWorker->rt == rt) {
+        run(arg);
+        return;
+    }
+
+    struct RootTask root = { rt, run, arg, 0 };
+    struct TaskGroup group = { 1 };
+    struct Task task = { runRoot, &root, &group };
+
+    pthread_mutex_lock(&rt->lock);
+    int target = rt->nextWorker;
+    rt->nextWorker = (rt->nextWorker + 1) % rt->count;
+    pthread_mutex_unlock(&rt->lock);
+
+    dequePushBottom(&rt->workers[target].deque, &task);
+
+    pthread_mutex_lock(&rt->lock);
+    __atomic_add_fetch(&rt->activeRuns, 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&rt->wake);
+    while (!root.done) {
+        pthread_cond_wait(&rt->finished, &rt->lock);
+    }
+    pthread_mutex_unlock(&rt->lock);
+
+    /* The worker may still be finishing runTask on our stack frame */
+    while (__atomic_load_n(&group.pending, __ATOMIC_SEQ_CST) > 0) {
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&rt->lock);
+    __atomic_sub_fetch(&rt->activeRuns, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&rt->lock);
+}
+
+/**
+ * Returns the number of worker threads of a runtime
+ * @param rt    Runtime
+ * @return      Number of workers
+ */
+int runtimeWorkers(struct TaskRuntime* rt) {
+    return rt->count;
+}
+
+/**
+ * Copies the counters of one worker
+ * @param rt        Runtime
+ * @param worker    Worker index
+ * @param stats     Destination
+ */
+void runtimeGetStats(struct TaskRuntime* rt, int worker, struct TaskRuntimeStats* stats) {
+    struct Worker* w = &rt->workers[worker];
+    stats->tasksExecuted = __atomic_load_n(&w->tasksExecuted, __ATOMIC_RELAXED);
+    stats->tasksSpawned = __atomic_load_n(&w->tasksSpawned, __ATOMIC_RELAXED);
+    stats->steals = __atomic_load_n(&w->steals, __ATOMIC_RELAXED);
+    stats->tasksStolen = __atomic_load_n(&w->tasksStolen, __ATOMIC_RELAXED);
+    stats->failedSteals = __atomic_load_n(&w->failedSteals, __ATOMIC_RELAXED);
+    stats->idleSeconds = __atomic_load_n(&w->idleNanoseconds, __ATOMIC_RELAXED) / 1e9;
+}
+
+/**
+ * Resets the counters of every worker
+ * @param rt    Runtime
+ */
+void runtimeResetStats(struct TaskRuntime* rt) {
+    for (int i = 0; i < rt->count; i++) {
+        struct Worker* w = &rt->workers[i];
+        __atomic_store_n(&w->tasksExecuted, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->tasksSpawned, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->steals, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->tasksStolen, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->failedSteals, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&w->idleNanoseconds, 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Prints one line of counters per worker plus the totals
+ * @param rt    Runtime
+ * @param out   Output stream
+ */
+void runtimePrintStats(struct TaskRuntime* rt, FILE* out) {
+    struct TaskRuntimeStats total;
+    memset(&total, 0, sizeof(total));
+
+    fprintf(out, "%-8s %10s %10s %8s %8s %12s %10s\n",
+            "worker", "executed", "spawned", "steals", "stolen", "failed", "idle (s)");
+    for (int i = 0; i < rt->count; i++) {
+        struct TaskRuntimeStats s;
+        runtimeGetStats(rt, i, &s);
+        fprintf(out, "%-8d %10ld %10ld %8ld %8ld %12ld %10.4f\n", i,
+                s.tasksExecuted, s.tasksSpawned, s.steals, s.tasksStolen, s.failedSteals, s.idleSeconds);
+        total.tasksExecuted += s.tasksExecuted;
+        total.tasksSpawned += s.tasksSpawned;
+        total.steals += s.steals;
+        total.tasksStolen += s.tasksStolen;
+        total.failedSteals += s.failedSteals;
+        total.idleSeconds += s.idleSeconds;
+    }
+    fprintf(out, "%-8s %10ld %10ld %8ld %8ld %12ld %10.4f\n", "total",
+            total.tasksExecuted, total.tasksSpawned, total.steals, total.tasksStolen,
+            total.failedSteals, total.idleSeconds);
+}
+
+/**
+ * Queues a task on the deque of the calling worker
+ * @param group     Group the task belongs to
+ * @param task      Task to spawn
+ */
+void taskSpawn(struct TaskGroup* group, struct Task* task) {
+    struct Worker* w = currentWorker;
+    task->group = group;
+
+    if (w == NULL) {
+        task->run(task->arg);   /* Serial fallback */
+        return;
+    }
+
+    __atomic_add_fetch(&group->pending, 1, __ATOMIC_SEQ_CST);
+    countAdd(&w->tasksSpawned, 1);
+    dequePushBottom(&w->deque, task);
+}
+
+/**
+ * Waits for every task of a group, running or stealing other tasks meanwhile
+ * @param group     Group to wait for
+ */
+void taskSync(struct TaskGroup* group) {
+    struct Worker* w = currentWorker;
+    int attempts = 0;
+    long idleSince = 0;
+
+    if (w == NULL) return;  /* Everything already ran inline */
+
+    while (__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) > 0) {
+        struct Task* task = findWork(w);
+        if (task != NULL) {
+            if (idleSince != 0) {
+                countAdd(&w->idleNanoseconds, nowNanoseconds() - idleSince);
+                idleSince = 0;
+            }
+            attempts = 0;
+            runTask(w, task);
+        } else {
+            /* Our children were stolen and are still running elsewhere */
+            if (idleSince == 0) idleSince = nowNanoseconds();
+            backoff(++attempts);
+        }
+    }
+    if (idleSince != 0) {
+        countAdd(&w->idleNanoseconds, nowNanoseconds() - idleSince);
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef workstealing_H_
+#define workstealing_H_
+
+#include <stdio.h>
+
+/*********************************************
+ * Work-stealing task runtime
+ *
+ * A fixed set of worker threads, each owning a double-ended queue of
+ * tasks. A worker pushes the tasks it spawns at the bottom of its own
+ * deque and pops from the bottom (LIFO, cache-warm work first). An idle
+ * worker picks a random victim and steals half of the tasks at the top
+ * of its deque (the oldest, usually the largest subproblems).
+ *
+ * Spawning is help-first: taskSpawn only queues the child and returns,
+ * so a parent spawns all its children before running any of them, and
+ * taskSync runs or steals tasks until the children of its group are
+ * done. Called outside a worker, taskSpawn runs the task inline and the
+ * code degrades to serial execution.
+ *********************************************/
+
+struct TaskRuntime;
+
+/**
+ * Counts the tasks of one spawn group still running
+ * Initialize with { 0 } before the first taskSpawn
+ */
+struct TaskGroup {
+    int pending;       /* Spawned tasks not finished yet (atomic) */
+};
+
+/**
+ * A spawnable task
+ * The memory of the task must stay valid until taskSync returns
+ */
+struct Task {
+    void (*run)(void* arg);     /* Function executed by a worker */
+    void* arg;                  /* Argument of run */
+    struct TaskGroup* group;    /* Group notified on completion (set by taskSpawn) */
+};
+
+/**
+ * Load-balance counters of one worker
+ */
+struct TaskRuntimeStats {
+    long tasksExecuted;    /* Tasks run by the worker */
+    long tasksSpawned;     /* Tasks pushed on the worker's deque */
+    long steals;           /* Successful steal operations */
+    long tasksStolen;      /* Tasks taken from other deques (half per steal) */
+    long failedSteals;     /* Steal attempts that found an empty victim */
+    double idleSeconds;    /* Time spent looking for work while a run was active */
+};
+
+/**
+ * Creates a runtime and starts its worker threads
+ *
+ * @param workers    Number of worker threads (at least 1)
+ * @return           The runtime, NULL if it cannot be created
+ */
+struct TaskRuntime* runtimeCreate(int workers);
+
+/**
+ * Stops the worker threads and frees the runtime
+ * No run may be in progress
+ *
+ * @param rt         Runtime to destroy
+ */
+void runtimeDestroy(struct TaskRuntime* rt);
+
+/**
+ * Runs fn(arg) as a root task on the workers and waits for it
+ * Tasks spawned by fn (recursively) are executed by all the workers.
+ * Several threads may submit runs to the same runtime concurrently.
+ *
+ * @param rt         Runtime
+ * @param run        Root function
+ * @param arg        Argument of the root function
+ */
+void runtimeRun(struct TaskRuntime* rt, void (*run)(void* arg), void* arg);
+
+/**
+ * Returns the number of worker threads of a runtime
+ *
+ * @param rt         Runtime
+ * @return           Number of workers
+ */
+int runtimeWorkers(struct TaskRuntime* rt);
+
+/**
+ * Copies the counters of one worker
+ *
+ * @param rt         Runtime
+ * @param worker     Worker index (0 to runtimeWorkers - 1)
+ * @param stats      Destination of the counters
+ */
+void runtimeGetStats(struct TaskRuntime* rt, int worker, struct TaskRuntimeStats* stats);
+
+/**
+ * Resets the counters of every worker
+ *
+ * @param rt         Runtime
+ */
+void runtimeResetStats(struct TaskRuntime* rt);
+
+/**
+ * Prints one line of counters per worker plus the totals
+ *
+ * @param rt         Runtime
+ * @param out        Output stream
+ */
+void runtimePrintStats(struct TaskRuntime* rt, FILE* out);
+
+/**
+ * Queues a task on the deque of the calling worker (help-first)
+ * Outside a worker thread the task is executed immediately
+ *
+ * @param group      Group the task belongs to
+ * @param task       Task to spawn
+ */
+void taskSpawn(struct TaskGroup* group, struct Task* task);
+
+/**
+ * Waits for every task of a group, running or stealing other tasks meanwhile
+ *
+ * @param group      Group to wait for
+ */
+void taskSync(struct TaskGroup* group);
+
+#endif /* workstealing_H_ */